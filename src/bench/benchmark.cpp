@@ -0,0 +1,1674 @@
+#include "bench/benchmark.hpp"
+
+#include <enet/enet.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "core/alloc_counter.hpp"
+#include "core/bots.hpp"
+#include "core/broadphase.hpp"
+#include "core/camera.hpp"
+#include "core/chunked_world.hpp"
+#include "core/constants.hpp"
+#include "core/frame_arena.hpp"
+#include "core/job_system.hpp"
+#include "core/map.hpp"
+#include "core/match.hpp"
+#include "core/navigation.hpp"
+#include "core/obstacle_bvh.hpp"
+#include "core/particles.hpp"
+#include "core/registry.hpp"
+#include "core/simulation.hpp"
+#include "core/tick_watchdog.hpp"
+#include "core/triple_buffer.hpp"
+#include "entities/player.hpp"
+#include "network/client/spectator.hpp"
+#include "network/compression.hpp"
+#include "network/packet_pool.hpp"
+#include "network/protocol.hpp"
+#include "network/snapshot.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Benchmark {
+    const char* name;
+    std::function<bool()> run;
+};
+
+// Average wall time of fn in microseconds
+double measure(int iterations, const std::function<void()>& fn) {
+    fn();  // Warm caches and grow scratch buffers
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+// 64 players with several thousand live bullets spread over the arena
+bool benchBroadphase() {
+    const int playerCount = 64;
+    const int bulletCount = 4096;
+    const int iterations = 200;
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> x(0, 800);
+    std::uniform_int_distribution<int> y(0, 600);
+
+    Registry registry(playerCount);
+    for (int i = 0; i < playerCount; ++i) {
+        Entity entity = Player::spawn(registry, NetworkId{static_cast<uint16_t>(i)}, 5, RED, 10, PlayerShape::CIRCLE);
+        Player(registry, entity).setPosition({x(rng), y(rng)});
+    }
+    std::vector<Weapon>& weapons = registry.getWeapons();
+    for (int i = 0; i < bulletCount; ++i) {
+        weapons[i % playerCount].bullets.emplace_back(Position{x(rng), y(rng)}, Vector2{1, 0}, static_cast<uint8_t>(ProjectileType::RIFLE));
+    }
+
+    const std::vector<Transform>& transforms = registry.getTransforms();
+
+    // Reference: every bullet against every other player with a sqrt per test
+    size_t bruteHits = 0;
+    double bruteUs = measure(iterations, [&] {
+        bruteHits = 0;
+        for (size_t shooter = 0; shooter < weapons.size(); ++shooter) {
+            for (const Bullet& bullet : weapons[shooter].bullets) {
+                for (size_t victim = 0; victim < transforms.size(); ++victim) {
+                    if (victim == shooter) continue;
+                    int dx = bullet.getPosition().x - transforms[victim].position.x;
+                    int dy = bullet.getPosition().y - transforms[victim].position.y;
+                    if (std::sqrt(static_cast<float>(dx * dx + dy * dy)) <= transforms[victim].radius + bullet.getRadius()) bruteHits++;
+                }
+            }
+        }
+    });
+
+    Broadphase broadphase;
+    std::vector<CandidatePair> pairs;
+    size_t gridHits = 0;
+    double gridUs = measure(iterations, [&] {
+        broadphase.build(transforms, registry.getHealths(), Bullet::MAX_RADIUS);
+        broadphase.collectPairs(weapons, pairs);
+        gridHits = 0;
+        for (const CandidatePair& pair : pairs) {
+            if (Player(registry, registry.entityAt(pair.victim)).isCollidingWith(weapons[pair.shooter].bullets[pair.bullet])) gridHits++;
+        }
+    });
+
+    std::printf("  %d players, %d bullets\n", playerCount, bulletCount);
+    std::printf("  brute force : %8.1f us/tick  %zu tests, %zu hits\n", bruteUs, static_cast<size_t>(bulletCount) * (playerCount - 1),
+                bruteHits);
+    std::printf("  hashed grid : %8.1f us/tick  %zu candidates, %zu hits, %zu buckets\n", gridUs, pairs.size(), gridHits,
+                broadphase.getBucketCount());
+
+    if (gridHits != bruteHits) {
+        std::printf("  MISMATCH: broadphase missed or invented hits\n");
+        return false;
+    }
+    return true;
+}
+
+// Datagrams like the authority sends one client: every player's position and bullets each tick,
+// each message behind an 8-byte stand-in for ENet's send command, packed up to the MTU
+std::vector<std::vector<uint8_t>> recordSnapshotTraffic(int ticks, unsigned seed) {
+    const int playerCount = 8;
+    const float dt = 1.0f / 60.0f;
+
+    Map map;
+    Registry registry(playerCount);
+    Simulation simulation(registry, map);
+    JobSystem jobs(0);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> axis(-1, 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    for (int i = 0; i < playerCount; ++i) {
+        uint16_t owner = static_cast<uint16_t>(i + 1);
+        Entity entity = Player::spawn(registry, NetworkId{owner}, 5, RED, 10, PlayerShape::CIRCLE);
+        Player(registry, entity).setPosition(map.getSpawnPoint(owner));
+    }
+
+    std::vector<std::vector<uint8_t>> datagrams;
+    std::vector<uint8_t> datagram;
+    std::vector<uint8_t> payload;
+    uint16_t sequence = 0;
+    auto append = [&](uint8_t channel) {
+        if (!datagram.empty() && datagram.size() + 8 + payload.size() > ENET_HOST_DEFAULT_MTU) {
+            datagrams.push_back(std::move(datagram));
+            datagram.clear();
+        }
+        uint8_t header[8] = {ENET_PROTOCOL_COMMAND_SEND_UNRELIABLE, channel};
+        uint16_t length = static_cast<uint16_t>(payload.size());
+        sequence++;
+        std::memcpy(header + 2, &sequence, sizeof(sequence));
+        std::memcpy(header + 4, &sequence, sizeof(sequence));
+        std::memcpy(header + 6, &length, sizeof(length));
+        datagram.insert(datagram.end(), header, header + sizeof(header));
+        datagram.insert(datagram.end(), payload.begin(), payload.end());
+    };
+
+    for (int tick = 1; tick <= ticks; ++tick) {
+        std::vector<PlayerInput>& inputs = registry.getInputs();
+        for (PlayerInput& input : inputs) {
+            if (percent(rng) < 5) input.direction = {axis(rng), axis(rng)};
+            input.fire = percent(rng) < 30;
+        }
+        simulation.tick(jobs, dt);
+
+        for (size_t i = 0; i < registry.size(); ++i) {
+            Player player(registry, registry.entityAt(i));
+            if (!player.isAlive()) player.setHealth(100);
+            uint16_t owner = registry.getNetworkIds()[i].peer;
+
+            Position at = player.getPosition();
+            payload.resize(Protocol::PositionMessage::SIZE);
+            Protocol::PositionMessage::write(payload.data(), owner, static_cast<float>(at.x), static_cast<float>(at.y),
+                                             static_cast<uint32_t>(tick));
+            append(Protocol::CHANNEL_POSITION);
+
+            const std::vector<Bullet>& bullets = player.getBullets();
+            payload.resize(Protocol::BulletsMessage::sizeFor(bullets.size()));
+            Protocol::BulletsMessage::write(payload.data(), owner, player.getShotCount());
+            for (size_t b = 0; b < bullets.size(); ++b) {
+                bullets[b].serialize(Protocol::BulletsMessage::element(payload.data(), b));
+            }
+            append(Protocol::CHANNEL_BULLETS);
+        }
+
+        datagrams.push_back(std::move(datagram));
+        datagram.clear();
+    }
+    return datagrams;
+}
+
+// Static Huffman model trained on one session, measured on another, against ENet's adaptive range coder
+bool benchCompression() {
+    const int iterations = 20;
+    std::vector<std::vector<uint8_t>> training = recordSnapshotTraffic(600, 1);
+    std::vector<std::vector<uint8_t>> traffic = recordSnapshotTraffic(600, 2);
+
+    ByteModel model;
+    for (const std::vector<uint8_t>& datagram : training) model.add(datagram.data(), datagram.size());
+    HuffmanCoder huffman(model);
+    void* rangeCoder = enet_range_coder_create();
+
+    size_t rawBytes = 0;
+    for (const std::vector<uint8_t>& datagram : traffic) rawBytes += datagram.size();
+    std::printf("  %zu datagrams of 8-player snapshots, %zu bytes (avg %zu)\n", traffic.size(), rawBytes, rawBytes / traffic.size());
+
+    using CompressFn = std::function<size_t(const std::vector<uint8_t>&, uint8_t*)>;
+    using DecompressFn = std::function<size_t(const std::vector<uint8_t>&, uint8_t*, size_t)>;
+    bool ok = true;
+    auto report = [&](const char* name, const CompressFn& compress, const DecompressFn& decompress) {
+        // Like ENet, only keep a compressed datagram that came out smaller
+        std::vector<std::vector<uint8_t>> packed(traffic.size());
+        std::vector<uint8_t> scratch(ENET_PROTOCOL_MAXIMUM_MTU);
+        size_t sentBytes = 0;
+        for (size_t i = 0; i < traffic.size(); ++i) {
+            size_t written = compress(traffic[i], scratch.data());
+            if (written > 0 && written < traffic[i].size()) {
+                packed[i].assign(scratch.begin(), scratch.begin() + written);
+            }
+            sentBytes += packed[i].empty() ? traffic[i].size() : written;
+        }
+
+        for (size_t i = 0; i < traffic.size(); ++i) {
+            if (packed[i].empty()) continue;
+            size_t restored = decompress(packed[i], scratch.data(), scratch.size());
+            if (restored != traffic[i].size() || std::memcmp(scratch.data(), traffic[i].data(), restored) != 0) {
+                std::printf("  MISMATCH: %s did not round-trip datagram %zu\n", name, i);
+                ok = false;
+                return;
+            }
+        }
+
+        double compressUs = measure(iterations, [&] {
+            for (const std::vector<uint8_t>& datagram : traffic) compress(datagram, scratch.data());
+        });
+        double decompressUs = measure(iterations, [&] {
+            for (const std::vector<uint8_t>& datagram : packed) {
+                if (!datagram.empty()) decompress(datagram, scratch.data(), scratch.size());
+            }
+        });
+
+        double perDatagram = 1000.0 / traffic.size();
+        std::printf("  %-12s: ratio %.2f  compress %6.0f ns/datagram  decompress %6.0f ns/datagram\n", name,
+                    static_cast<double>(sentBytes) / rawBytes, compressUs * perDatagram, decompressUs * perDatagram);
+    };
+
+    report(
+        "huffman", [&](const std::vector<uint8_t>& in, uint8_t* out) { return huffman.compress(in.data(), in.size(), out, in.size()); },
+        [&](const std::vector<uint8_t>& in, uint8_t* out, size_t limit) { return huffman.decompress(in.data(), in.size(), out, limit); });
+    report(
+        "range coder",
+        [&](const std::vector<uint8_t>& in, uint8_t* out) {
+            ENetBuffer buffer;
+            buffer.data = const_cast<uint8_t*>(in.data());
+            buffer.dataLength = in.size();
+            return enet_range_coder_compress(rangeCoder, &buffer, 1, in.size(), out, in.size());
+        },
+        [&](const std::vector<uint8_t>& in, uint8_t* out, size_t limit) {
+            return enet_range_coder_decompress(rangeCoder, in.data(), in.size(), out, limit);
+        });
+
+    enet_range_coder_destroy(rangeCoder);
+    return ok;
+}
+
+// One server tick's packet churn: for every peer a position, a bullet list and a health packet,
+// each a packet record plus its data, all freed once sent
+bool benchPacketPool() {
+    const int peers = 256;
+    const int iterations = 200;
+
+    std::mt19937 rng(9);
+    std::vector<size_t> sizes;
+    for (int peer = 0; peer < peers; ++peer) {
+        size_t bullets = rng() % 7;
+        sizes.insert(sizes.end(), {sizeof(ENetPacket), Protocol::PositionMessage::SIZE, sizeof(ENetPacket),
+                                   Protocol::BulletsMessage::sizeFor(bullets), sizeof(ENetPacket), Protocol::HealthMessage::SIZE});
+    }
+    std::vector<void*> blocks(sizes.size());
+
+    double mallocUs = measure(iterations, [&] {
+        for (size_t i = 0; i < sizes.size(); ++i) blocks[i] = std::malloc(sizes[i]);
+        for (void* block : blocks) std::free(block);
+    });
+    double poolUs = measure(iterations, [&] {
+        for (size_t i = 0; i < sizes.size(); ++i) blocks[i] = PacketPool::allocate(sizes[i]);
+        for (void* block : blocks) PacketPool::release(block);
+    });
+
+    // The same churn through ENet itself once the pools are installed
+    if (PacketPool::initialize() != 0) {
+        std::printf("  ENet failed to initialize\n");
+        return false;
+    }
+    std::vector<ENetPacket*> packets(sizes.size() / 2);
+    double packetUs = measure(iterations, [&] {
+        for (size_t i = 0; i < packets.size(); ++i) packets[i] = PacketPool::createPacket(sizes[2 * i + 1], 0);
+        for (ENetPacket* packet : packets) enet_packet_destroy(packet);
+    });
+    enet_deinitialize();
+
+    double perPair = 1000.0 / sizes.size();
+    std::printf("  %zu allocations per tick: malloc/free %.1f ns, pool %.1f ns per pair\n", sizes.size(), mallocUs * perPair,
+                poolUs * perPair);
+    std::printf("  pooled NO_ALLOCATE packets: %.1f ns per create/destroy\n", packetUs * 1000.0 / packets.size());
+    PacketPool::printStats();
+    return true;
+}
+
+// Position messages through their declared layout against the memcpys one would write by hand,
+// which must produce the same bytes in the same time
+bool benchSchema() {
+    using Layout = Protocol::PositionMessage;
+    const size_t count = 4096;
+    const int iterations = 500;
+
+    std::mt19937 rng(10);
+    std::uniform_real_distribution<float> coordinate(0.0f, 4000.0f);
+    std::vector<float> xs(count), ys(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = coordinate(rng);
+        ys[i] = coordinate(rng);
+    }
+
+    std::vector<uint8_t> declared(count * Layout::SIZE), handWritten(count * Layout::SIZE);
+    double declaredUs = measure(iterations, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            Layout::write(declared.data() + i * Layout::SIZE, static_cast<uint16_t>(i), xs[i], ys[i], static_cast<uint32_t>(i));
+        }
+    });
+    double handUs = measure(iterations, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t* out = handWritten.data() + i * Layout::SIZE;
+            uint16_t owner = static_cast<uint16_t>(i);
+            uint32_t ackTick = static_cast<uint32_t>(i);
+            out[0] = static_cast<uint8_t>(Protocol::MessageType::POSITION);
+            std::memcpy(out + 1, &owner, sizeof(owner));
+            std::memcpy(out + 3, &xs[i], sizeof(float));
+            std::memcpy(out + 7, &ys[i], sizeof(float));
+            std::memcpy(out + 11, &ackTick, sizeof(ackTick));
+        }
+    });
+    bool ok = declared == handWritten;
+
+    float sum = 0.0f;
+    double readUs = measure(iterations, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t owner;
+            float x, y;
+            uint32_t ackTick;
+            if (Layout::read(declared.data() + i * Layout::SIZE, Layout::SIZE, owner, x, y, ackTick)) sum += x + y;
+        }
+    });
+
+    // Health and reset were both four bytes once; the type byte tells them apart now
+    uint8_t health[Protocol::HealthMessage::SIZE];
+    uint8_t reset[Protocol::ResetMessage::SIZE];
+    Protocol::HealthMessage::write(health, 1, 100);
+    Protocol::ResetMessage::write(reset);
+    Protocol::MessageType type;
+    ok = ok && Protocol::identify(Protocol::CHANNEL_HEALTH, health, sizeof(health), type) && type == Protocol::MessageType::HEALTH;
+    ok = ok && Protocol::identify(Protocol::CHANNEL_CONTROL, reset, sizeof(reset), type) && type == Protocol::MessageType::RESET;
+    ok = ok && !Protocol::identify(Protocol::CHANNEL_CONTROL, health, sizeof(health), type) && sum > 0.0f;
+
+    double perMessage = 1000.0 / count;
+    std::printf("  %zu-byte position: layout write %.2f ns, hand-written %.2f ns, layout read %.2f ns\n", Layout::SIZE,
+                declaredUs * perMessage, handUs * perMessage, readUs * perMessage);
+    if (!ok) std::printf("  MISMATCH: the layout's bytes differ from the hand-written ones, or a message was misidentified\n");
+    return ok;
+}
+
+// Walkers changing direction every so often, moved by the swept solver and by the old
+// full/x-only/y-only probing; the solver must never end a move inside an obstacle
+bool movementScenario(const char* label, const Map& map, int walkers) {
+    const int ticks = 300;
+    const int radius = 10;
+    const int speed = 5;
+
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> axis(-1, 1);
+    auto randomDelta = [&] {
+        Position direction = {axis(rng), axis(rng)};
+        if (direction.x == 0 && direction.y == 0) direction.x = 1;
+        return Position{direction.x * speed, direction.y * speed};
+    };
+
+    auto probe = [&](Position position, Position delta) {
+        Position moved = {position.x + delta.x, position.y + delta.y};
+        if (!map.isPlayerColliding(moved, radius)) return moved;
+        Position horizontal = {position.x + delta.x, position.y};
+        if (!map.isPlayerColliding(horizontal, radius)) return horizontal;
+        Position vertical = {position.x, position.y + delta.y};
+        return map.isPlayerColliding(vertical, radius) ? position : vertical;
+    };
+
+    std::vector<Position> starts;
+    std::vector<std::vector<Position>> deltas(walkers);
+    while (starts.size() < static_cast<size_t>(walkers)) {
+        Position start = {static_cast<int>(rng() % map.getWidth()), static_cast<int>(rng() % map.getHeight())};
+        if (map.isPlayerColliding(start, radius)) continue;
+        std::vector<Position>& path = deltas[starts.size()];
+        for (int tick = 0; tick < ticks; ++tick) {
+            path.push_back(tick % 40 == 0 ? randomDelta() : path.back());
+        }
+        starts.push_back(start);
+    }
+
+    int penetrations = 0;
+    long sweepStuck = 0;
+    long probeStuck = 0;
+    auto walk = [&](bool sweep) {
+        for (int walker = 0; walker < walkers; ++walker) {
+            Position position = starts[walker];
+            for (const Position& delta : deltas[walker]) {
+                Position moved = sweep ? map.moveCircle(position, radius, delta) : probe(position, delta);
+                if (moved.x == position.x && moved.y == position.y) (sweep ? sweepStuck : probeStuck)++;
+                if (sweep && map.isPlayerColliding(moved, radius)) penetrations++;
+                position = moved;
+            }
+        }
+    };
+    walk(true);
+    walk(false);
+
+    // Timed without the bookkeeping above
+    long checksum = 0;
+    double probeUs = measure(5, [&] {
+        for (int walker = 0; walker < walkers; ++walker) {
+            Position position = starts[walker];
+            for (const Position& delta : deltas[walker]) position = probe(position, delta);
+            checksum += position.x;
+        }
+    });
+    double sweepUs = measure(5, [&] {
+        for (int walker = 0; walker < walkers; ++walker) {
+            Position position = starts[walker];
+            for (const Position& delta : deltas[walker]) position = map.moveCircle(position, radius, delta);
+            checksum += position.x;
+        }
+    });
+
+    // Bullets against the map, through the BVH and by asking every obstacle as the map once did
+    const int bullets = 100000;
+    std::vector<Position> points(bullets);
+    for (Position& point : points) {
+        point = {static_cast<int>(rng() % map.getWidth()), static_cast<int>(rng() % map.getHeight())};
+    }
+    size_t bvhHits = 0;
+    size_t scanHits = 0;
+    double bulletUs = measure(5, [&] {
+        bvhHits = 0;
+        for (Position point : points) bvhHits += map.isBulletColliding(point, Bullet::MAX_RADIUS);
+    });
+    double scanUs = measure(5, [&] {
+        scanHits = 0;
+        for (Position point : points) {
+            for (const std::unique_ptr<Obstacle>& obstacle : map.getObstacles()) {
+                if (obstacle->isCollidingWithBullet(point, Bullet::MAX_RADIUS)) {
+                    scanHits++;
+                    break;
+                }
+            }
+        }
+    });
+
+    double perMove = 1000.0 / (walkers * ticks);
+    std::printf("  %s, %zu obstacles\n", label, map.getObstacles().size());
+    std::printf("    probing: %6.1f ns/move, %ld stuck moves\n", probeUs * perMove, probeStuck);
+    std::printf("    sweep  : %6.1f ns/move, %ld stuck moves (checksum %ld)\n", sweepUs * perMove, sweepStuck, checksum);
+    std::printf("    bullets: %6.1f ns through the BVH, %6.1f ns asking every obstacle\n", bulletUs * 1000.0 / bullets,
+                scanUs * 1000.0 / bullets);
+    bool ok = true;
+    if (penetrations > 0) {
+        std::printf("    MISMATCH: %d moves ended inside an obstacle\n", penetrations);
+        ok = false;
+    }
+    if (bvhHits != scanHits) {
+        std::printf("    MISMATCH: %zu bullets hit through the BVH, %zu asking every obstacle\n", bvhHits, scanHits);
+        ok = false;
+    }
+    return ok;
+}
+
+// The arena, then a 4096x4096 map about as crowded as a streamed world's resident chunks
+bool benchMovement() {
+    Map arena;
+    bool ok = movementScenario("arena", arena, 2000);
+
+    const int size = 4096;
+    std::mt19937 rng(12);
+    std::uniform_int_distribution<int> coordinate(0, size);
+    std::uniform_int_distribution<int> extent(20, 80);
+    std::vector<std::unique_ptr<Obstacle>> obstacles;
+    for (int i = 0; i < 1300; ++i) {
+        Position center = {coordinate(rng), coordinate(rng)};
+        if (i % 3 == 0) {
+            obstacles.push_back(std::make_unique<CircleObstacle>(center, extent(rng) / 2, GRAY));
+        } else {
+            obstacles.push_back(std::make_unique<RectangleObstacle>(center, extent(rng), extent(rng), GRAY));
+        }
+    }
+    Map large(size, size);
+    large.clearObstacles();
+    large.addObstacles(std::move(obstacles));
+    return movementScenario("large", large, 500) && ok;
+}
+
+// Reference ray test against every obstacle, with the geometry read back through the Obstacle classes
+float bruteForceRaycast(const Map& map, const Ray& ray) {
+    float nearest = -1.0f;
+    for (const auto& obstacle : map.getObstacles()) {
+        float cx = static_cast<float>(obstacle->getPosition().x);
+        float cy = static_cast<float>(obstacle->getPosition().y);
+        float distance = -1.0f;
+        if (obstacle->getType() == ObstacleType::CIRCLE) {
+            float radius = static_cast<float>(static_cast<const CircleObstacle&>(*obstacle).getRadius());
+            float mx = ray.originX - cx;
+            float my = ray.originY - cy;
+            float b = mx * ray.directionX + my * ray.directionY;
+            float c = mx * mx + my * my - radius * radius;
+            float discriminant = b * b - c;
+            if (discriminant >= 0.0f && (c <= 0.0f || b <= 0.0f)) distance = std::max(0.0f, -b - std::sqrt(discriminant));
+        } else {
+            const RectangleObstacle& rectangle = static_cast<const RectangleObstacle&>(*obstacle);
+            float lows[2] = {cx - rectangle.getWidth() / 2, cy - rectangle.getHeight() / 2};
+            float highs[2] = {cx + rectangle.getWidth() / 2, cy + rectangle.getHeight() / 2};
+            float origins[2] = {ray.originX, ray.originY};
+            float directions[2] = {ray.directionX, ray.directionY};
+            float enter = 0.0f;
+            float exit = 1e30f;
+            for (int axis = 0; axis < 2; ++axis) {
+                if (directions[axis] == 0.0f) {
+                    if (origins[axis] < lows[axis] || origins[axis] > highs[axis]) exit = -1.0f;
+                    continue;
+                }
+                // Same rounding as the BVH, so rays through a corner come out the same way
+                float inverse = 1.0f / directions[axis];
+                float t1 = (lows[axis] - origins[axis]) * inverse;
+                float t2 = (highs[axis] - origins[axis]) * inverse;
+                enter = std::max(enter, std::min(t1, t2));
+                exit = std::min(exit, std::max(t1, t2));
+            }
+            if (enter <= exit) distance = enter;
+        }
+        if (distance >= 0.0f && distance <= ray.maxDistance && (nearest < 0.0f || distance < nearest)) nearest = distance;
+    }
+    return nearest;
+}
+
+// Fans of 8 rays from random points (a burst of hitscan shots, or one bot scanning), traced
+// brute force, one at a time through the BVH and in packets. All three must agree.
+bool raycastScenario(const char* label, const Map& map, int width, int height, float range) {
+    const int origins = 8192;
+    const int fanSize = ObstacleBvh::PACKET_SIZE;
+    const int iterations = 5;
+
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> x(0.0f, static_cast<float>(width));
+    std::uniform_real_distribution<float> y(0.0f, static_cast<float>(height));
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+    std::vector<Ray> rays;
+    for (int origin = 0; origin < origins; ++origin) {
+        float ox = x(rng);
+        float oy = y(rng);
+        float heading = angle(rng);
+        for (int i = 0; i < fanSize; ++i) {
+            float direction = heading + (i - fanSize / 2) * 0.05f;
+            rays.push_back({ox, oy, std::cos(direction), std::sin(direction), range});
+        }
+    }
+
+    std::vector<float> reference(rays.size());
+    double bruteUs = measure(1, [&] {
+        for (size_t i = 0; i < rays.size(); ++i) reference[i] = bruteForceRaycast(map, rays[i]);
+    });
+
+    std::vector<RayHit> single(rays.size());
+    double singleUs = measure(iterations, [&] {
+        for (size_t i = 0; i < rays.size(); ++i) map.raycast(rays[i], single[i]);
+    });
+    std::vector<RayHit> packets(rays.size());
+    double packetUs = measure(iterations, [&] { map.raycast(rays.data(), rays.size(), packets.data()); });
+
+    // Line of sight from each origin to 8 points around it (one viewer against nearby players)
+    std::uniform_real_distribution<float> offset(-range / 2, range / 2);
+    std::vector<Position> from(rays.size());
+    std::vector<Position> to(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i) {
+        from[i] = {static_cast<int>(rays[i].originX), static_cast<int>(rays[i].originY)};
+        to[i] = {std::clamp(static_cast<int>(rays[i].originX + offset(rng)), 0, width),
+                 std::clamp(static_cast<int>(rays[i].originY + offset(rng)), 0, height)};
+    }
+    std::vector<char> visibility(rays.size());
+    double sightUs = measure(iterations, [&] {
+        for (size_t i = 0; i < rays.size(); ++i) visibility[i] = map.hasLineOfSight(from[i], to[i]);
+    });
+
+    size_t hitCount = 0;
+    size_t mismatches = 0;
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        bool hit = reference[i] >= 0.0f;
+        hitCount += hit;
+        for (const RayHit& candidate : {single[i], packets[i]}) {
+            if ((candidate.obstacle >= 0) != hit || (hit && std::fabs(candidate.distance - reference[i]) > 1e-3f)) mismatches++;
+        }
+        visibleCount += visibility[i];
+        float dx = static_cast<float>(to[i].x - from[i].x);
+        float dy = static_cast<float>(to[i].y - from[i].y);
+        float length = std::sqrt(dx * dx + dy * dy);
+        Ray sight = {static_cast<float>(from[i].x), static_cast<float>(from[i].y), length > 0.0f ? dx / length : 1.0f,
+                     length > 0.0f ? dy / length : 0.0f, length};
+        // Skip targets lying on a surface, where float rounding decides either way
+        float blockedAt = bruteForceRaycast(map, sight);
+        bool visible = blockedAt < 0.0f;
+        if (!visible && length - blockedAt < 1e-2f) continue;
+        if ((visibility[i] != 0) != visible) mismatches++;
+    }
+
+    double perRay = 1000.0 / rays.size();
+    std::printf("  %s: %zu obstacles, %zu rays, %zu hits, %zu of %zu pairs visible\n", label, map.getObstacles().size(), rays.size(),
+                hitCount, visibleCount, rays.size());
+    std::printf("    brute force  : %7.1f ns/ray\n", bruteUs * perRay);
+    std::printf("    bvh single   : %7.1f ns/ray  %6.2f Mrays/s\n", singleUs * perRay, rays.size() / singleUs);
+    std::printf("    bvh packets  : %7.1f ns/ray  %6.2f Mrays/s\n", packetUs * perRay, rays.size() / packetUs);
+    std::printf("    line of sight: %7.1f ns/pair\n", sightUs * perRay);
+    if (mismatches > 0) {
+        std::printf("    MISMATCH: %zu results differ from the brute force reference\n", mismatches);
+        return false;
+    }
+    return true;
+}
+
+// The arena as shipped, and a large map densely filled with random obstacles
+bool benchRaycast() {
+    Map arena;
+    bool ok = raycastScenario("arena", arena, arena.getWidth(), arena.getHeight(), 1000.0f);
+
+    const int size = 4000;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> coordinate(0, size);
+    std::uniform_int_distribution<int> extent(10, 60);
+    std::vector<std::unique_ptr<Obstacle>> obstacles;
+    for (int i = 0; i < 2000; ++i) {
+        Position center = {coordinate(rng), coordinate(rng)};
+        if (i % 3 == 0) {
+            obstacles.push_back(std::make_unique<CircleObstacle>(center, extent(rng) / 2, GRAY));
+        } else {
+            obstacles.push_back(std::make_unique<RectangleObstacle>(center, extent(rng), extent(rng), GRAY));
+        }
+    }
+    Map dense(size, size);
+    dense.clearObstacles();
+    dense.addObstacles(std::move(obstacles));
+    ok = raycastScenario("dense", dense, size, size, 800.0f) && ok;
+    return ok;
+}
+
+// Bots chasing one scripted player around the arena, fed through the same command path the match
+// uses. Compares the per-tick cost of 1 and 50 bots with a full search per bot, and requires
+// nearly all of them to have the player in their sights at the end.
+bool benchBots() {
+    const int ticks = 900;
+    const float dt = 1.0f / 60.0f;
+    const uint16_t human = 1;
+
+    Map map;
+    NavigationGrid navigation(map, 10);
+    JobSystem jobs(0);
+    bool ok = true;
+    double fieldUs = 0.0;
+    for (int botCount : {1, 10, 50}) {
+        Registry registry(botCount + 1);
+        Simulation simulation(registry, map);
+        simulation.setResolveDamage(false);  // Keep the target alive for the whole run
+        BotDirector director(map, navigation);
+
+        Entity player = Player::spawn(registry, NetworkId{human}, 5, RED, 10, PlayerShape::CIRCLE);
+        Player(registry, player).setPosition({map.getWidth() / 2, map.getHeight() / 2 - 90});
+
+        // Bots start on random open cells
+        const NavigationGrid& grid = director.getGrid();
+        std::mt19937 rng(3);
+        for (int i = 0; i < botCount; ++i) {
+            uint32_t cell;
+            do {
+                cell = static_cast<uint32_t>(rng() % grid.getCellCount());
+            } while (!grid.isWalkable(cell));
+            uint16_t owner = static_cast<uint16_t>(Protocol::OWNER_BOT_FIRST + i);
+            director.add(owner);
+            Entity bot = Player::spawn(registry, NetworkId{owner}, 5, RED, 10, PlayerShape::CIRCLE);
+            Player(registry, bot).setPosition(grid.centerOf(cell));
+        }
+
+        // The player walks a loop round the central pillar
+        const Position legs[] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+        double thinkUs = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            auto start = Clock::now();
+            director.think(registry);
+            thinkUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+            std::vector<PlayerInput>& inputs = registry.getInputs();
+            for (size_t i = 0; i < networkIds.size(); ++i) {
+                CommandQueue* commands = director.commandQueueFor(networkIds[i].peer);
+                inputs[i] = commands ? commands->next() : PlayerInput{legs[(tick / 36) % 4], false};
+            }
+            simulation.tick(jobs, dt);
+        }
+
+        Position target = Player(registry, player).getPosition();
+        int engaged = 0;
+        for (size_t i = 0; i < registry.size(); ++i) {
+            Position at = registry.getTransforms()[i].position;
+            int dx = at.x - target.x;
+            int dy = at.y - target.y;
+            if (registry.entityAt(i) != player && dx * dx + dy * dy <= BotDirector::FIRE_RANGE * BotDirector::FIRE_RANGE &&
+                map.hasLineOfSight(at, target)) {
+                engaged++;
+            }
+        }
+
+        // Reference: one complete search, what every bot would pay on its own
+        if (fieldUs == 0.0) {
+            FlowField field(grid);
+            uint32_t targets[2] = {grid.cellAt(target), grid.cellAt(map.getSpawnPoint(0))};
+            int flip = 0;
+            fieldUs = measure(20, [&] {
+                field.setTarget(targets[flip ^= 1]);
+                while (field.advance(grid.getCellCount()) > 0) {
+                }
+            });
+            std::printf("  grid %dx%d, one full search %.1f us\n", grid.getWidth(), grid.getHeight(), fieldUs);
+        }
+
+        std::printf("  %2d bots: %6.1f us/tick thinking with %zu shared field(s), %7.1f us with a search per bot; %d/%d engaged\n",
+                    botCount, thinkUs / ticks, director.getFieldCount(), fieldUs * botCount, engaged, botCount);
+        if (engaged * 10 < botCount * 9) {
+            std::printf("  MISMATCH: bots lost the player\n");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// A busy fight's worth of effects: 20 bursts of 16 particles every frame at 60 fps. The pool is
+// checked against the same arithmetic on a vector of structs pruned with erase/remove_if, the
+// way bullets are kept.
+bool benchParticles() {
+    struct Particle {
+        float x, y, velocityX, velocityY, life;
+    };
+
+    const int frames = 600;
+    const int burstsPerFrame = 20;
+    const int perBurst = 16;
+    const float dt = 1.0f / 60.0f;
+    const float drag = 4.0f;
+
+    ParticlePool pool(16384, 3.0f, drag);
+    std::vector<Particle> reference;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> coordinate(0.0f, 800.0f);
+    std::uniform_real_distribution<float> heading(-3.14159265f, 3.14159265f);
+
+    double poolUs = 0.0;
+    double referenceUs = 0.0;
+    bool ok = true;
+    for (int frame = 0; frame < frames; ++frame) {
+        for (int burst = 0; burst < burstsPerFrame; ++burst) {
+            // No spread and a single speed, so every particle's velocity is known from outside the pool
+            float x = coordinate(rng);
+            float y = coordinate(rng);
+            float angle = heading(rng);
+            size_t first = pool.size();
+            pool.emit(x, y, angle, 0.0f, 150.0f, 150.0f, 0.5f, GOLD, perBurst);
+            for (size_t i = first; i < pool.size(); ++i) {
+                reference.push_back({x, y, std::cos(angle) * 150.0f, std::sin(angle) * 150.0f, pool.getLife(i)});
+            }
+        }
+
+        auto start = Clock::now();
+        pool.update(dt);
+        poolUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        start = Clock::now();
+        float damping = std::max(0.0f, 1.0f - drag * dt);
+        for (Particle& particle : reference) {
+            particle.x += particle.velocityX * dt;
+            particle.y += particle.velocityY * dt;
+            particle.velocityX *= damping;
+            particle.velocityY *= damping;
+            particle.life -= dt;
+        }
+        reference.erase(std::remove_if(reference.begin(), reference.end(), [](const Particle& particle) { return particle.life <= 0.0f; }),
+                        reference.end());
+        referenceUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        // Survivors are in a different order, so compare what doesn't depend on it
+        double poolSum = 0.0;
+        double referenceSum = 0.0;
+        for (size_t i = 0; i < pool.size(); ++i) {
+            poolSum += pool.getX(i) + pool.getY(i);
+        }
+        for (const Particle& particle : reference) {
+            referenceSum += particle.x + particle.y;
+        }
+        if (pool.size() != reference.size() || std::fabs(poolSum - referenceSum) > 1e-3 * (1.0 + std::fabs(referenceSum))) {
+            ok = false;
+        }
+    }
+
+    std::printf("  %zu live particles: pool %.2f us/frame, vector of structs %.2f us/frame\n", pool.size(), poolUs / frames,
+                referenceUs / frames);
+    if (!ok) {
+        std::printf("  MISMATCH: pool and reference diverged\n");
+    }
+    return ok;
+}
+
+// Eight players running straight across a 4096x4096-chunk world, faster than anyone could, so
+// chunks stream in and out all the time. The tick calls update() and never waits on the generator.
+// Every resident chunk must match a fresh generation from the seed, and residency must stay bounded.
+bool benchChunks() {
+    const int ticks = 3000;
+    const float dt = 1.0f / 60.0f;
+    const int speed = 30;  // Pixels per tick
+
+    ChunkedWorldConfig config;
+    config.seed = 42;
+    config.evictAfterTicks = 120;
+    ChunkedWorld world(config);
+    const Map& map = world.getMap();
+
+    Registry registry(8);
+    Simulation simulation(registry, map);
+    JobSystem jobs(0);
+    const Position headings[] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}, {1, -1}, {-1, 0}, {0, -1}, {-1, -1}};
+    for (int i = 0; i < 8; ++i) {
+        Entity player = Player::spawn(registry, NetworkId{static_cast<uint16_t>(i + 1)}, speed, RED, 10, PlayerShape::CIRCLE);
+        Player(registry, player).setPosition({map.getWidth() / 2 + i * 3000, map.getHeight() / 2 - i * 2000});
+    }
+
+    std::vector<Position> positions;
+    double updateUs = 0.0;
+    double worstUs = 0.0;
+    size_t mostResident = 0;
+    size_t mostObstacles = 0;
+    size_t mostPending = 0;
+    size_t late = 0;  // Player-ticks spent in a chunk that wasn't resident yet
+    Position start = registry.getTransforms()[0].position;
+    for (int tick = 0; tick < ticks; ++tick) {
+        std::vector<PlayerInput>& inputs = registry.getInputs();
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            inputs[i] = PlayerInput{headings[i], false};
+        }
+        simulation.tick(jobs, dt);
+
+        positions.clear();
+        for (const Transform& transform : registry.getTransforms()) {
+            positions.push_back(transform.position);
+        }
+        auto begin = Clock::now();
+        world.update(positions, static_cast<uint32_t>(tick));
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+        updateUs += us;
+        worstUs = std::max(worstUs, us);
+
+        for (Position position : positions) {
+            late += !world.isResident(position.x / config.chunkSize, position.y / config.chunkSize);
+        }
+        mostResident = std::max(mostResident, world.getResidentCount());
+        mostObstacles = std::max(mostObstacles, world.getObstacleCount());
+        mostPending = std::max(mostPending, world.getPendingCount());
+        std::this_thread::yield();  // A server sleeps until its next tick; give the generator the core here
+    }
+    Position end = registry.getTransforms()[0].position;
+
+    // Regenerating from the seed must give the resident chunks exactly
+    bool ok = true;
+    size_t checked = 0;
+    std::vector<ObstacleSpec> fresh;
+    for (int y = 0; y < config.chunksAcross && checked < world.getResidentCount(); ++y) {
+        for (int x = 0; x < config.chunksAcross; ++x) {
+            const std::vector<ObstacleSpec>* chunk = world.getChunk(x, y);
+            if (!chunk) continue;
+            ChunkedWorld::generate(config.seed, config.chunkSize, x, y, fresh);
+            bool same = fresh.size() == chunk->size();
+            for (size_t i = 0; same && i < fresh.size(); ++i) {
+                const ObstacleSpec& a = fresh[i];
+                const ObstacleSpec& b = (*chunk)[i];
+                same = a.type == b.type && a.center.x == b.center.x && a.center.y == b.center.y && a.width == b.width &&
+                       a.height == b.height && a.radius == b.radius;
+            }
+            ok = ok && same;
+            checked++;
+        }
+    }
+    if (mostResident > config.maxResident) {
+        ok = false;
+    }
+
+    double chunks = static_cast<double>(config.chunksAcross) * config.chunksAcross;
+    std::printf("  player 0 travelled %d px in %d ticks; %lu chunks generated, %lu evicted, %lu map rebuilds\n",
+                std::abs(end.x - start.x) + std::abs(end.y - start.y), ticks, world.getGeneratedCount(), world.getEvictedCount(),
+                world.getRebuildCount());
+    std::printf("  update %.1f us/tick, worst %.1f us; at most %zu resident chunks (%zu obstacles) and %zu pending\n",
+                updateUs / ticks, worstUs, mostResident, mostObstacles, mostPending);
+    std::printf("  %zu of %d player-ticks in a chunk still generating; the whole world would be %.0f chunks (~%.0fM obstacles)\n",
+                late, ticks * 8, chunks, chunks * 10 / 1e6);
+    if (!ok) {
+        std::printf("  MISMATCH: a resident chunk differs from its seed, or residency went over the cap\n");
+    }
+    return ok;
+}
+
+// Obstacles a following camera has to draw, found through the BVH and by testing every obstacle's
+// bounds, on the arena and on a 16000-pixel map with 20000 obstacles. Both must find the same set.
+bool cullingScenario(const char* label, const Map& map) {
+    const int frames = 600;
+    const std::vector<std::unique_ptr<Obstacle>>& obstacles = map.getObstacles();
+
+    // The camera crosses the map diagonally, one screen-sized view per frame
+    FollowCamera camera(Constants::SCREEN_WIDTH, Constants::SCREEN_HEIGHT);
+    std::vector<WorldRect> views;
+    for (int frame = 0; frame < frames; ++frame) {
+        camera.follow({map.getWidth() * frame / frames, map.getHeight() * frame / frames}, map.getWidth(), map.getHeight());
+        views.push_back(camera.getView());
+    }
+
+    std::vector<size_t> bvhCounts(frames), bruteCounts(frames);
+    std::vector<long long> bvhSums(frames), bruteSums(frames);
+    double bvhUs = measure(10, [&] {
+        for (int frame = 0; frame < frames; ++frame) {
+            bvhCounts[frame] = 0;
+            bvhSums[frame] = 0;
+            map.forEachObstacleIn(views[frame], [&](int index) {
+                bvhCounts[frame]++;
+                bvhSums[frame] += index;
+            });
+        }
+    });
+    double bruteUs = measure(10, [&] {
+        for (int frame = 0; frame < frames; ++frame) {
+            const WorldRect& view = views[frame];
+            bruteCounts[frame] = 0;
+            bruteSums[frame] = 0;
+            for (size_t i = 0; i < obstacles.size(); ++i) {
+                Position center = obstacles[i]->getPosition();
+                float halfWidth, halfHeight;
+                if (obstacles[i]->getType() == ObstacleType::RECTANGLE) {
+                    const RectangleObstacle& rectangle = static_cast<const RectangleObstacle&>(*obstacles[i]);
+                    halfWidth = static_cast<float>(rectangle.getWidth() / 2);
+                    halfHeight = static_cast<float>(rectangle.getHeight() / 2);
+                } else {
+                    halfWidth = halfHeight = static_cast<float>(static_cast<const CircleObstacle&>(*obstacles[i]).getRadius());
+                }
+                if (center.x + halfWidth < view.minX || center.x - halfWidth > view.maxX || center.y + halfHeight < view.minY ||
+                    center.y - halfHeight > view.maxY) {
+                    continue;
+                }
+                bruteCounts[frame]++;
+                bruteSums[frame] += static_cast<long long>(i);
+            }
+        }
+    });
+
+    size_t visible = 0;
+    bool ok = true;
+    for (int frame = 0; frame < frames; ++frame) {
+        visible += bvhCounts[frame];
+        ok = ok && bvhCounts[frame] == bruteCounts[frame] && bvhSums[frame] == bruteSums[frame];
+    }
+    std::printf("  %s: %zu obstacles, %.1f in view on average: bvh %.2f us/frame, every obstacle %.2f us/frame\n", label,
+                obstacles.size(), static_cast<double>(visible) / frames, bvhUs / frames, bruteUs / frames);
+    if (!ok) {
+        std::printf("  MISMATCH: the BVH and the brute force found different obstacles\n");
+    }
+    return ok;
+}
+
+bool benchCulling() {
+    Map arena;
+    bool ok = cullingScenario("arena", arena);
+
+    const int size = 16000;
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> coordinate(0, size);
+    std::uniform_int_distribution<int> extent(10, 60);
+    std::vector<std::unique_ptr<Obstacle>> obstacles;
+    for (int i = 0; i < 20000; ++i) {
+        Position center = {coordinate(rng), coordinate(rng)};
+        if (i % 3 == 0) {
+            obstacles.push_back(std::make_unique<CircleObstacle>(center, extent(rng) / 2, GRAY));
+        } else {
+            obstacles.push_back(std::make_unique<RectangleObstacle>(center, extent(rng), extent(rng), GRAY));
+        }
+    }
+    Map large(size, size);
+    large.clearObstacles();
+    large.addObstacles(std::move(obstacles));
+    return cullingScenario("large", large) && ok;
+}
+
+// One person and 7 bots in a match, watched by more and more spectators one second behind
+bool benchSpectators() {
+    const int ticks = 600;
+    const uint32_t delay = 60;
+    const float dt = 1.0f / 60.0f;
+
+    Map map;
+    NavigationGrid navigation(map, Match::PLAYER_RADIUS);
+    JobSystem jobs(0);
+    bool ok = true;
+    double baseUs = 0.0;
+    double encodeUs = 0.0;  // What one frame adds to a tick
+    for (int spectatorCount : {0, 1, 100, 1000}) {
+        Match match(0, map, navigation, 60);
+        match.setBotFill(8);
+        match.setSpectatorDelay(delay);
+        match.join(0, 0);
+        for (int i = 1; i <= spectatorCount; ++i) {
+            match.watch(static_cast<uint16_t>(i));
+        }
+
+        Registry watched;
+        size_t frames = 0;
+        size_t frameBytes = 0;
+        double tickUs = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            auto start = Clock::now();
+            match.tick(jobs, dt);
+            tickUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            for (const OutboundMessage& message : match.getOutbox()) {
+                if (message.channel != Protocol::CHANNEL_SPECTATE) continue;
+
+                uint32_t frameTick = Protocol::SpectateMessage::get<0>(message.payload.data());
+                if (message.recipients.size() != static_cast<size_t>(spectatorCount) || frameTick != match.getTickCount() - delay ||
+                    !applySpectatorFrame(watched, message.payload.data(), message.payload.size()) || watched.size() != 8) {
+                    ok = false;
+                }
+                frames++;
+                frameBytes += message.payload.size();
+            }
+            match.getOutbox().clear();
+        }
+        tickUs /= ticks;
+
+        size_t expected = spectatorCount > 0 ? static_cast<size_t>(ticks) - delay : 0;
+        if (frames != expected) {
+            ok = false;
+        }
+        if (spectatorCount == 0) {
+            baseUs = tickUs;
+            std::printf("  %4d spectators: %6.1f us/tick\n", spectatorCount, tickUs);
+            continue;
+        }
+        if (spectatorCount == 1) {
+            encodeUs = tickUs - baseUs;
+        }
+        std::printf("  %4d spectators: %6.1f us/tick, one %zu-byte frame per tick shared by all; a frame each would be %8.1f us\n",
+                    spectatorCount, tickUs, frames ? frameBytes / frames : 0, baseUs + encodeUs * spectatorCount);
+    }
+    if (!ok) {
+        std::printf("  MISMATCH: spectators missed frames or got the wrong ones\n");
+    }
+    return ok;
+}
+
+// Ticks the match until the peer has every chunk of its snapshot; false if it never completes
+bool streamSnapshot(Match& match, JobSystem& jobs, uint16_t peer, SnapshotAssembler& assembler, int& ticks, size_t& bytes) {
+    assembler.clear();
+    ticks = 0;
+    bytes = 0;
+    while (!assembler.isComplete() && ticks < 600) {
+        match.tick(jobs, 1.0f / 60.0f);
+        ticks++;
+        for (const OutboundMessage& message : match.getOutbox()) {
+            if (message.channel != Protocol::CHANNEL_SNAPSHOT || message.recipients != std::vector<uint16_t>{peer}) continue;
+            if (!assembler.add(message.payload.data(), message.payload.size())) return false;
+            bytes += message.payload.size();
+        }
+        match.getOutbox().clear();
+    }
+    return assembler.isComplete();
+}
+
+// What a client does with a finished snapshot, into an empty registry
+double decodeAndApply(const std::vector<uint8_t>& data, Snapshot& snapshot, Registry& registry, bool& ok) {
+    auto start = Clock::now();
+    ok = decodeSnapshot(data.data(), data.size(), snapshot);
+    for (const SnapshotPlayer& player : snapshot.players) {
+        Entity entity = registry.findByNetworkId(player.owner);
+        if (entity == NULL_ENTITY) {
+            entity = Player::spawn(registry, NetworkId{player.owner}, 5, RED, 10, PlayerShape::CIRCLE);
+        }
+        restorePlayer(registry, entity, player, true);
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Late join and resume in a match of one person and 7 bots, then a worst case of 64 players
+// with 64 bullets each. The snapshot has to arrive whole, round-trip exactly and apply well
+// inside one 60 Hz frame.
+bool benchSnapshot() {
+    const double frameBudgetUs = 1000000.0 / 60.0;
+    const uint32_t session = 77;
+
+    Map map;
+    NavigationGrid navigation(map, Match::PLAYER_RADIUS);
+    JobSystem jobs(0);
+    Match match(0, map, navigation, 60);
+    match.setBotFill(8);
+    match.setResumeWindow(600);
+    match.join(0, session);
+    for (int tick = 0; tick < 300; ++tick) {
+        match.tick(jobs, 1.0f / 60.0f);
+        match.getOutbox().clear();
+    }
+
+    bool ok = true;
+    SnapshotAssembler assembler;
+    Snapshot snapshot;
+    int ticks;
+    size_t bytes;
+    bool decoded;
+
+    // Someone joining late gets the whole match
+    match.join(1, 0);
+    ok = streamSnapshot(match, jobs, 1, assembler, ticks, bytes) && ok;
+    Registry joined;
+    double applyUs = decodeAndApply(assembler.getData(), snapshot, joined, decoded);
+    ok = ok && decoded && joined.size() == 8 && snapshot.worldWidth == map.getWidth();
+    std::printf("  late join: %zu players in %zu bytes, playable after %d tick(s), decode+apply %.1f us of a %.0f us frame\n",
+                snapshot.players.size(), bytes, ticks, applyUs, frameBudgetUs);
+
+    // The first player drops and comes back as another peer within the window
+    match.leave(0);
+    for (int tick = 0; tick < 30; ++tick) {
+        match.tick(jobs, 1.0f / 60.0f);
+        match.getOutbox().clear();
+    }
+    ok = ok && match.getSuspendedCount() == 1;
+    match.join(2, session);
+    ok = ok && match.getSuspendedCount() == 0 && match.getPlayerCount() == 2;
+    ok = streamSnapshot(match, jobs, 2, assembler, ticks, bytes) && ok;
+    Registry resumed;
+    applyUs = decodeAndApply(assembler.getData(), snapshot, resumed, decoded);
+    ok = ok && decoded && resumed.size() == 8 && resumed.findByNetworkId(Protocol::ownerForPeer(0)) == NULL_ENTITY &&
+         resumed.findByNetworkId(Protocol::ownerForPeer(2)) != NULL_ENTITY;
+    std::printf("  resume:    %zu players in %zu bytes, playable after %d tick(s), decode+apply %.1f us\n", snapshot.players.size(),
+                bytes, ticks, applyUs);
+
+    // Under a budget too small for any chunk the snapshot still gets through, a chunk at a time
+    match.setClientBudget(100);
+    match.join(3, 0);
+    ok = streamSnapshot(match, jobs, 3, assembler, ticks, bytes) && ok;
+    Registry budgeted;
+    decodeAndApply(assembler.getData(), snapshot, budgeted, decoded);
+    ok = ok && decoded && budgeted.size() == 8 && ticks > 1;
+    std::printf("  budgeted:  %zu players in %zu bytes at a 100-byte budget, playable after %d tick(s)\n", snapshot.players.size(),
+                bytes, ticks);
+    match.setClientBudget(0);
+
+    // Worst case: a full 64-player fight
+    std::mt19937 rng(45);
+    std::uniform_int_distribution<int> coordinate(0, 1000);
+    Registry busy(64);
+    std::vector<uint32_t> acks;
+    for (uint16_t owner = 1; owner <= 64; ++owner) {
+        Entity entity = Player::spawn(busy, NetworkId{owner}, 5, RED, 10, PlayerShape::CIRCLE);
+        Player player(busy, entity);
+        player.setPosition({coordinate(rng), coordinate(rng)});
+        player.setHealth(coordinate(rng) % 100 + 1);
+        Weapon& weapon = busy.getWeapon(entity);
+        weapon.timeSinceLastShot = 0.05f * (owner % 7);
+        weapon.type = static_cast<uint8_t>(owner % PROJECTILE_TYPE_COUNT);
+        for (int b = 0; b < 64; ++b) {
+            uint8_t type = static_cast<uint8_t>(b % PROJECTILE_TYPE_COUNT);
+            weapon.bullets.emplace_back(Position{coordinate(rng), coordinate(rng)}, Vector2{0, 1}, type);
+        }
+        acks.push_back(owner * 3u);
+    }
+    Snapshot full;
+    full.tick = 1234;
+    full.worldWidth = map.getWidth();
+    full.worldHeight = map.getHeight();
+    std::vector<uint8_t> encoded;
+    double encodeUs = measure(20, [&] {
+        captureSnapshot(busy, acks, full);
+        encodeSnapshot(full, encoded);
+    });
+
+    // Through chunks and back, as the stream delivers it
+    size_t chunks = snapshotChunkCount(encoded.size());
+    std::vector<uint8_t> message;
+    assembler.clear();
+    for (size_t i = 0; i < chunks; ++i) {
+        writeSnapshotChunk(encoded, full.tick, static_cast<uint16_t>(i), message);
+        ok = ok && message.size() <= Protocol::SnapshotMessage::MAX_SIZE &&
+             assembler.add(message.data(), message.size());
+    }
+    ok = ok && assembler.isComplete() && assembler.getData() == encoded;
+
+    Registry restored(64);
+    double restoreUs = 0.0;
+    for (int i = 0; i < 20; ++i) {
+        restoreUs += decodeAndApply(assembler.getData(), snapshot, restored, decoded) / 20;
+        ok = ok && decoded;
+    }
+    std::vector<uint8_t> again;
+    captureSnapshot(restored, acks, snapshot);
+    snapshot.tick = full.tick;
+    encodeSnapshot(snapshot, again);
+    ok = ok && again == encoded && restoreUs < frameBudgetUs;
+    size_t streamTicks = (chunks + Protocol::SNAPSHOT_CHUNKS_PER_TICK - 1) / Protocol::SNAPSHOT_CHUNKS_PER_TICK;
+    std::printf("  64 players, 4096 bullets: %zu bytes in %zu chunks (%zu ticks of streaming), encode %.1f us, decode+apply %.1f us\n",
+                encoded.size(), chunks, streamTicks, encodeUs, restoreUs);
+
+    if (!ok) {
+        std::printf("  MISMATCH: a snapshot was incomplete, didn't round-trip or missed the frame budget\n");
+    }
+    return ok;
+}
+
+// Eight members in the corners of a large world with bots all over it, at several per-member
+// budgets. A member's player state must stay within its budget (only a tick whose one pick was
+// larger than the whole budget may go over), every player must keep reaching every member, and
+// the players near a member must reach it more often than the far ones.
+bool benchBandwidth() {
+    const int ticks = 600;
+    const uint16_t memberCount = 8;
+    const size_t overhead = 8;  // Per message, as the match counts it
+    const long long near = 800;
+
+    Map map(4000, 4000);
+    NavigationGrid navigation(map, Match::PLAYER_RADIUS);
+    bool ok = true;
+    for (size_t budget : {size_t(0), size_t(1200), size_t(400), size_t(150)}) {
+        JobSystem jobs(0);
+        Match match(0, map, navigation, 60);
+        match.setBotFill(48);
+        match.setClientBudget(budget);
+        for (uint16_t peer = 0; peer < memberCount; ++peer) {
+            match.join(peer, 0);
+        }
+
+        std::vector<Position> own(memberCount);
+        std::vector<std::vector<int>> lastSent(memberCount);  // By owner, -1 until first sent
+        double nearGaps = 0.0, farGaps = 0.0;
+        size_t nearCount = 0, farCount = 0;
+        int longestGap = 0;
+        size_t peakBytes = 0;
+        size_t totalBytes = 0;
+        double tickUs = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            auto start = Clock::now();
+            match.tick(jobs, 1.0f / 60.0f);
+            tickUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            std::vector<size_t> bytes(memberCount, 0);
+            std::vector<int> picks(memberCount, 0);
+            for (const OutboundMessage& message : match.getOutbox()) {
+                if (message.channel != Protocol::CHANNEL_POSITION) continue;
+                uint16_t owner = Protocol::readOwner(message.payload.data());
+                for (uint16_t member : message.recipients) {
+                    if (owner == Protocol::ownerForPeer(member)) {
+                        own[member] = {static_cast<int>(Protocol::PositionMessage::get<1>(message.payload.data())),
+                                       static_cast<int>(Protocol::PositionMessage::get<2>(message.payload.data()))};
+                    }
+                }
+            }
+            for (const OutboundMessage& message : match.getOutbox()) {
+                if (message.channel != Protocol::CHANNEL_POSITION && message.channel != Protocol::CHANNEL_BULLETS) continue;
+                uint16_t owner = Protocol::readOwner(message.payload.data());
+                for (uint16_t member : message.recipients) {
+                    bytes[member] += message.payload.size() + overhead;
+                    if (message.channel != Protocol::CHANNEL_POSITION || owner == Protocol::ownerForPeer(member)) continue;
+                    picks[member]++;
+
+                    long long dx = static_cast<long long>(Protocol::PositionMessage::get<1>(message.payload.data())) - own[member].x;
+                    long long dy = static_cast<long long>(Protocol::PositionMessage::get<2>(message.payload.data())) - own[member].y;
+                    std::vector<int>& sent = lastSent[member];
+                    if (owner >= sent.size()) sent.resize(owner + 1, -1);
+                    if (sent[owner] >= 0) {
+                        int gap = tick - sent[owner];
+                        longestGap = std::max(longestGap, gap);
+                        if (dx * dx + dy * dy <= near * near) {
+                            nearGaps += gap;
+                            nearCount++;
+                        } else {
+                            farGaps += gap;
+                            farCount++;
+                        }
+                    }
+                    sent[owner] = tick;
+                }
+            }
+            match.getOutbox().clear();
+
+            for (uint16_t member = 0; member < memberCount; ++member) {
+                totalBytes += bytes[member];
+                peakBytes = std::max(peakBytes, bytes[member]);
+                if (budget > 0 && bytes[member] > budget && picks[member] > 1) ok = false;
+            }
+        }
+
+        // Everyone still in the match has to have reached every member in the second half of the run
+        int reached = 0;
+        int players = static_cast<int>(match.getPlayerCount() + match.getBotCount());
+        for (uint16_t member = 0; member < memberCount; ++member) {
+            for (int sent : lastSent[member]) {
+                if (sent >= ticks / 2) reached++;
+            }
+        }
+        ok = ok && reached >= memberCount * (players - 1);
+        double nearGap = nearCount ? nearGaps / nearCount : 0.0;
+        double farGap = farCount ? farGaps / farCount : 0.0;
+        if (budget > 0) ok = ok && nearGap <= farGap;
+
+        char label[32];
+        std::snprintf(label, sizeof(label), budget > 0 ? "%zu bytes/tick" : "unlimited", budget);
+        std::printf("  %-16s %6.1f us/tick, %5zu bytes/member/tick (peak %5zu), sent every %.1f ticks near, %.1f far, longest gap %d\n",
+                    label, tickUs / ticks, totalBytes / ticks / memberCount, peakBytes, nearGap, farGap, longestGap);
+    }
+
+    if (!ok) {
+        std::printf("  MISMATCH: a member went over its budget, or a player stopped reaching it\n");
+    }
+    return ok;
+}
+
+// A 64-player match (16 members walking and shooting, bots for the rest) with a per-member budget
+// and a spectator, ticked inline and on a pool of workers side by side. Every tick both outboxes
+// must match byte for byte: the same messages in the same order with the same recipients. The pool
+// gets at least three workers so work stealing runs even on a small machine.
+bool benchWorkers() {
+    const int ticks = 600;
+    const uint16_t memberCount = 16;
+    const double targetMs = 8.0;
+
+    Map map(4000, 4000);
+    NavigationGrid navigation(map, Match::PLAYER_RADIUS);
+    JobSystem inlineJobs(0);
+    JobSystem pool(std::max<size_t>(JobSystem::defaultWorkerCount(), 3));
+    Match serial(0, map, navigation, 60);
+    Match parallel(1, map, navigation, 60);
+    for (Match* match : {&serial, &parallel}) {
+        match->setBotFill(64);
+        match->setClientBudget(600);
+        match->setSpectatorDelay(0);
+        match->watch(memberCount);
+        for (uint16_t peer = 0; peer < memberCount; ++peer) {
+            match->join(peer, 0);
+        }
+    }
+
+    bool ok = true;
+    double serialMs = 0.0, parallelMs = 0.0, worstSerialMs = 0.0, worstParallelMs = 0.0;
+    size_t messages = 0;
+    uint8_t input[Protocol::InputMessage::MAX_SIZE];
+    for (int tick = 0; tick < ticks; ++tick) {
+        for (uint16_t peer = 0; peer < memberCount; ++peer) {
+            int leg = (tick / 90 + peer) % 4;
+            PlayerInput walk{{leg == 0 ? 1 : leg == 2 ? -1 : 0, leg == 1 ? 1 : leg == 3 ? -1 : 0}, tick % 3 == 0};
+            Protocol::InputMessage::write(input, static_cast<uint32_t>(tick + 1));
+            *Protocol::InputMessage::element(input, 0) = Protocol::encodeButtons(walk);
+            serial.receive(peer, Protocol::CHANNEL_INPUT, input, Protocol::InputMessage::sizeFor(1));
+            parallel.receive(peer, Protocol::CHANNEL_INPUT, input, Protocol::InputMessage::sizeFor(1));
+        }
+
+        auto start = Clock::now();
+        serial.tick(inlineJobs, 1.0f / 60.0f);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        serialMs += ms;
+        worstSerialMs = std::max(worstSerialMs, ms);
+
+        start = Clock::now();
+        parallel.tick(pool, 1.0f / 60.0f);
+        ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        parallelMs += ms;
+        worstParallelMs = std::max(worstParallelMs, ms);
+
+        const std::vector<OutboundMessage>& a = serial.getOutbox();
+        const std::vector<OutboundMessage>& b = parallel.getOutbox();
+        bool same = a.size() == b.size();
+        for (size_t i = 0; same && i < a.size(); ++i) {
+            same = a[i].channel == b[i].channel && a[i].flags == b[i].flags && a[i].payload == b[i].payload &&
+                   a[i].recipients == b[i].recipients;
+        }
+        ok = ok && same;
+        messages += a.size();
+        serial.getOutbox().clear();
+        parallel.getOutbox().clear();
+    }
+
+    std::printf("  %zu players, %zu messages over %d ticks, identical on both\n", serial.getPlayerCount() + serial.getBotCount(),
+                messages, ticks);
+    std::printf("  inline:    %.3f ms/tick, worst %.3f ms\n", serialMs / ticks, worstSerialMs);
+    std::printf("  %zu workers: %.3f ms/tick, worst %.3f ms (target %.0f ms)\n", pool.getWorkerCount(), parallelMs / ticks,
+                worstParallelMs, targetMs);
+    if (!ok) {
+        std::printf("  MISMATCH: the outbox depends on the worker count\n");
+    }
+    return ok;
+}
+
+// The watchdog on scripted tick times, then one match with bots and spectators at every load
+// level. Shedding must never change the game: at every level the state sent on even ticks has to
+// match the unshed match byte for byte.
+bool benchWatchdog() {
+    bool ok = true;
+
+    // 1.2 ms ticks against a 1 ms budget for a while, then 0.2 ms ticks
+    TickWatchdog watchdog("  bench", std::chrono::milliseconds(1));
+    int overloadedTicks = 0;
+    while (watchdog.getLevel() != LoadLevel::SPECTATORS_HALF_RATE && overloadedTicks < 10000) {
+        watchdog.record(std::chrono::microseconds(1200));
+        overloadedTicks++;
+    }
+    int recoveryTicks = 0;
+    while (watchdog.getLevel() != LoadLevel::NORMAL && recoveryTicks < 10000) {
+        watchdog.record(std::chrono::microseconds(200));
+        recoveryTicks++;
+    }
+    ok = ok && watchdog.getStepCount() == 2 * (LOAD_LEVEL_COUNT - 1);
+    std::printf("  shed every step after %d overloaded ticks, recovered after %d quiet ticks\n", overloadedTicks, recoveryTicks);
+
+    const int ticks = 600;
+    std::vector<std::vector<uint8_t>> reference;  // Per tick: the even ticks' positions and health, unshed
+    for (int level = 0; level < LOAD_LEVEL_COUNT; ++level) {
+        Map map;
+        NavigationGrid navigation(map, Match::PLAYER_RADIUS);
+        JobSystem jobs(0);
+        Match match(0, map, navigation, 60);
+        match.setBotFill(32);
+        match.setSpectatorDelay(30);
+        match.join(0, 0);
+        for (uint16_t spectator = 1; spectator <= 4; ++spectator) {
+            match.watch(spectator);
+        }
+        match.setLoadLevel(static_cast<LoadLevel>(level));
+
+        std::vector<std::vector<uint8_t>> state(ticks);
+        size_t messages = 0;
+        size_t bytes = 0;
+        double tickUs = 0.0;
+        for (int tick = 0; tick < ticks; ++tick) {
+            auto start = Clock::now();
+            match.tick(jobs, 1.0f / 60.0f);
+            tickUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            for (const OutboundMessage& message : match.getOutbox()) {
+                messages++;
+                bytes += message.payload.size() * message.recipients.size();
+                bool kept = message.channel == Protocol::CHANNEL_HEALTH || (message.channel == Protocol::CHANNEL_POSITION && tick % 2 == 1);
+                if (kept) state[tick].insert(state[tick].end(), message.payload.begin(), message.payload.end());
+            }
+            match.getOutbox().clear();
+        }
+
+        if (level == 0) {
+            reference = state;
+        } else {
+            ok = ok && state == reference;
+        }
+        std::printf("  %-34s %7.1f us/tick, %6zu messages, %8zu bytes sent\n", describeLoadLevel(static_cast<LoadLevel>(level)),
+                    tickUs / ticks, messages, bytes);
+    }
+
+    if (!ok) {
+        std::printf("  MISMATCH: the watchdog stepped wrongly, or shedding changed the game\n");
+    }
+    return ok;
+}
+
+// One thread publishing as fast as it can through a triple buffer while another takes the newest
+// value. The consumer must only ever see whole values, each newer than the last. Then the cost of
+// publishing what the game's simulation thread publishes every tick: a copy of the registry.
+bool benchTripleBuffer() {
+    struct Frame {
+        uint64_t sequence = 0;
+        std::vector<uint64_t> words;  // All equal to sequence in a whole frame
+    };
+
+    const uint64_t publishes = 200000;
+    TripleBuffer<Frame> frames;
+    std::atomic<bool> done{false};
+    auto start = Clock::now();
+    std::thread producer([&] {
+        for (uint64_t sequence = 1; sequence <= publishes; ++sequence) {
+            Frame& frame = frames.back();
+            frame.sequence = sequence;
+            frame.words.assign(256, sequence);
+            frames.publish();
+        }
+        done = true;
+    });
+
+    bool ok = true;
+    uint64_t acquired = 0;
+    uint64_t newest = 0;
+    while (true) {
+        bool finished = done;
+        if (frames.acquire()) {
+            const Frame& frame = frames.front();
+            acquired++;
+            ok = ok && frame.sequence > newest && std::all_of(frame.words.begin(), frame.words.end(), [&](uint64_t word) {
+                     return word == frame.sequence;
+                 });
+            newest = frame.sequence;
+        } else if (finished) {
+            break;
+        }
+    }
+    producer.join();
+    double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    ok = ok && newest == publishes;
+    std::printf("  %llu publishes in %.1f ms, consumer took %llu of them (newest each time), all whole and in order\n",
+                static_cast<unsigned long long>(publishes), elapsedMs, static_cast<unsigned long long>(acquired));
+
+    // 64 players with 4096 bullets between them, copied into a slot that already held a similar tick
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> x(0, 800);
+    Registry registry(64);
+    for (int i = 0; i < 64; ++i) {
+        Player::spawn(registry, NetworkId{static_cast<uint16_t>(i)}, 5, RED, 10, PlayerShape::CIRCLE);
+    }
+    for (int i = 0; i < 4096; ++i) {
+        registry.getWeapons()[i % 64].bullets.emplace_back(Position{x(rng), x(rng)}, Vector2{1, 0},
+                                                           static_cast<uint8_t>(ProjectileType::RIFLE));
+    }
+    TripleBuffer<Registry> states;
+    double copyUs = measure(200, [&] {
+        states.back() = registry;
+        states.publish();
+    });
+    std::printf("  publishing a 64-player, 4096-bullet registry: %.1f us per tick\n", copyUs);
+
+    if (!ok) {
+        std::printf("  MISMATCH: the consumer saw a torn, repeated or stale value\n");
+    }
+    return ok;
+}
+
+// The game's steady state without a window: eight players in a row pacing back and forth and
+// shooting at each other through host ticks, each batch published into a triple buffer the way
+// Game::publishState does and frame-arena scratch dropped afterwards. The inputs repeat every
+// weaponCycle ticks, so the warmup sees the most bullets and hits there will ever be; after it no
+// tick may reach the heap. Needs a build with SHOOTER_ALLOC_COUNTING; without one there is nothing
+// to count. Only the simulation and hand-off are covered: Game::simulate's sending and receiving
+// needs a live host, so allocations on the networking path don't show up here.
+bool benchAllocations() {
+    if (!AllocCounter::isEnabled()) {
+        std::printf("  skipped: built without SHOOTER_ALLOC_COUNTING\n");
+        return true;
+    }
+
+    const int leg = 60;  // Ticks walking one way
+    const int weaponTicks = 2 * leg;
+    const int weaponCycle = weaponTicks * static_cast<int>(PROJECTILE_TYPE_COUNT);
+    const int warmupTicks = 4 * weaponCycle;
+    const int ticks = 6000;
+    const int ticksPerBatch = 2;
+    const float dt = 1.0f / 60.0f;
+
+    Map map;
+    Registry registry(8);
+    Simulation simulation(registry, map);
+    JobSystem jobs(0);
+    for (int i = 0; i < 8; ++i) {
+        Entity player = Player::spawn(registry, NetworkId{static_cast<uint16_t>(i + 1)}, 2, RED, 10, PlayerShape::CIRCLE);
+        Player(registry, player).setPosition({map.getWidth() / 2 + (i - 4) * 50 + 25, map.getHeight() / 3});
+    }
+
+    TripleBuffer<Registry> states;
+    std::vector<Hit> tickHits;
+    std::vector<Hit> publishedHits;
+    FrameArena frameArena;
+    size_t hits = 0;
+    size_t shots = 0;
+    size_t before = 0;
+    for (int tick = 0; tick < warmupTicks + ticks; ++tick) {
+        if (tick == warmupTicks) {
+            before = AllocCounter::count();
+        }
+
+        // Every player walks a leg one way and back, then switches weapon; odd players walk the other way
+        std::vector<PlayerInput>& inputs = registry.getInputs();
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            int way = ((tick / leg + static_cast<int>(i)) % 2) ? 1 : -1;
+            uint8_t select = static_cast<uint8_t>(1 + (tick / weaponTicks) % PROJECTILE_TYPE_COUNT);
+            inputs[i] = PlayerInput{{way, 0}, true, select};
+        }
+        for (Health& health : registry.getHealths()) {
+            health.current = health.max;  // Nobody dies, so the load stays the same throughout
+        }
+        simulation.tick(jobs, dt);
+        tickHits.insert(tickHits.end(), simulation.getHits().begin(), simulation.getHits().end());
+
+        // Remote bullets are decoded into frame-arena vectors between publishes
+        std::pmr::vector<Bullet> remoteBullets(frameArena.resource());
+        for (const Weapon& weapon : registry.getWeapons()) {
+            remoteBullets.assign(weapon.bullets.begin(), weapon.bullets.end());
+            shots += remoteBullets.size();
+        }
+
+        if ((tick + 1) % ticksPerBatch == 0) {
+            states.back() = registry;
+            states.publish();
+            publishedHits.clear();
+            publishedHits.insert(publishedHits.end(), tickHits.begin(), tickHits.end());
+            hits += tickHits.size();
+            tickHits.clear();
+            states.acquire();
+            frameArena.reset();
+        }
+    }
+    size_t allocations = AllocCounter::count() - before;
+
+    std::printf("  %d ticks after %d of warmup, %zu hits, %zu bullet-ticks: %zu heap allocation(s)\n", ticks, warmupTicks, hits,
+                shots, allocations);
+    if (allocations > 0) {
+        std::printf("  MISMATCH: a steady-state tick allocated\n");
+    }
+    return allocations == 0;
+}
+}  // namespace
+
+int runBenchmarks(const std::string& name) {
+    const std::vector<Benchmark> benchmarks = {
+        {"allocations", benchAllocations},
+        {"bandwidth", benchBandwidth},
+        {"bots", benchBots},
+        {"broadphase", benchBroadphase},
+        {"chunks", benchChunks},
+        {"compression", benchCompression},
+        {"culling", benchCulling},
+        {"movement", benchMovement},
+        {"packet-pool", benchPacketPool},
+        {"particles", benchParticles},
+        {"raycast", benchRaycast},
+        {"schema", benchSchema},
+        {"snapshot", benchSnapshot},
+        {"spectators", benchSpectators},
+        {"triple-buffer", benchTripleBuffer},
+        {"watchdog", benchWatchdog},
+        {"workers", benchWorkers},
+    };
+
+    bool ok = true;
+    bool found = false;
+    for (const Benchmark& benchmark : benchmarks) {
+        if (!name.empty() && name != benchmark.name) continue;
+        found = true;
+
+        std::printf("[%s]\n", benchmark.name);
+        ok = benchmark.run() && ok;
+    }
+
+    if (!found) {
+        std::printf("Unknown benchmark: %s\n", name.c_str());
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
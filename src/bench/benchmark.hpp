@@ -0,0 +1,10 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+
+// In-process micro benchmarks, run with `2d-shooter bench [name]`.
+// Without a name every benchmark runs. Returns a process exit code.
+int runBenchmarks(const std::string& name);
+
+#endif
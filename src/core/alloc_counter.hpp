@@ -0,0 +1,13 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstddef>
+
+// Debug hook that counts global operator new calls, aligned forms included.
+// Only active when built with -DSHOOTER_ALLOC_COUNTING=ON, otherwise count() is always 0.
+namespace AllocCounter {
+bool isEnabled();
+std::size_t count();
+}  // namespace AllocCounter
+
+#endif
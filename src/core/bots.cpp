@@ -0,0 +1,166 @@
+#include "core/bots.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "network/protocol.hpp"
+
+namespace {
+int sign(int value) {
+    return (value > 0) - (value < 0);
+}
+}  // namespace
+
+BotDirector::BotDirector(const Map& gameMap, const NavigationGrid& navigation) : map(gameMap), grid(navigation) {}
+
+void BotDirector::add(uint16_t owner) {
+    bots.push_back(Bot{owner, Protocol::OWNER_SELF, 0, 0, CommandQueue()});
+}
+
+void BotDirector::remove(uint16_t owner) {
+    bots.erase(std::remove_if(bots.begin(), bots.end(), [owner](const Bot& bot) { return bot.owner == owner; }), bots.end());
+}
+
+size_t BotDirector::getBotCount() const {
+    return bots.size();
+}
+
+uint16_t BotDirector::getLastOwner() const {
+    return bots.empty() ? Protocol::OWNER_SELF : bots.back().owner;
+}
+
+CommandQueue* BotDirector::commandQueueFor(uint16_t owner) {
+    for (Bot& bot : bots) {
+        if (bot.owner == owner) return &bot.commands;
+    }
+    return nullptr;
+}
+
+size_t BotDirector::getFieldCount() const {
+    return fields.size();
+}
+
+const NavigationGrid& BotDirector::getGrid() const {
+    return grid;
+}
+
+void BotDirector::think(Registry& registry) {
+    // Targets first, so every field in use this tick is known before any of them is advanced
+    for (Field& field : fields) {
+        field.used = false;
+    }
+    for (Bot& bot : bots) {
+        Entity self = registry.findByNetworkId(bot.owner);
+        if (self == NULL_ENTITY) continue;
+
+        chooseTarget(bot, registry, registry.indexOf(self));
+        Entity target = bot.target == Protocol::OWNER_SELF ? NULL_ENTITY : registry.findByNetworkId(bot.target);
+        if (target != NULL_ENTITY) {
+            FlowField& flow = fieldFor(bot.target);
+            flow.setTarget(grid.cellAt(registry.getTransform(target).position));
+        }
+    }
+    fields.erase(std::remove_if(fields.begin(), fields.end(), [](const Field& field) { return !field.used; }), fields.end());
+
+    // Searches in progress split the budget; whatever one doesn't need goes to the rest
+    size_t building = std::count_if(fields.begin(), fields.end(), [](const Field& field) { return field.flow->isBuilding(); });
+    size_t budget = CELLS_PER_TICK;
+    for (Field& field : fields) {
+        if (building == 0) break;
+        if (!field.flow->isBuilding()) continue;
+        budget -= field.flow->advance(budget / building);
+        building--;
+    }
+
+    for (Bot& bot : bots) {
+        Entity self = registry.findByNetworkId(bot.owner);
+        if (self == NULL_ENTITY) continue;
+
+        const FlowField* flow = nullptr;
+        for (const Field& field : fields) {
+            if (field.target == bot.target) flow = field.flow.get();
+        }
+        uint8_t buttons = Protocol::encodeButtons(decide(bot, registry, registry.indexOf(self), flow));
+        bot.commands.receive(++bot.tick, &buttons, 1);
+    }
+}
+
+void BotDirector::chooseTarget(Bot& bot, Registry& registry, size_t self) {
+    const std::vector<Transform>& transforms = registry.getTransforms();
+    const std::vector<Health>& healths = registry.getHealths();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+
+    bot.targetAge++;
+    Entity current = bot.target == Protocol::OWNER_SELF ? NULL_ENTITY : registry.findByNetworkId(bot.target);
+    if (current != NULL_ENTITY && healths[registry.indexOf(current)].current > 0 && bot.targetAge < RETARGET_TICKS) {
+        return;
+    }
+
+    // Nearest living player, people before bots
+    Position from = transforms[self].position;
+    size_t best = transforms.size();
+    bool bestHuman = false;
+    long bestDistance = 0;
+    for (size_t i = 0; i < transforms.size(); ++i) {
+        if (i == self || healths[i].current <= 0) continue;
+
+        long dx = transforms[i].position.x - from.x;
+        long dy = transforms[i].position.y - from.y;
+        long distance = dx * dx + dy * dy;
+        bool human = !Protocol::isBotOwner(networkIds[i].peer);
+        if (best == transforms.size() || (human && !bestHuman) || (human == bestHuman && distance < bestDistance)) {
+            best = i;
+            bestHuman = human;
+            bestDistance = distance;
+        }
+    }
+    bot.target = best < transforms.size() ? networkIds[best].peer : Protocol::OWNER_SELF;
+    bot.targetAge = 0;
+}
+
+FlowField& BotDirector::fieldFor(uint16_t target) {
+    for (Field& field : fields) {
+        if (field.target == target) {
+            field.used = true;
+            return *field.flow;
+        }
+    }
+    fields.push_back(Field{target, true, std::make_unique<FlowField>(grid)});
+    return *fields.back().flow;
+}
+
+PlayerInput BotDirector::decide(const Bot& bot, Registry& registry, size_t self, const FlowField* flow) const {
+    PlayerInput input = {{0, 0}, false};
+    Entity target = bot.target == Protocol::OWNER_SELF ? NULL_ENTITY : registry.findByNetworkId(bot.target);
+    if (registry.getHealths()[self].current <= 0 || target == NULL_ENTITY) {
+        return input;
+    }
+
+    const Transform& transform = registry.getTransforms()[self];
+    const Transform& targetTransform = registry.getTransform(target);
+    Position from = transform.position;
+    int dx = targetTransform.position.x - from.x;
+    int dy = targetTransform.position.y - from.y;
+
+    if (dx == 0 && dy == 0) {
+        return input;
+    }
+
+    // Clear shot in range: turn to the closest of the 8 directions and fire once already facing
+    // it, if the bullet's line passes through the target
+    if (dx * dx + dy * dy <= FIRE_RANGE * FIRE_RANGE && map.hasLineOfSight(from, targetTransform.position)) {
+        Position aim = {std::abs(dx) * 5 > std::abs(dy) * 2 ? sign(dx) : 0, std::abs(dy) * 5 > std::abs(dx) * 2 ? sign(dy) : 0};
+        float miss = std::abs(static_cast<float>(dx * aim.y - dy * aim.x)) / std::sqrt(static_cast<float>(aim.x * aim.x + aim.y * aim.y));
+        input.direction = aim;
+        input.fire = transform.facing.x == aim.x && transform.facing.y == aim.y && miss <= targetTransform.radius;
+        return input;
+    }
+
+    // Otherwise follow the field, or head straight for the target until it has one
+    input.direction = flow ? flow->directionAt(from) : Position{0, 0};
+    if (input.direction.x == 0 && input.direction.y == 0 && (!flow || !flow->isReady())) {
+        input.direction = {sign(dx), sign(dy)};
+    }
+    return input;
+}
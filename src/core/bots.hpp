@@ -0,0 +1,69 @@
+#ifndef BOTS_HPP
+#define BOTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/map.hpp"
+#include "core/navigation.hpp"
+#include "core/registry.hpp"
+#include "network/input_commands.hpp"
+
+// Server-side players. Every tick each bot picks a target, follows the target's flow field
+// around obstacles and shoots once it has a clear line. What it decides goes out as button
+// bytes into its own CommandQueue, so the match applies it exactly like a remote player's input.
+//
+// Flow fields are per target, not per bot: any number of bots chasing the same player share
+// one field, and all fields together expand at most CELLS_PER_TICK cells a tick.
+class BotDirector {
+   public:
+    static constexpr size_t CELLS_PER_TICK = 4096;
+    static constexpr uint32_t RETARGET_TICKS = 30;  // How long a bot sticks with a living target
+    static constexpr int FIRE_RANGE = 300;
+
+    // grid is map's, for the bots' radius; it has to outlive the director
+    BotDirector(const Map& map, const NavigationGrid& grid);
+
+    BotDirector(const BotDirector&) = delete;
+    BotDirector& operator=(const BotDirector&) = delete;
+
+    void add(uint16_t owner);
+    void remove(uint16_t owner);
+    size_t getBotCount() const;
+    uint16_t getLastOwner() const;  // Most recently added bot, for removing bots newest first
+    CommandQueue* commandQueueFor(uint16_t owner);  // nullptr if owner is not a bot
+
+    // Queues one command per bot from the registry's current state
+    void think(Registry& registry);
+
+    size_t getFieldCount() const;
+    const NavigationGrid& getGrid() const;
+
+   private:
+    struct Bot {
+        uint16_t owner;
+        uint16_t target;  // Owner slot of the player being chased, OWNER_SELF for none
+        uint32_t targetAge;
+        uint32_t tick;
+        CommandQueue commands;
+    };
+
+    struct Field {
+        uint16_t target;
+        bool used;
+        std::unique_ptr<FlowField> flow;
+    };
+
+    void chooseTarget(Bot& bot, Registry& registry, size_t self);
+    FlowField& fieldFor(uint16_t target);
+    PlayerInput decide(const Bot& bot, Registry& registry, size_t self, const FlowField* field) const;
+
+    const Map& map;
+    const NavigationGrid& grid;
+    std::vector<Bot> bots;
+    std::vector<Field> fields;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "core/broadphase.hpp"
+
+#include <algorithm>
+
+Broadphase::Broadphase(int size) : cellSize(size > 0 ? size : DEFAULT_CELL_SIZE), bucketMask(0) {}
+
+int Broadphase::cellOf(int coordinate) const {
+    // Floor division so negative coordinates get their own cells
+    return coordinate >= 0 ? coordinate / cellSize : (coordinate - cellSize + 1) / cellSize;
+}
+
+uint32_t Broadphase::bucketOf(int cellX, int cellY) const {
+    uint32_t hash = static_cast<uint32_t>(cellX) * 73856093u ^ static_cast<uint32_t>(cellY) * 19349663u;
+    return hash & bucketMask;
+}
+
+void Broadphase::build(const std::vector<Transform>& transforms, const std::vector<Health>& healths, int bulletRadius) {
+    // Roughly four buckets per player keeps collisions between distant cells rare
+    uint32_t bucketCount = 16;
+    while (bucketCount < transforms.size() * 4) {
+        bucketCount <<= 1;
+    }
+    bucketMask = bucketCount - 1;
+
+    insertions.clear();
+    for (uint32_t player = 0; player < transforms.size(); ++player) {
+        if (healths[player].current <= 0) continue;
+
+        const Transform& transform = transforms[player];
+        int reach = transform.radius + bulletRadius;
+        int minX = cellOf(transform.position.x - reach);
+        int maxX = cellOf(transform.position.x + reach);
+        int minY = cellOf(transform.position.y - reach);
+        int maxY = cellOf(transform.position.y + reach);
+
+        size_t firstInsertion = insertions.size();
+        for (int cy = minY; cy <= maxY; ++cy) {
+            for (int cx = minX; cx <= maxX; ++cx) {
+                uint32_t bucket = bucketOf(cx, cy);
+
+                // Two of this player's cells can hash to the same bucket; insert once
+                bool seen = false;
+                for (size_t i = firstInsertion; i < insertions.size(); ++i) {
+                    if (insertions[i].bucket == bucket) {
+                        seen = true;
+                        break;
+                    }
+                }
+                if (!seen) insertions.push_back({bucket, player});
+            }
+        }
+    }
+
+    // Counting sort by bucket; players stay in dense order inside each bucket
+    bucketStart.assign(bucketCount + 1, 0);
+    for (const Insertion& insertion : insertions) {
+        bucketStart[insertion.bucket + 1]++;
+    }
+    for (uint32_t b = 0; b < bucketCount; ++b) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    entries.resize(insertions.size());
+    for (const Insertion& insertion : insertions) {
+        // Borrow bucketStart as the write cursor, then shift it back below
+        entries[bucketStart[insertion.bucket]++] = insertion.player;
+    }
+    for (uint32_t b = bucketCount; b > 0; --b) {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+void Broadphase::collectPairs(const std::vector<Weapon>& weapons, std::vector<CandidatePair>& pairs) const {
+    pairs.clear();
+    for (uint32_t shooter = 0; shooter < weapons.size(); ++shooter) {
+        const std::vector<Bullet>& bullets = weapons[shooter].bullets;
+        for (uint32_t bullet = 0; bullet < bullets.size(); ++bullet) {
+            forEachCandidate(bullets[bullet].getPosition(), [&](uint32_t victim) {
+                if (victim != shooter) pairs.push_back({shooter, bullet, victim});
+            });
+        }
+    }
+}
+
+size_t Broadphase::getBucketCount() const {
+    return bucketStart.empty() ? 0 : bucketStart.size() - 1;
+}
@@ -0,0 +1,68 @@
+#ifndef BROADPHASE_HPP
+#define BROADPHASE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "entities/components.hpp"
+#include "entities/position.hpp"
+
+// Bullet that may be touching a player; confirm with an exact narrow-phase test
+struct CandidatePair {
+    uint32_t shooter;  // Dense index of the bullet's owner
+    uint32_t bullet;   // Index into the owner's bullet list
+    uint32_t victim;   // Dense index of the player
+};
+
+// Hashed uniform grid over player circles, rebuilt every tick.
+// Each player is inserted into every cell its circle (grown by the bullet radius) overlaps,
+// so a bullet only has to look at the single cell containing its centre.
+// Storage is two flat arrays built with a counting sort and reused between ticks.
+class Broadphase {
+   public:
+    static constexpr int DEFAULT_CELL_SIZE = 32;
+
+    explicit Broadphase(int cellSize = DEFAULT_CELL_SIZE);
+
+    // Dead players are left out. bulletRadius is added to every player's radius.
+    void build(const std::vector<Transform>& transforms, const std::vector<Health>& healths, int bulletRadius);
+
+    // Calls fn(denseIndex) for every player that may overlap a bullet at point, each at most once
+    template <typename Fn>
+    void forEachCandidate(Position point, Fn&& fn) const;
+
+    // Every (bullet, player) candidate for all shooters, skipping self hits, in deterministic order
+    void collectPairs(const std::vector<Weapon>& weapons, std::vector<CandidatePair>& pairs) const;
+
+    size_t getBucketCount() const;
+
+   private:
+    uint32_t bucketOf(int cellX, int cellY) const;
+    int cellOf(int coordinate) const;
+
+    int cellSize;
+    uint32_t bucketMask;
+
+    std::vector<uint32_t> bucketStart;  // bucketStart[b]..bucketStart[b + 1] indexes into entries
+    std::vector<uint32_t> entries;      // Player dense indices grouped by bucket
+
+    // Scratch for build()
+    struct Insertion {
+        uint32_t bucket;
+        uint32_t player;
+    };
+    std::vector<Insertion> insertions;
+};
+
+template <typename Fn>
+void Broadphase::forEachCandidate(Position point, Fn&& fn) const {
+    if (entries.empty()) {
+        return;
+    }
+    uint32_t bucket = bucketOf(cellOf(point.x), cellOf(point.y));
+    for (uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; ++i) {
+        fn(entries[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include "core/camera.hpp"
+
+#include <algorithm>
+
+namespace {
+// Camera center along one axis: on the target, but never closer to the world's edges than half the view
+float clampAxis(float target, float halfView, float worldSize) {
+    if (worldSize <= halfView * 2.0f) return worldSize / 2.0f;
+    return std::max(halfView, std::min(target, worldSize - halfView));
+}
+}  // namespace
+
+FollowCamera::FollowCamera(int width, int height) : viewWidth(width), viewHeight(height) {
+    // The target is drawn at the middle of the screen
+    camera.offset = {width / 2.0f, height / 2.0f};
+    camera.target = camera.offset;
+    camera.rotation = 0.0f;
+    camera.zoom = 1.0f;
+}
+
+void FollowCamera::follow(Position target, int worldWidth, int worldHeight) {
+    camera.zoom = 1.0f;
+    camera.target.x = clampAxis(static_cast<float>(target.x), viewWidth / 2.0f, static_cast<float>(worldWidth));
+    camera.target.y = clampAxis(static_cast<float>(target.y), viewHeight / 2.0f, static_cast<float>(worldHeight));
+}
+
+void FollowCamera::fit(int worldWidth, int worldHeight) {
+    float zoomX = static_cast<float>(viewWidth) / static_cast<float>(worldWidth);
+    float zoomY = static_cast<float>(viewHeight) / static_cast<float>(worldHeight);
+    camera.zoom = std::min(1.0f, std::min(zoomX, zoomY));
+    camera.target = {worldWidth / 2.0f, worldHeight / 2.0f};
+}
+
+const Camera2D& FollowCamera::get() const {
+    return camera;
+}
+
+WorldRect FollowCamera::getView() const {
+    float halfWidth = viewWidth / (2.0f * camera.zoom);
+    float halfHeight = viewHeight / (2.0f * camera.zoom);
+    return {camera.target.x - halfWidth, camera.target.y - halfHeight, camera.target.x + halfWidth, camera.target.y + halfHeight};
+}
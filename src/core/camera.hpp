@@ -0,0 +1,36 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <raylib.h>
+
+#include "entities/position.hpp"
+
+// Axis-aligned box in world pixels
+struct WorldRect {
+    float minX, minY, maxX, maxY;
+
+    // True when a circle at (x, y) reaches into the box
+    bool overlaps(float x, float y, float radius) const {
+        return x + radius >= minX && x - radius <= maxX && y + radius >= minY && y - radius <= maxY;
+    }
+};
+
+// Screen-sized window onto a world that may be larger than the screen. Following a point keeps
+// the view inside the world, so the edge of the arena never shows empty space; along an axis
+// where the world is smaller than the view it is centered instead.
+class FollowCamera {
+   public:
+    FollowCamera(int viewWidth, int viewHeight);
+
+    void follow(Position target, int worldWidth, int worldHeight);
+    void fit(int worldWidth, int worldHeight);  // Zooms out until the whole world is on screen
+
+    const Camera2D& get() const;  // For BeginMode2D
+    WorldRect getView() const;    // World area on screen, for culling
+
+   private:
+    int viewWidth, viewHeight;
+    Camera2D camera;
+};
+
+#endif
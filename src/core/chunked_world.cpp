@@ -0,0 +1,322 @@
+#include "core/chunked_world.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <utility>
+
+namespace {
+constexpr int MIN_OBSTACLES = 6;
+constexpr int MAX_OBSTACLES = 14;
+constexpr int CHUNK_MARGIN = 40;  // Obstacles stay this far inside their chunk, so every chunk border is passable
+
+const Color PALETTE[] = {GRAY, DARKGRAY, BROWN, DARKGREEN, DARKBLUE};
+
+// splitmix64. The standard distributions are free to differ between library implementations,
+// so every draw is done here to give the same world on every platform.
+class ChunkRandom {
+   public:
+    explicit ChunkRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t value = state;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // low..high inclusive
+    int between(int low, int high) {
+        if (high <= low) return low;
+        return low + static_cast<int>(next() % static_cast<uint64_t>(high - low + 1));
+    }
+
+   private:
+    uint64_t state;
+};
+
+ChunkedWorldConfig clamped(ChunkedWorldConfig config) {
+    config.chunkSize = std::max(ChunkedWorld::MIN_CHUNK_SIZE, config.chunkSize);
+    // The world's size in pixels has to fit an int with room to spare
+    config.chunksAcross = std::max(1, std::min(config.chunksAcross, INT_MAX / 4 / config.chunkSize));
+    config.loadRadius = std::max(0, config.loadRadius);
+    return config;
+}
+
+std::unique_ptr<Obstacle> makeObstacle(const ObstacleSpec& spec) {
+    if (spec.type == ObstacleType::CIRCLE) {
+        return std::make_unique<CircleObstacle>(spec.center, spec.radius, spec.color);
+    }
+    return std::make_unique<RectangleObstacle>(spec.center, spec.width, spec.height, spec.color);
+}
+}  // namespace
+
+ChunkedWorld::ChunkedWorld(const ChunkedWorldConfig& worldConfig)
+    : config(clamped(worldConfig)),
+      map(config.chunkSize * config.chunksAcross, config.chunkSize * config.chunksAcross),
+      generatedCount(0),
+      evictedCount(0),
+      rebuildCount(0),
+      oldestNear(0),
+      overCap(false),
+      layoutPosted(false),
+      built(map.getWidth(), map.getHeight()),
+      mapReady(false),
+      stopping(false) {
+    map.clearObstacles();  // Nothing is resident until players arrive
+    built.clearObstacles();
+    generator = std::thread(&ChunkedWorld::generatorLoop, this);
+}
+
+ChunkedWorld::~ChunkedWorld() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    generator.join();
+}
+
+uint64_t ChunkedWorld::keyOf(int chunkX, int chunkY) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+}
+
+void ChunkedWorld::generate(uint64_t seed, int chunkSize, int chunkX, int chunkY, std::vector<ObstacleSpec>& obstacles) {
+    obstacles.clear();
+    ChunkRandom random(seed ^ (keyOf(chunkX, chunkY) * 0xD1B54A32D192ED03ull));
+
+    int originX = chunkX * chunkSize;
+    int originY = chunkY * chunkSize;
+    int count = random.between(MIN_OBSTACLES, MAX_OBSTACLES);
+    for (int i = 0; i < count; ++i) {
+        ObstacleSpec spec;
+        spec.color = PALETTE[random.between(0, static_cast<int>(sizeof(PALETTE) / sizeof(PALETTE[0])) - 1)];
+        int halfWidth, halfHeight;
+        if (random.between(0, 2) == 0) {
+            spec.type = ObstacleType::CIRCLE;
+            spec.radius = random.between(12, 45);
+            spec.width = spec.height = 0;
+            halfWidth = halfHeight = spec.radius;
+        } else {
+            spec.type = ObstacleType::RECTANGLE;
+            spec.radius = 0;
+            spec.width = random.between(20, 140);
+            spec.height = random.between(20, 140);
+            halfWidth = spec.width / 2;
+            halfHeight = spec.height / 2;
+        }
+        spec.center.x = originX + random.between(CHUNK_MARGIN + halfWidth, chunkSize - CHUNK_MARGIN - halfWidth);
+        spec.center.y = originY + random.between(CHUNK_MARGIN + halfHeight, chunkSize - CHUNK_MARGIN - halfHeight);
+        obstacles.push_back(spec);
+    }
+}
+
+void ChunkedWorld::generatorLoop() {
+    std::vector<Chunk> work;
+    std::vector<ObstacleSpec> specs;
+    bool rebuild = false;
+    Map building(map.getWidth(), map.getHeight());
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !requests.empty() || layoutPosted; });
+            if (stopping) return;
+            work.swap(requests);
+            // Only the newest layout matters; one superseded before it was built is never built
+            if (layoutPosted) {
+                specs.swap(nextLayout);
+                layoutPosted = false;
+                rebuild = true;
+            }
+        }
+
+        if (!work.empty()) {
+            for (Chunk& chunk : work) {
+                generate(config.seed, config.chunkSize, chunk.x, chunk.y, chunk.obstacles);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (Chunk& chunk : work) {
+                finished.push_back(std::move(chunk));
+            }
+        }
+        work.clear();
+
+        if (rebuild) {
+            // Whatever building holds is a map the tick has let go of, so it is freed here too
+            buildMap(specs, building);
+            std::lock_guard<std::mutex> lock(mutex);
+            built.swapObstacles(building);
+            mapReady = true;
+            rebuild = false;
+        }
+    }
+}
+
+void ChunkedWorld::buildMap(std::vector<ObstacleSpec>& obstacles, Map& target) {
+    std::vector<std::unique_ptr<Obstacle>> batch;
+    batch.reserve(obstacles.size());
+    for (const ObstacleSpec& spec : obstacles) {
+        batch.push_back(makeObstacle(spec));
+    }
+    target.clearObstacles();
+    target.addObstacles(std::move(batch));
+    obstacles.clear();
+}
+
+void ChunkedWorld::update(const std::vector<Position>& players, uint32_t tick) {
+    // Touch every chunk near a player, and ask for the ones that aren't here yet
+    const int last = config.chunksAcross - 1;
+    for (Position player : players) {
+        int centerX = std::max(0, std::min(player.x / config.chunkSize, last));
+        int centerY = std::max(0, std::min(player.y / config.chunkSize, last));
+        for (int y = std::max(0, centerY - config.loadRadius); y <= std::min(last, centerY + config.loadRadius); ++y) {
+            for (int x = std::max(0, centerX - config.loadRadius); x <= std::min(last, centerX + config.loadRadius); ++x) {
+                uint64_t key = keyOf(x, y);
+                auto found = resident.find(key);
+                if (found != resident.end()) {
+                    found->second.lastNear = tick;
+                } else if (pending.insert(key).second) {
+                    outgoing.push_back(Chunk{x, y, tick, {}});
+                }
+            }
+        }
+    }
+    if (!outgoing.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (Chunk& chunk : outgoing) {
+                requests.push_back(std::move(chunk));
+            }
+        }
+        wake.notify_one();
+        outgoing.clear();
+    }
+
+    bool adopted = adoptFinished();
+    bool dropped = false;
+    // Residency only grows through adoption and lastNear only moves forward, so with nothing adopted
+    // there is nothing to drop until the oldest chunk can time out
+    if (adopted || overCap || tick - oldestNear > config.evictAfterTicks) {
+        dropped = evictStale(tick);
+    }
+    if (adopted || dropped) {
+        postLayout();
+    }
+    adoptMap();
+}
+
+bool ChunkedWorld::adoptFinished() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        arrived.swap(finished);
+    }
+    if (arrived.empty()) {
+        return false;
+    }
+
+    for (Chunk& chunk : arrived) {
+        uint64_t key = keyOf(chunk.x, chunk.y);
+        pending.erase(key);
+        // lastNear is still the tick it was asked for: one that arrives after everyone left goes again soon
+        resident.emplace(key, std::move(chunk));
+        generatedCount++;
+    }
+    arrived.clear();
+    return true;
+}
+
+bool ChunkedWorld::evictStale(uint32_t tick) {
+    byAge.clear();
+    for (const auto& entry : resident) {
+        byAge.push_back({entry.second.lastNear, entry.first});
+    }
+    // Least recently near first: everything past the timeout, then whatever is over the cap.
+    // Chunks near a player this tick are never dropped, so the cap cannot make them thrash.
+    std::sort(byAge.begin(), byAge.end());
+    size_t drop = 0;
+    while (drop < byAge.size() && byAge[drop].first != tick &&
+           (tick - byAge[drop].first > config.evictAfterTicks || resident.size() - drop > config.maxResident)) {
+        drop++;
+    }
+
+    for (size_t i = 0; i < drop; ++i) {
+        resident.erase(byAge[i].second);
+    }
+    evictedCount += drop;
+    oldestNear = drop < byAge.size() ? byAge[drop].first : tick;
+    overCap = resident.size() > config.maxResident;
+    return drop > 0;
+}
+
+void ChunkedWorld::postLayout() {
+    // Chunks go in coordinate order, so obstacle indices don't depend on the order chunks arrived in
+    keys.clear();
+    size_t total = 0;
+    for (const auto& entry : resident) {
+        keys.push_back(entry.first);
+        total += entry.second.obstacles.size();
+    }
+    std::sort(keys.begin(), keys.end());
+
+    layout.clear();
+    layout.reserve(total);
+    for (uint64_t key : keys) {
+        const std::vector<ObstacleSpec>& obstacles = resident.at(key).obstacles;
+        layout.insert(layout.end(), obstacles.begin(), obstacles.end());
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        nextLayout.swap(layout);
+        layoutPosted = true;
+    }
+    wake.notify_one();
+}
+
+void ChunkedWorld::adoptMap() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!mapReady) {
+        return;
+    }
+    // The old obstacles go back with built and are freed on the generator thread
+    map.swapObstacles(built);
+    mapReady = false;
+    rebuildCount++;
+}
+
+const Map& ChunkedWorld::getMap() const {
+    return map;
+}
+
+bool ChunkedWorld::isResident(int chunkX, int chunkY) const {
+    return resident.count(keyOf(chunkX, chunkY)) > 0;
+}
+
+const std::vector<ObstacleSpec>* ChunkedWorld::getChunk(int chunkX, int chunkY) const {
+    auto found = resident.find(keyOf(chunkX, chunkY));
+    return found == resident.end() ? nullptr : &found->second.obstacles;
+}
+
+size_t ChunkedWorld::getResidentCount() const {
+    return resident.size();
+}
+
+size_t ChunkedWorld::getPendingCount() const {
+    return pending.size();
+}
+
+size_t ChunkedWorld::getObstacleCount() const {
+    return map.getObstacles().size();
+}
+
+unsigned long ChunkedWorld::getGeneratedCount() const {
+    return generatedCount;
+}
+
+unsigned long ChunkedWorld::getEvictedCount() const {
+    return evictedCount;
+}
+
+unsigned long ChunkedWorld::getRebuildCount() const {
+    return rebuildCount;
+}
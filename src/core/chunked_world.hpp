@@ -0,0 +1,123 @@
+#ifndef CHUNKED_WORLD_HPP
+#define CHUNKED_WORLD_HPP
+
+#include <raylib.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "core/map.hpp"
+#include "entities/obstacle.hpp"
+#include "entities/position.hpp"
+
+// One generated obstacle as plain data, cheap to keep while its chunk is resident
+struct ObstacleSpec {
+    ObstacleType type;
+    Position center;
+    int width, height;  // Rectangles
+    int radius;         // Circles
+    Color color;
+};
+
+struct ChunkedWorldConfig {
+    uint64_t seed = 1;
+    int chunkSize = 1024;            // Pixels along each side of a chunk
+    int chunksAcross = 4096;         // The world is this many chunks wide and high
+    int loadRadius = 1;              // Chunks around a player's own that are kept loaded
+    uint32_t evictAfterTicks = 600;  // Resident chunks no player has been near for this long are dropped
+    size_t maxResident = 256;        // Beyond this the chunks unvisited longest go first, never ones near a player
+};
+
+// World far larger than could be held as one obstacle list, split into square chunks that exist
+// only around players. A chunk's obstacles follow from the seed and its coordinates alone, so it
+// comes back the same after eviction and every machine with the seed generates the same world.
+//
+// update() runs on the tick thread. It asks for missing chunks near players and adopts whatever
+// the generator thread has finished; it never waits for generation. The resident chunks are kept
+// in one Map, so movement, bullets and the BVH queries work on a chunked world unchanged. When the
+// set changes the tick hands its obstacles to the generator thread, which builds the next Map and
+// BVH there; a later update() swaps it in. Memory follows the resident chunks, never the world.
+class ChunkedWorld {
+   public:
+    static constexpr int MIN_CHUNK_SIZE = 256;
+
+    explicit ChunkedWorld(const ChunkedWorldConfig& config);
+    ~ChunkedWorld();
+
+    ChunkedWorld(const ChunkedWorld&) = delete;
+    ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+
+    // Once per tick with every player's position
+    void update(const std::vector<Position>& players, uint32_t tick);
+
+    // Holds the resident chunks' obstacles as of the last build swapped in; changes only inside update()
+    const Map& getMap() const;
+
+    // Deterministic contents of one chunk, on any thread
+    static void generate(uint64_t seed, int chunkSize, int chunkX, int chunkY, std::vector<ObstacleSpec>& obstacles);
+
+    bool isResident(int chunkX, int chunkY) const;
+    const std::vector<ObstacleSpec>* getChunk(int chunkX, int chunkY) const;  // nullptr unless resident
+    size_t getResidentCount() const;
+    size_t getPendingCount() const;
+    size_t getObstacleCount() const;  // Obstacles currently in the map
+    unsigned long getGeneratedCount() const;
+    unsigned long getEvictedCount() const;
+    unsigned long getRebuildCount() const;  // Maps built and swapped in
+
+   private:
+    struct Chunk {
+        int x, y;
+        uint32_t lastNear;  // Last tick a player was within loadRadius, or when it was requested
+        std::vector<ObstacleSpec> obstacles;
+    };
+
+    static uint64_t keyOf(int chunkX, int chunkY);
+
+    void generatorLoop();
+    void buildMap(std::vector<ObstacleSpec>& obstacles, Map& target);
+    bool adoptFinished();
+    bool evictStale(uint32_t tick);
+    void postLayout();
+    void adoptMap();
+
+    ChunkedWorldConfig config;
+    Map map;
+
+    // Tick thread only
+    std::unordered_map<uint64_t, Chunk> resident;
+    std::unordered_set<uint64_t> pending;  // Requested and not adopted yet
+    unsigned long generatedCount;
+    unsigned long evictedCount;
+    unsigned long rebuildCount;
+    uint32_t oldestNear;  // No resident chunk was last near before this, so nothing can time out sooner
+    bool overCap;         // The last eviction left more than maxResident, all of them near a player
+
+    // Scratch for update()
+    std::vector<Chunk> outgoing;
+    std::vector<Chunk> arrived;
+    std::vector<std::pair<uint32_t, uint64_t>> byAge;  // (lastNear, key)
+    std::vector<uint64_t> keys;
+    std::vector<ObstacleSpec> layout;
+
+    // Exchanged with the generator thread under the mutex by swapping whole vectors
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Chunk> requests;
+    std::vector<Chunk> finished;
+    std::vector<ObstacleSpec> nextLayout;  // Resident obstacles in coordinate order, waiting to be built
+    bool layoutPosted;
+    Map built;  // Finished on the generator thread, swapped into map by the tick
+    bool mapReady;
+    bool stopping;
+    std::thread generator;
+};
+
+#endif
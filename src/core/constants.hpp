@@ -1,4 +1,8 @@
 namespace Constants {
 const int SCREEN_WIDTH = 800;
 const int SCREEN_HEIGHT = 600;
+// Size of the default map; the camera shows a screen-sized part of it
+const int WORLD_WIDTH = 1600;
+const int WORLD_HEIGHT = 1200;
+const int TICK_RATE = 60;  // Simulation ticks per second
 }  // namespace Constants
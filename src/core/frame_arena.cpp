@@ -0,0 +1,17 @@
+#include "core/frame_arena.hpp"
+
+FrameArena::FrameArena(std::size_t cap)
+    : capacity(cap), buffer(new std::byte[cap]), monotonic(buffer.get(), cap, std::pmr::new_delete_resource()) {}
+
+std::pmr::memory_resource* FrameArena::resource() {
+    return &monotonic;
+}
+
+void FrameArena::reset() {
+    // Rewinds to the start of the initial buffer without touching the heap
+    monotonic.release();
+}
+
+std::size_t FrameArena::getCapacity() const {
+    return capacity;
+}
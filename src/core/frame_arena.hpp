@@ -0,0 +1,33 @@
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Monotonic scratch memory for data that only lives for one frame.
+// Everything allocated from resource() is released in one go by reset().
+class FrameArena {
+   public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit FrameArena(std::size_t capacity = DEFAULT_CAPACITY);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    std::pmr::memory_resource* resource();
+
+    // Call once at the end of every frame
+    void reset();
+
+    std::size_t getCapacity() const;
+
+   private:
+    std::size_t capacity;
+    std::unique_ptr<std::byte[]> buffer;
+    // Falls back to the heap if a frame ever outgrows the buffer
+    std::pmr::monotonic_buffer_resource monotonic;
+};
+
+#endif
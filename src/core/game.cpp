@@ -2,370 +2,490 @@
 
 #include <raylib.h>
 
-#include <cmath>
+#include <chrono>
+#include <iostream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
+#include "core/alloc_counter.hpp"
 #include "core/constants.hpp"
 #include "network/network_manager.hpp"
-
-Game::Game(bool hostFlag) : isRunning(false), isHost(hostFlag), remotePlayerConnected(false) {
+#include "network/protocol.hpp"
+#include "network/snapshot.hpp"
+
+Game::Game(bool hostFlag, const NetworkConfig& networkConfig)
+    : isRunning(false),
+      isHost(hostFlag),
+      tickSeconds(1.0f / Constants::TICK_RATE),
+      camera(Constants::SCREEN_WIDTH, Constants::SCREEN_HEIGHT) {
     InitWindow(Constants::SCREEN_WIDTH, Constants::SCREEN_HEIGHT, windowTitle.c_str());
     SetTargetFPS(60);
 
     // Initialize the game map
     gameMap = new Map();
+    simulation = new Simulation(registry, *gameMap);
+    simulation->setResolveDamage(isHost);  // Clients only predict; health comes from the host
 
-    network = new NetworkManager(isHost);
+    network = new NetworkManager(isHost, networkConfig);
     if (!network->init()) {
+        delete network;
+        delete simulation;
         delete gameMap;
         CloseWindow();
         throw std::runtime_error("Failed to initialize network");
     }
 
-    // Only create local player initially
+    // Only create local player initially, remote players are spawned as peers join
+    NetworkId localId{NetworkId::LOCAL};
     if (isHost) {
-        players.emplace_back(5, BLUE, 10, PlayerShape::CIRCLE);  // Host player
+        localPlayer = Player::spawn(registry, localId, 5, BLUE, 10, PlayerShape::CIRCLE);  // Host player
     } else {
-        players.emplace_back(5, RED, 10, PlayerShape::CIRCLE);  // Client player
+        localPlayer = Player::spawn(registry, localId, 5, RED, 10, PlayerShape::CIRCLE);  // Client player
     }
 
     // Set initial spawn position based on role
-    int margin = 50;  // Safe distance from walls and obstacles
-    if (isHost) {
-        players[0].setPosition({margin, margin});  // Host spawns top-left
-    } else {
-        players[0].setPosition({Constants::SCREEN_WIDTH - margin, Constants::SCREEN_HEIGHT - margin});  // Client spawns bottom-right
-    }
+    Player(registry, localPlayer).setPosition(spawnPointFor(localId));
 }
 
 Game::~Game() {
+    stop();
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
     delete network;
+    delete simulation;
     delete gameMap;
-    players.clear();
+    registry.clear();
     CloseWindow();
 }
 
 void Game::start() {
     isRunning = true;
 
+    // Something to draw before the first tick
+    publishState();
+    simulationThread = std::thread(&Game::simulate, this);
+
     while (isRunning) {
-        BeginDrawing();
-        ClearBackground(RAYWHITE);
-
-        int localIndex = 0;   // Local player is always index 0
-        int remoteIndex = 1;  // Remote player is always index 1 (if connected)
-
-        // === PLAYER MOVEMENT ===
-        players[localIndex].move(gameMap);
-        Position localPos = players[localIndex].getPosition();
-        network->sendPosition(localPos.x, localPos.y);
-
-        float rx, ry;
-        if (network->receivePosition(rx, ry)) {
-            // Create remote player if not already created
-            if (!remotePlayerConnected && network->isConnected()) {
-                createRemotePlayer();
-            }
+        std::size_t allocationsAtFrameStart = AllocCounter::count();
 
-            if (remotePlayerConnected && players.size() > 1) {
-                players[remoteIndex].setPosition({static_cast<int>(rx), static_cast<int>(ry)});
-            }
+        // The newest complete tick; when none has finished since the last frame this one is drawn again
+        states.acquire();
+        render(states.front());
+
+        // Allocations are counted across threads, so this also catches the ticks run during the frame
+        checkFrameAllocations(allocationsAtFrameStart);
+        frameCount++;
+
+        if (WindowShouldClose()) {
+            stop();
         }
+    }
 
-        // === BULLET SYNCING ===
-        // Send local bullets
-        network->sendBullets(players[localIndex].getBullets());
+    simulationThread.join();
+}
 
-        // Receive remote bullets
-        std::vector<Bullet> remoteBullets;
-        if (network->receiveBullets(remoteBullets)) {
-            // Create remote player if not already created
-            if (!remotePlayerConnected && network->isConnected()) {
-                createRemotePlayer();
-            }
+void Game::stop() {
+    isRunning = false;
+}
+
+void Game::render(RenderState& state) {
+    Registry& world = state.registry;
+    Player local(world, state.localPlayer);
+
+    // === INPUT ===
+    // Sampled once per frame and handed to the simulation, which uses the newest sample for its ticks
+    bool remotePlayerConnected = world.size() > 1;
+    Entity enemy = NULL_ENTITY;
+    bool remotesAlive = false;
+    for (Entity entity : world.getEntities()) {
+        if (entity == state.localPlayer) continue;
+        if (enemy == NULL_ENTITY) enemy = entity;
+        if (Player(world, entity).isAlive()) {
+            remotesAlive = true;
+            break;
+        }
+    }
+    bool died = !local.isAlive();
+    bool won = remotePlayerConnected && !remotesAlive;
+    {
+        std::lock_guard<std::mutex> lock(exchangeMutex);
+        sampledInputs.push_back({local.sampleInput(), (died || won) && IsKeyPressed(KEY_R)});
+        drawnHits.swap(publishedHits);
+    }
+
+    BeginDrawing();
+    ClearBackground(RAYWHITE);
 
-            if (remotePlayerConnected && players.size() > 1) {
-                players[remoteIndex].setBullets(remoteBullets);
+    // === EFFECTS ===
+    // Shots and deaths show up as state changes, whether simulated here or received
+    effects.onHits(world, drawnHits);
+    drawnHits.clear();
+    effects.observe(world);
+    effects.update(GetFrameTime());
+
+    // === CAMERA ===
+    // The world is drawn through the camera; only what falls inside its view is drawn at all
+    camera.follow(local.getPosition(), gameMap->getWidth(), gameMap->getHeight());
+    WorldRect view = camera.getView();
+    BeginMode2D(camera.get());
+
+    // === DRAW MAP ===
+    gameMap->draw(view);
+
+    // === DRAW PLAYERS AND BULLETS ===
+    for (Entity entity : world.getEntities()) {
+        Player(world, entity).draw(view);
+    }
+    effects.draw();
+    EndMode2D();
+
+    // === HUD ===
+    // Widgets only rebuild when one of these values differs from last frame
+    const char* waitingText = nullptr;
+    if (!remotePlayerConnected) {
+        if (isHost) {
+            waitingText = "Waiting for client to connect...";
+        } else {
+            waitingText = state.connected ? "Connected! Waiting for game data..." : "Connecting to host...";
+        }
+    }
+    hud.setStatus(waitingText);
+
+    // The enemy bar follows the first remote player that joined and is still connected
+    hud.setLocalHealth(local.getHealth());
+    hud.setEnemyHealth(enemy != NULL_ENTITY, enemy != NULL_ENTITY ? Player(world, enemy).getHealth() : 0);
+
+    // === CHECK GAME OVER ===
+    if (died) {
+        hud.setBanner("YOU DIED! Press R to restart or ESC to quit", RED);
+    } else if (won) {
+        hud.setBanner("YOU WIN! Press R to restart or ESC to quit", GREEN);
+    } else {
+        hud.setBanner(nullptr, BLANK);
+    }
+
+    hud.draw();
+
+    EndDrawing();
+}
+
+void Game::simulate() {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point nextTick = Clock::now();
+
+    while (isRunning) {
+        // === CONNECTIONS ===
+        network->service();
+        PeerEvent peerEvent;
+        while (network->pollPeerEvent(peerEvent)) {
+            if (peerEvent.type == PeerEvent::Type::JOINED) {
+                spawnRemotePlayer(peerEvent.owner);
+                if (isHost) {
+                    commandQueueFor(peerEvent.owner).clear();
+                    // Health is only sent when it changes, so the newcomer needs everyone's once
+                    for (Health& health : registry.getHealths()) health.changed = true;
+                }
+            } else {
+                despawnRemotePlayer(peerEvent.owner);
             }
         }
 
+        // === REMOTE STATE ===
+        // The host collects input commands, clients take the host's word for every player
+        if (isHost) {
+            receiveInputs();
+        } else {
+            receiveAuthorityState();
+        }
+
         // === DAMAGE HANDLING ===
-        // All damage is handled locally through bullet collision detection
-        // No network damage messages needed
+        // Damage is resolved by the host's simulation and arrives with the health updates
 
         // === RESET SYNCHRONIZATION ===
-        // Check for incoming reset from remote player
+        // A reset comes from the remote player, or from R on the game-over screen here
+        PlayerInput input;
+        bool resetPressed;
+        takeInput(input, resetPressed);
+        if (resetPressed) {
+            network->sendReset();
+            reset();
+        }
         if (network->receiveReset()) {
             reset();
         }
 
-        // === UPDATE BULLETS ===
-        players[localIndex].updateBullets(gameMap);
-        if (remotePlayerConnected && players.size() > 1) {
-            players[remoteIndex].updateBullets(gameMap);
+        // === SIMULATION ===
+        // Fixed ticks at the authority's rate, so an input command means the same on both ends.
+        // Movement, bullet updates and bullet-vs-player collisions all happen in the simulation tick.
+        tickSeconds = 1.0f / network->getTickRate();
+        auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(tickSeconds));
+        int ticks = 0;
+        while (Clock::now() >= nextTick && ticks < MAX_CATCH_UP_TICKS) {
+            step(input);
+            nextTick += tickLength;
+            ticks++;
         }
-
-        // === COLLISION DETECTION ===
-        if (remotePlayerConnected && players.size() > 1) {
-            checkBulletCollisions(localIndex, remoteIndex);
+        if (ticks == MAX_CATCH_UP_TICKS) {
+            nextTick = Clock::now() + tickLength;
         }
-
-        // === HEALTH SYNCING FOR DISPLAY ===
-        // Send our health if it changed (after collision detection)
-        if (players[localIndex].hasHealthChanged()) {
-            network->sendHealth(players[localIndex].getHealth());
-            players[localIndex].clearHealthChangeFlag();
+        if (ticks > 0) {
+            publishState();
         }
+        // Everything this frame's ticks sent leaves together
+        network->flush();
 
-        // Send remote player health if we applied damage to them locally
-        if (remotePlayerConnected && players.size() > 1 && players[remoteIndex].hasHealthChanged()) {
-            network->sendHealth(players[remoteIndex].getHealth());
-            players[remoteIndex].clearHealthChangeFlag();
-        }
+        // Everything allocated from the arena since the last batch is dead now
+        frameArena.reset();
+        std::this_thread::sleep_until(nextTick);
+    }
+}
 
-        // Receive remote player's health for display
-        int remoteHealth;
-        if (network->receiveHealth(remoteHealth)) {
-            if (remotePlayerConnected && players.size() > 1) {
-                players[remoteIndex].setHealth(remoteHealth);
-                players[remoteIndex].clearHealthChangeFlag();  // Don't trigger another sync
-            }
-        }
+void Game::takeInput(PlayerInput& input, bool& resetPressed) {
+    {
+        std::lock_guard<std::mutex> lock(exchangeMutex);
+        takenInputs.swap(sampledInputs);
+    }
+
+    // Direction follows the newest frame and the weapon the newest frame that picked one; a shot or
+    // reset from any frame since the last batch counts. Only direction and weapon carry over a batch
+    // no frame arrived for: a render stall must not keep firing.
+    resetPressed = false;
+    if (!takenInputs.empty()) {
+        heldInput = takenInputs.back().input;
+    }
+    for (const FrameInput& frame : takenInputs) {
+        heldInput.fire = heldInput.fire || frame.input.fire;
+        if (frame.input.select != 0) heldInput.select = frame.input.select;
+        resetPressed = resetPressed || frame.resetPressed;
+    }
+    takenInputs.clear();
+    input = heldInput;
+    heldInput.fire = false;
+}
 
-        // === DRAW MAP ===
-        gameMap->draw();
+void Game::publishState() {
+    // Copy-assigning into a slot reuses its buffers, so after the first few ticks this doesn't allocate
+    RenderState& state = states.back();
+    state.registry = registry;
+    state.localPlayer = localPlayer;
+    state.connected = network->isConnected();
+    states.publish();
+
+    std::lock_guard<std::mutex> lock(exchangeMutex);
+    publishedHits.insert(publishedHits.end(), tickHits.begin(), tickHits.end());
+    tickHits.clear();
+}
 
-        // === DRAW PLAYERS AND BULLETS ===
-        for (auto& player : players) {
-            player.draw();
-        }
+void Game::step(const PlayerInput& input) {
+    registry.getInput(localPlayer) = input;
 
-        // === DRAW CONNECTION STATUS ===
-        if (!remotePlayerConnected) {
-            std::string waitingText;
-            if (isHost) {
-                waitingText = "Waiting for client to connect...";
-            } else {
-                waitingText = network->isConnected() ? "Connected! Waiting for game data..." : "Connecting to host...";
+    if (isHost) {
+        // Remote players are driven by their own commands, one per tick
+        const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+        std::vector<PlayerInput>& inputs = registry.getInputs();
+        for (size_t i = 0; i < networkIds.size(); ++i) {
+            if (networkIds[i].peer != NetworkId::LOCAL) {
+                inputs[i] = commandQueueFor(networkIds[i].peer).next();
             }
-            int textWidth = MeasureText(waitingText.c_str(), 20);
-            DrawText(waitingText.c_str(), Constants::SCREEN_WIDTH / 2 - textWidth / 2, Constants::SCREEN_HEIGHT / 2 - 100, 20, DARKGRAY);
         }
 
-        // === DRAW HEALTH ===
-        drawHealth();
+        simulation->tick(jobs, tickSeconds);
+        tickHits.insert(tickHits.end(), simulation->getHits().begin(), simulation->getHits().end());
+        sendSnapshots();
+        return;
+    }
 
-        // === CHECK GAME OVER ===
-        if (!players[localIndex].isAlive()) {
-            DrawText("YOU DIED! Press R to restart or ESC to quit", Constants::SCREEN_WIDTH / 2 - 200, Constants::SCREEN_HEIGHT / 2, 20,
-                     RED);
-            if (IsKeyPressed(KEY_R)) {
-                network->sendReset();
-                reset();
-            }
-        }
-        if (remotePlayerConnected && players.size() > 1 && !players[remoteIndex].isAlive()) {
-            DrawText("YOU WIN! Press R to restart or ESC to quit", Constants::SCREEN_WIDTH / 2 - 200, Constants::SCREEN_HEIGHT / 2, 20,
-                     GREEN);
-            if (IsKeyPressed(KEY_R)) {
-                network->sendReset();
-                reset();
-            }
-        }
+    uint8_t buttons[Protocol::INPUT_REDUNDANCY];
+    size_t count;
+    uint32_t tick = prediction.record(input, buttons, count);
+    network->sendInput(tick, buttons, count);
 
-        EndDrawing();
+    // Predict our own player; remote players only move through the host's updates
+    simulation->tick(jobs, tickSeconds);
+    tickHits.insert(tickHits.end(), simulation->getHits().begin(), simulation->getHits().end());
+}
 
-        if (WindowShouldClose()) {
-            stop();
-        }
+void Game::receiveInputs() {
+    uint16_t owner;
+    uint32_t newestTick;
+    uint8_t buttons[Protocol::INPUT_REDUNDANCY];
+    size_t count;
+    while (network->receiveInput(owner, newestTick, buttons, count)) {
+        commandQueueFor(owner).receive(newestTick, buttons, count);
     }
 }
 
-void Game::stop() {
-    isRunning = false;
+void Game::sendSnapshots() {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        Player player(registry, entities[i]);
+        bool isLocal = networkIds[i].peer == NetworkId::LOCAL;
+        uint16_t owner = isLocal ? Protocol::OWNER_HOST : networkIds[i].peer;
+        uint32_t ackTick = isLocal ? 0 : commandQueueFor(owner).getLastApplied();
+
+        Position position = player.getPosition();
+        network->sendPosition(owner, position.x, position.y, ackTick);
+        network->sendBullets(owner, player.getShotCount(), player.getBullets());
+
+        if (player.hasHealthChanged()) {
+            network->sendHealth(owner, player.getHealth());
+            player.clearHealthChangeFlag();
+        }
+    }
 }
 
-void Game::createRemotePlayer() {
-    if (!remotePlayerConnected && players.size() == 1) {
-        if (isHost) {
-            players.emplace_back(5, RED, 10, PlayerShape::CIRCLE);  // Client player
+void Game::receiveAuthorityState() {
+    // Until the host tells us our slot we can't tell our own state from anyone else's
+    uint16_t self = network->getOwner();
+    if (self == Protocol::OWNER_SELF) {
+        return;
+    }
+
+    // Joining or resuming mid-match: the snapshot comes first, the messages after it are newer
+    auto snapshotStart = std::chrono::steady_clock::now();
+    Snapshot snapshot;
+    if (network->receiveSnapshot(snapshot)) {
+        applySnapshot(snapshot, std::chrono::duration<double>(std::chrono::steady_clock::now() - snapshotStart).count());
+    }
+
+    uint16_t owner;
+    float x, y;
+    uint32_t ackTick;
+    while (network->receivePosition(owner, x, y, ackTick)) {
+        Position position = {static_cast<int>(x), static_cast<int>(y)};
+        if (owner == self) {
+            prediction.reconcile(registry, localPlayer, gameMap, position, ackTick, tickSeconds);
         } else {
-            players.emplace_back(5, BLUE, 10, PlayerShape::CIRCLE);  // Host player
+            Player(registry, spawnRemotePlayer(owner)).setPosition(position);
         }
+    }
 
-        // Set spawn position for remote player (opposite corner from local player)
-        int margin = 50;  // Safe distance from walls and obstacles
-        if (isHost) {
-            players[1].setPosition({Constants::SCREEN_WIDTH - margin, Constants::SCREEN_HEIGHT - margin});  // Client spawns bottom-right
-        } else {
-            players[1].setPosition({margin, margin});  // Host spawns top-left
+    // Our own bullets are predicted locally
+    std::pmr::vector<Bullet> remoteBullets(frameArena.resource());
+    uint8_t shots;
+    while (network->receiveBullets(owner, shots, remoteBullets)) {
+        if (owner != self) {
+            Player remote(registry, spawnRemotePlayer(owner));
+            remote.setBullets(remoteBullets);
+            remote.setShotCount(shots);
         }
-        remotePlayerConnected = true;
+        remoteBullets.clear();
     }
-}
 
-void Game::reset() {
-    // Reset player health
-    for (auto& player : players) {
-        player.setHealth(100);
+    int health;
+    while (network->receiveHealth(owner, health)) {
+        Player player(registry, owner == self ? localPlayer : spawnRemotePlayer(owner));
+        player.setHealth(health);
         player.clearHealthChangeFlag();
     }
+}
 
-    // Clear all bullets
-    std::vector<Bullet> emptyBullets;
-    players[0].setBullets(emptyBullets);
-    if (players.size() > 1) {
-        players[1].setBullets(emptyBullets);
+void Game::applySnapshot(const Snapshot& snapshot, double decodeSeconds) {
+    auto start = std::chrono::steady_clock::now();
+    if (snapshot.worldWidth != gameMap->getWidth() || snapshot.worldHeight != gameMap->getHeight()) {
+        std::cerr << "Snapshot is for a " << snapshot.worldWidth << "x" << snapshot.worldHeight << " world, ours is "
+                  << gameMap->getWidth() << "x" << gameMap->getHeight() << std::endl;
     }
 
-    // Reset positions (opposite corners, safe from obstacles)
-    int margin = 50;  // Safe distance from walls and obstacles
-    if (isHost) {
-        players[0].setPosition({margin, margin});  // Host top-left
-        if (players.size() > 1) {
-            players[1].setPosition({Constants::SCREEN_WIDTH - margin, Constants::SCREEN_HEIGHT - margin});  // Client bottom-right
+    uint16_t self = network->getOwner();
+    for (const SnapshotPlayer& player : snapshot.players) {
+        if (player.owner != self) {
+            restorePlayer(registry, spawnRemotePlayer(player.owner), player, !network->hasLiveHealth(player.owner));
+            continue;
         }
-    } else {
-        players[0].setPosition({Constants::SCREEN_WIDTH - margin, Constants::SCREEN_HEIGHT - margin});  // Client bottom-right
-        if (players.size() > 1) {
-            players[1].setPosition({margin, margin});  // Host top-left
+
+        // Whatever we sent after the snapshot's tick is replayed on top, as for any correction. A
+        // position update that overtook the snapshot is newer still, so then that one stands.
+        Player local(registry, localPlayer);
+        Position current = local.getPosition();
+        restorePlayer(registry, localPlayer, player, !network->hasLiveHealth(player.owner));
+        if (!prediction.reconcile(registry, localPlayer, gameMap, player.position, player.ackTick, tickSeconds) &&
+            prediction.getLastAckedTick() > 0) {
+            local.setPosition(current);
         }
     }
+
+    // Playable from here on; the apply has to fit in a tick or the join shows as a hitch
+    double applySeconds = decodeSeconds + std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Playable " << network->getSecondsSinceConnecting() * 1000.0 << " ms after connecting; snapshot of "
+              << snapshot.players.size() << " players applied in " << applySeconds * 1000.0 << " ms" << std::endl;
+    if (applySeconds > tickSeconds) {
+        std::cerr << "Applying the snapshot took longer than a tick" << std::endl;
+    }
 }
 
-void Game::checkBulletCollisions(int localIndex, int remoteIndex) {
-    // Check if local bullets hit remote player
-    auto& localBullets = const_cast<std::vector<Bullet>&>(players[localIndex].getBullets());
-    for (auto it = localBullets.begin(); it != localBullets.end();) {
-        if (players[remoteIndex].isCollidingWith(*it)) {
-            // Apply damage immediately for instant visual feedback
-            players[remoteIndex].takeDamage(10);
-            // No need to send damage over network - collision is handled locally on both sides
-            it = localBullets.erase(it);
-        } else {
-            ++it;
-        }
+CommandQueue& Game::commandQueueFor(uint16_t owner) {
+    if (owner >= commandQueues.size()) {
+        commandQueues.resize(owner + 1);
     }
+    return commandQueues[owner];
+}
 
-    // Check if remote bullets hit local player
-    auto& remoteBullets = const_cast<std::vector<Bullet>&>(players[remoteIndex].getBullets());
-    for (auto it = remoteBullets.begin(); it != remoteBullets.end();) {
-        if (players[localIndex].isCollidingWith(*it)) {
-            // When remote bullet hits us, we take damage locally
-            players[localIndex].takeDamage(10);
-            it = remoteBullets.erase(it);
-        } else {
-            ++it;
+Position Game::spawnPointFor(NetworkId id) const {
+    uint16_t owner = id.peer;
+    if (owner == NetworkId::LOCAL) {
+        owner = network->getOwner();
+        if (owner == Protocol::OWNER_SELF) {
+            owner = Protocol::ownerForPeer(0);  // Not welcomed yet: take the first client corner
         }
     }
+    return gameMap->getSpawnPoint(owner);
+}
 
-    // Update the bullets vectors in the players
-    players[localIndex].setBullets(localBullets);
-    players[remoteIndex].setBullets(remoteBullets);
+Entity Game::spawnRemotePlayer(uint16_t owner) {
+    Entity existing = registry.findByNetworkId(owner);
+    if (existing != NULL_ENTITY) {
+        return existing;
+    }
+
+    NetworkId id{owner};
+    Entity remote;
+    if (owner == Protocol::OWNER_HOST) {
+        remote = Player::spawn(registry, id, 5, BLUE, 10, PlayerShape::CIRCLE);  // Host player
+    } else {
+        remote = Player::spawn(registry, id, 5, RED, 10, PlayerShape::CIRCLE);  // Client player
+    }
+
+    // Set spawn position for remote player (away from the local player)
+    Player(registry, remote).setPosition(spawnPointFor(id));
+    return remote;
 }
 
-void Game::drawHealth() {
-    int localIndex = 0;   // Local player is always index 0
-    int remoteIndex = 1;  // Remote player is always index 1
-
-    int localHealth = players[localIndex].getHealth();
-    int remoteHealth = remotePlayerConnected && players.size() > 1 ? players[remoteIndex].getHealth() : 0;
-
-    // Health bar dimensions and constants
-    const int barWidth = 150;
-    const int barHeight = 12;
-    const int margin = 15;
-    const int fontSize = 14;
-    const int labelOffset = 18;
-
-    // Color based on health percentage
-    auto getHealthColor = [](int health) -> Color {
-        if (health > 70) return GREEN;
-        if (health > 40) return YELLOW;
-        if (health > 15) return ORANGE;
-        return RED;
-    };
-
-    Color localHealthColor = getHealthColor(localHealth);
-    Color remoteHealthColor = getHealthColor(remoteHealth);
-
-    // === LOCAL PLAYER HEALTH (Bottom Left) ===
-    int localBarX = margin;
-    int localBarY = Constants::SCREEN_HEIGHT - 35;
-
-    // Background bar with subtle shadow
-    DrawRectangle(localBarX + 1, localBarY + 1, barWidth, barHeight, {20, 20, 20, 180});
-    DrawRectangle(localBarX, localBarY, barWidth, barHeight, {40, 40, 40, 220});
-
-    // Health fill with simple gradient effect
-    int healthWidth = (localHealth * (barWidth - 2)) / 100;
-    DrawRectangle(localBarX + 1, localBarY + 1, healthWidth, barHeight - 2, localHealthColor);
-    // Add a subtle highlight on top
-    Color highlightColor = {(unsigned char)std::min(255, localHealthColor.r + 40), (unsigned char)std::min(255, localHealthColor.g + 40),
-                            (unsigned char)std::min(255, localHealthColor.b + 40), 150};
-    DrawRectangle(localBarX + 1, localBarY + 1, healthWidth, 2, highlightColor);
-
-    // Border with highlight
-    DrawRectangleLines(localBarX, localBarY, barWidth, barHeight, WHITE);
-    DrawRectangleLines(localBarX + 1, localBarY + 1, barWidth - 2, barHeight - 2, {200, 200, 200, 100});
-
-    // Player label and health text
-    DrawText("YOU", localBarX, localBarY - labelOffset, fontSize, BLACK);
-    std::string localHealthText = std::to_string(localHealth) + "%";
-    int textWidth = MeasureText(localHealthText.c_str(), fontSize);
-    DrawText(localHealthText.c_str(), localBarX + barWidth - textWidth, localBarY - labelOffset, fontSize, BLACK);
-
-    // === ENEMY PLAYER HEALTH (Bottom Right) ===
-    // Only show if remote player is connected
-    if (remotePlayerConnected && players.size() > 1) {
-        int enemyBarX = Constants::SCREEN_WIDTH - barWidth - margin;
-        int enemyBarY = Constants::SCREEN_HEIGHT - 35;
-
-        // Background bar with subtle shadow
-        DrawRectangle(enemyBarX + 1, enemyBarY + 1, barWidth, barHeight, {20, 20, 20, 180});
-        DrawRectangle(enemyBarX, enemyBarY, barWidth, barHeight, {40, 40, 40, 220});
-
-        // Health fill with simple gradient effect
-        int enemyHealthWidth = (remoteHealth * (barWidth - 2)) / 100;
-        DrawRectangle(enemyBarX + 1, enemyBarY + 1, enemyHealthWidth, barHeight - 2, remoteHealthColor);
-        // Add a subtle highlight on top
-        Color enemyHighlightColor = {(unsigned char)std::min(255, remoteHealthColor.r + 40),
-                                     (unsigned char)std::min(255, remoteHealthColor.g + 40),
-                                     (unsigned char)std::min(255, remoteHealthColor.b + 40), 150};
-        DrawRectangle(enemyBarX + 1, enemyBarY + 1, enemyHealthWidth, 2, enemyHighlightColor);
-
-        // Border with highlight
-        DrawRectangleLines(enemyBarX, enemyBarY, barWidth, barHeight, WHITE);
-        DrawRectangleLines(enemyBarX + 1, enemyBarY + 1, barWidth - 2, barHeight - 2, {200, 200, 200, 100});
-
-        // Enemy label and health text
-        int enemyLabelWidth = MeasureText("ENEMY", fontSize);
-        DrawText("ENEMY", enemyBarX + barWidth - enemyLabelWidth, enemyBarY - labelOffset, fontSize, BLACK);
-        std::string remoteHealthText = std::to_string(remoteHealth) + "%";
-        DrawText(remoteHealthText.c_str(), enemyBarX, enemyBarY - labelOffset, fontSize, BLACK);
+void Game::despawnRemotePlayer(uint16_t owner) {
+    registry.despawn(registry.findByNetworkId(owner));
+}
+
+void Game::reset() {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        Player player(registry, entities[i]);
+
+        // Reset player health; the host sends it out with the next snapshot
+        player.setHealth(100);
+
+        // Clear all bullets
+        player.clearBullets();
+
+        // Reset positions (separate corners, safe from obstacles)
+        player.setPosition(spawnPointFor(networkIds[i]));
     }
+}
 
-    // === LOW HEALTH VISUAL EFFECTS ===
-    // Add warning indicators for critically low health
-    if (localHealth <= 25) {
-        // Pulsing red overlay for critically low health
-        float pulse = (sin(GetTime() * 8.0f) + 1.0f) / 2.0f;  // 0.0 to 1.0
-        Color pulseColor = {255, 0, 0, (unsigned char)(50 * pulse)};
-        DrawRectangle(localBarX - 2, localBarY - 2, barWidth + 4, barHeight + 4, pulseColor);
-
-        // Warning text
-        if ((int)(GetTime() * 2) % 2 == 0) {  // Blink every 0.5 seconds
-            DrawText("LOW HEALTH!", localBarX, localBarY + barHeight + 5, 12, RED);
-        }
+void Game::checkFrameAllocations(std::size_t allocationsAtFrameStart) {
+    if (!AllocCounter::isEnabled()) {
+        return;
     }
 
-    if (remotePlayerConnected && players.size() > 1 && remoteHealth <= 25) {
-        // Subtle glow for enemy low health
-        int enemyBarX = Constants::SCREEN_WIDTH - barWidth - margin;
-        int enemyBarY = Constants::SCREEN_HEIGHT - 35;
-        float pulse = (sin(GetTime() * 6.0f) + 1.0f) / 2.0f;
-        Color pulseColor = {255, 100, 0, (unsigned char)(30 * pulse)};
-        DrawRectangle(enemyBarX - 1, enemyBarY - 1, barWidth + 2, barHeight + 2, pulseColor);
+    // The first frames grow long-lived containers to their working size
+    const unsigned long warmupFrames = 120;
+    std::size_t frameAllocations = AllocCounter::count() - allocationsAtFrameStart;
+    if (frameCount >= warmupFrames && frameAllocations > 0) {
+        std::cerr << "Frame " << frameCount << " made " << frameAllocations << " heap allocation(s)" << std::endl;
     }
 }
@@ -1,34 +1,126 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "core/camera.hpp"
+#include "core/frame_arena.hpp"
+#include "core/hud.hpp"
+#include "core/job_system.hpp"
 #include "core/map.hpp"
+#include "core/particles.hpp"
+#include "core/registry.hpp"
+#include "core/simulation.hpp"
+#include "core/triple_buffer.hpp"
 #include "entities/player.hpp"
+#include "network/input_commands.hpp"
+#include "network/network_config.hpp"
 #include "network/network_manager.hpp"
+#include "network/prediction.hpp"
 
+// Everything the render thread needs of one tick. The simulation thread fills one and publishes
+// it; from then on the render thread only reads it.
+struct RenderState {
+    Registry registry;
+    Entity localPlayer = NULL_ENTITY;
+    bool connected = false;
+};
+
+// What the render thread sampled for one frame
+struct FrameInput {
+    PlayerInput input;
+    bool resetPressed;
+};
+
+// The simulation, networking included, runs on its own thread at the tick rate and publishes a
+// RenderState after every batch of ticks through a triple buffer. The thread that called start()
+// owns the window: it draws the newest complete state, so a slow EndDrawing (vsync, a driver
+// stall) costs frames but never ticks, and hands the input it samples back through a queue.
 class Game {
    public:
-    Game(bool isHost);
+    Game(bool isHost, const NetworkConfig& networkConfig);
     ~Game();
 
-    void start();
-    void stop();
+    void start();  // Renders until the window closes; the simulation thread lives as long as this call
+    void stop();   // From either thread
     void reset();
-    void createRemotePlayer();
 
    private:
-    void checkBulletCollisions(int localIndex, int remoteIndex);
-    void drawHealth();
+    // Remote players come and go with their connections, keyed by owner slot
+    Entity spawnRemotePlayer(uint16_t owner);
+    void despawnRemotePlayer(uint16_t owner);
+    Position spawnPointFor(NetworkId id) const;
+
+    // Simulation thread. Fixed-rate ticks: the host is the authority for every player; a client sends
+    // its input upstream, predicts its own player and replays unacknowledged input when corrected.
+    void simulate();
+    void takeInput(PlayerInput& input, bool& resetPressed);
+    void publishState();
+    void step(const PlayerInput& input);
+    void receiveInputs();
+    void sendSnapshots();
+    void receiveAuthorityState();
+    void applySnapshot(const Snapshot& snapshot, double decodeSeconds);
+    CommandQueue& commandQueueFor(uint16_t owner);
 
-    bool isRunning;
+    // Render thread
+    void render(RenderState& state);
+    void checkFrameAllocations(std::size_t allocationsAtFrameStart);
+
+    std::atomic<bool> isRunning;
     const std::string windowTitle = "2d-shooter";
     bool isHost;
-    bool remotePlayerConnected;
-    NetworkManager* network;
-    std::vector<Player> players;
     Map* gameMap;
+
+    // === Simulation thread ===
+    std::thread simulationThread;
+    NetworkManager* network;
+    Registry registry;
+    Entity localPlayer;
+    Simulation* simulation;
+
+    // A client only simulates a handful of players, so the tick runs inline on the simulation thread
+    JobSystem jobs{0};
+
+    // Scratch memory for per-tick temporaries, reset after every batch of ticks
+    FrameArena frameArena;
+
+    static constexpr int MAX_CATCH_UP_TICKS = 4;  // A longer stall is dropped rather than caught up
+    float tickSeconds;
+    PlayerInput heldInput = {{0, 0}, false};  // Newest sample; direction and weapon kept while the render thread sends none
+    std::vector<FrameInput> takenInputs;
+    std::vector<Hit> tickHits;
+
+    // Client side
+    ClientPrediction prediction;
+
+    // Host side: pending commands per remote owner slot
+    std::vector<CommandQueue> commandQueues;
+
+    // === Shared ===
+    TripleBuffer<RenderState> states;
+
+    // Exchanged under the mutex by swapping whole vectors
+    std::mutex exchangeMutex;
+    std::vector<FrameInput> sampledInputs;  // Render to simulation
+    std::vector<Hit> publishedHits;         // Simulation to render, for effects
+
+    // === Render thread ===
+    // Hit sparks, muzzle flashes and death bursts, made locally from gameplay events
+    ParticleEffects effects;
+
+    // Health bars, connection status and the game-over banner
+    Hud hud;
+
+    // Follows the local player round a world larger than the window
+    FollowCamera camera;
+
+    std::vector<Hit> drawnHits;
+    unsigned long frameCount = 0;
 };
 
 #endif
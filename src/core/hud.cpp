@@ -0,0 +1,214 @@
+#include "core/hud.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "core/constants.hpp"
+#include "core/quad_batch.hpp"
+
+namespace {
+constexpr int MARGIN = 15;
+constexpr int BAR_BOTTOM_OFFSET = 35;
+constexpr int FONT_SIZE = 14;
+constexpr int LABEL_OFFSET = 18;
+
+Color healthColor(int health) {
+    if (health > 70) return GREEN;
+    if (health > 40) return YELLOW;
+    if (health > 15) return ORANGE;
+    return RED;
+}
+
+bool sameColor(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+Color brighten(Color color) {
+    return {static_cast<unsigned char>(std::min(255, color.r + 40)), static_cast<unsigned char>(std::min(255, color.g + 40)),
+            static_cast<unsigned char>(std::min(255, color.b + 40)), 150};
+}
+
+// One pixel outline as four quads, so it joins the same batch as the fills
+void addOutline(std::vector<HudQuad>& quads, float x, float y, float width, float height, Color color) {
+    quads.push_back({x, y, width, 1.0f, color});
+    quads.push_back({x, y + height - 1.0f, width, 1.0f, color});
+    quads.push_back({x, y + 1.0f, 1.0f, height - 2.0f, color});
+    quads.push_back({x + width - 1.0f, y + 1.0f, 1.0f, height - 2.0f, color});
+}
+
+// Sine pulse between 0 and 1
+float pulse(float speed) {
+    return (std::sin(static_cast<float>(GetTime()) * speed) + 1.0f) / 2.0f;
+}
+}  // namespace
+
+HealthBarWidget::HealthBarWidget(int barX, int barY, const char* barName, bool nameLeft)
+    : x(barX),
+      y(barY),
+      name(barName),
+      nameOnLeft(nameLeft),
+      visible(false),
+      health(-1),
+      fill(BLANK),
+      highlight(BLANK),
+      percentWidth(0),
+      nameWidth(-1) {}
+
+bool HealthBarWidget::set(bool show, int value) {
+    if (show == visible && (!show || value == health)) {
+        return false;
+    }
+    visible = show;
+    if (!show || value == health) {
+        return true;
+    }
+
+    health = value;
+    fill = healthColor(health);
+    highlight = brighten(fill);
+    char text[8];
+    std::snprintf(text, sizeof(text), "%d%%", health);
+    percent = text;
+    percentWidth = MeasureText(text, FONT_SIZE);
+    if (nameWidth < 0) {
+        nameWidth = MeasureText(name, FONT_SIZE);
+    }
+    return true;
+}
+
+void HealthBarWidget::build(std::vector<HudQuad>& quads, std::vector<HudLabel>& labels) const {
+    if (!visible) return;
+
+    float left = static_cast<float>(x);
+    float top = static_cast<float>(y);
+    float filled = static_cast<float>(std::max(0, health * (WIDTH - 2) / 100));
+
+    // Shadow, background, fill with a highlight along its top, then a double border
+    quads.push_back({left + 1.0f, top + 1.0f, WIDTH, HEIGHT, {20, 20, 20, 180}});
+    quads.push_back({left, top, WIDTH, HEIGHT, {40, 40, 40, 220}});
+    quads.push_back({left + 1.0f, top + 1.0f, filled, HEIGHT - 2.0f, fill});
+    quads.push_back({left + 1.0f, top + 1.0f, filled, 2.0f, highlight});
+    addOutline(quads, left, top, WIDTH, HEIGHT, WHITE);
+    addOutline(quads, left + 1.0f, top + 1.0f, WIDTH - 2.0f, HEIGHT - 2.0f, {200, 200, 200, 100});
+
+    int labelY = y - LABEL_OFFSET;
+    if (nameOnLeft) {
+        labels.push_back({name, x, labelY, FONT_SIZE, BLACK});
+        labels.push_back({percent, x + WIDTH - percentWidth, labelY, FONT_SIZE, BLACK});
+    } else {
+        labels.push_back({name, x + WIDTH - nameWidth, labelY, FONT_SIZE, BLACK});
+        labels.push_back({percent, x, labelY, FONT_SIZE, BLACK});
+    }
+}
+
+bool HealthBarWidget::isVisible() const {
+    return visible;
+}
+
+bool HealthBarWidget::isLow() const {
+    return visible && health <= LOW_HEALTH;
+}
+
+int HealthBarWidget::getX() const {
+    return x;
+}
+
+int HealthBarWidget::getY() const {
+    return y;
+}
+
+TextWidget::TextWidget(int textX, int textY, int size) : x(textX), y(textY), fontSize(size), visible(false), color(BLANK), left(0) {}
+
+bool TextWidget::set(const char* value, Color textColor) {
+    bool show = value != nullptr;
+    if (show == visible && (!show || (text == value && sameColor(color, textColor)))) {
+        return false;
+    }
+    visible = show;
+    if (!show) {
+        return true;
+    }
+
+    text = value;
+    color = textColor;
+    left = x == CENTERED ? Constants::SCREEN_WIDTH / 2 - MeasureText(value, fontSize) / 2 : x;
+    return true;
+}
+
+void TextWidget::build(std::vector<HudLabel>& labels) const {
+    if (visible) {
+        labels.push_back({text, left, y, fontSize, color});
+    }
+}
+
+Hud::Hud()
+    : localBar(MARGIN, Constants::SCREEN_HEIGHT - BAR_BOTTOM_OFFSET, "YOU", true),
+      enemyBar(Constants::SCREEN_WIDTH - HealthBarWidget::WIDTH - MARGIN, Constants::SCREEN_HEIGHT - BAR_BOTTOM_OFFSET, "ENEMY", false),
+      status(TextWidget::CENTERED, Constants::SCREEN_HEIGHT / 2 - 100, 20),
+      banner(Constants::SCREEN_WIDTH / 2 - 200, Constants::SCREEN_HEIGHT / 2, 20),
+      dirty(true),
+      rebuildCount(0) {}
+
+void Hud::setLocalHealth(int health) {
+    dirty |= localBar.set(true, health);
+}
+
+void Hud::setEnemyHealth(bool visible, int health) {
+    dirty |= enemyBar.set(visible, health);
+}
+
+void Hud::setStatus(const char* text) {
+    dirty |= status.set(text, DARKGRAY);
+}
+
+void Hud::setBanner(const char* text, Color color) {
+    dirty |= banner.set(text, color);
+}
+
+unsigned long Hud::getRebuildCount() const {
+    return rebuildCount;
+}
+
+void Hud::rebuild() {
+    // clear() keeps the capacity, so after the first few rebuilds only changed strings allocate
+    quads.clear();
+    labels.clear();
+    localBar.build(quads, labels);
+    enemyBar.build(quads, labels);
+    status.build(labels);
+    banner.build(labels);
+    dirty = false;
+    rebuildCount++;
+}
+
+void Hud::draw() {
+    if (dirty) {
+        rebuild();
+    }
+
+    QuadBatch::begin(quads.size());
+    for (const HudQuad& quad : quads) {
+        QuadBatch::add(quad.x, quad.y, quad.x + quad.width, quad.y + quad.height, quad.color);
+    }
+    QuadBatch::end();
+    for (const HudLabel& label : labels) {
+        DrawText(label.text.c_str(), label.x, label.y, label.fontSize, label.color);
+    }
+
+    // Animated warnings change every frame, so they are drawn over the batch instead of cached in it
+    const int width = HealthBarWidget::WIDTH;
+    const int height = HealthBarWidget::HEIGHT;
+    if (localBar.isLow()) {
+        int barX = localBar.getX();
+        int barY = localBar.getY();
+        DrawRectangle(barX - 2, barY - 2, width + 4, height + 4, {255, 0, 0, static_cast<unsigned char>(50 * pulse(8.0f))});
+        if (static_cast<int>(GetTime() * 2) % 2 == 0) {  // Blink every 0.5 seconds
+            DrawText("LOW HEALTH!", barX, barY + height + 5, 12, RED);
+        }
+    }
+    if (enemyBar.isLow()) {
+        DrawRectangle(enemyBar.getX() - 1, enemyBar.getY() - 1, width + 2, height + 2,
+                      {255, 100, 0, static_cast<unsigned char>(30 * pulse(6.0f))});
+    }
+}
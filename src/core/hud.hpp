@@ -0,0 +1,106 @@
+#ifndef HUD_HPP
+#define HUD_HPP
+
+#include <raylib.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Retained-mode HUD. Each widget is bound to a value and keeps the geometry and text built from
+// it; setting the same value again costs a comparison. The HUD joins the widgets' pieces into one
+// cached batch when any of them changed, so an ordinary frame replays the quads in a single
+// rlgl batch and draws the cached strings, without measuring text or working out colors.
+// Only the low-health pulse and blink are animated, on top of the batch.
+
+struct HudQuad {
+    float x, y, width, height;
+    Color color;
+};
+
+struct HudLabel {
+    std::string text;
+    int x, y;
+    int fontSize;
+    Color color;
+};
+
+// Health bar with a name over one end and the percentage over the other
+class HealthBarWidget {
+   public:
+    static constexpr int WIDTH = 150;
+    static constexpr int HEIGHT = 12;
+    static constexpr int LOW_HEALTH = 25;
+
+    HealthBarWidget(int x, int y, const char* name, bool nameOnLeft);
+
+    bool set(bool visible, int health);  // True when that changed what the bar shows
+    void build(std::vector<HudQuad>& quads, std::vector<HudLabel>& labels) const;
+
+    bool isVisible() const;
+    bool isLow() const;
+    int getX() const;
+    int getY() const;
+
+   private:
+    int x, y;
+    const char* name;
+    bool nameOnLeft;
+    bool visible;
+    int health;
+
+    // Built when the health changes
+    Color fill;
+    Color highlight;
+    std::string percent;
+    int percentWidth;
+    int nameWidth;
+};
+
+// One line of text at a fixed height, centered or starting at a fixed x
+class TextWidget {
+   public:
+    static constexpr int CENTERED = -1;
+
+    TextWidget(int x, int y, int fontSize);
+
+    bool set(const char* text, Color color);  // nullptr hides the line
+    void build(std::vector<HudLabel>& labels) const;
+
+   private:
+    int x, y;
+    int fontSize;
+    bool visible;
+    std::string text;
+    Color color;
+    int left;  // Built x of the text
+};
+
+class Hud {
+   public:
+    Hud();
+
+    void setLocalHealth(int health);
+    void setEnemyHealth(bool visible, int health);  // Hidden while nobody else is connected
+    void setStatus(const char* text);                // Centered above the middle, nullptr hides it
+    void setBanner(const char* text, Color color);   // Game-over line, nullptr hides it
+
+    void draw();
+
+    unsigned long getRebuildCount() const;  // Batches built so far, for checking that idle frames don't
+
+   private:
+    void rebuild();
+
+    HealthBarWidget localBar;
+    HealthBarWidget enemyBar;
+    TextWidget status;
+    TextWidget banner;
+
+    bool dirty;
+    unsigned long rebuildCount;
+    std::vector<HudQuad> quads;
+    std::vector<HudLabel> labels;
+};
+
+#endif
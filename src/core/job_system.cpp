@@ -0,0 +1,189 @@
+#include "core/job_system.hpp"
+
+#include <algorithm>
+
+namespace {
+// Queue index of the worker running on this thread, or none for outside threads
+thread_local size_t workerQueueIndex = static_cast<size_t>(-1);
+thread_local const JobSystem* workerOwner = nullptr;
+}  // namespace
+
+bool JobSystem::WorkQueue::push(const Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == CAPACITY) {
+        return false;
+    }
+    jobs[(head + count) % CAPACITY] = job;
+    count++;
+    return true;
+}
+
+bool JobSystem::WorkQueue::pop(Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) {
+        return false;
+    }
+    count--;
+    job = jobs[(head + count) % CAPACITY];
+    return true;
+}
+
+bool JobSystem::WorkQueue::steal(Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) {
+        return false;
+    }
+    job = jobs[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+    return true;
+}
+
+JobSystem::JobSystem(size_t workerCount) {
+    // One queue per worker plus one shared by outside threads (the tick thread)
+    for (size_t i = 0; i < workerCount + 1; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t JobSystem::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+size_t JobSystem::getWorkerCount() const {
+    return workers.size();
+}
+
+size_t JobSystem::currentQueue() const {
+    if (workerOwner == this) {
+        return workerQueueIndex;
+    }
+    return workers.size();  // Shared queue for non-worker threads
+}
+
+void JobSystem::dispatch(void (*invoke)(void*, size_t, size_t), void* context, size_t count, size_t grainSize) {
+    std::atomic<size_t> pending{0};
+    size_t own = currentQueue();
+
+    // Spread chunks round-robin so idle workers find work without stealing first
+    for (size_t begin = 0; begin < count; begin += grainSize) {
+        Job job{invoke, context, begin, std::min(begin + grainSize, count), &pending};
+        pending.fetch_add(1, std::memory_order_relaxed);
+
+        size_t target = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        if (queues[target]->push(job) || queues[own]->push(job)) {
+            queuedJobs.fetch_add(1, std::memory_order_release);
+        } else {
+            // Queues are full: run it right here
+            job.invoke(job.context, job.begin, job.end);
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+
+    // Help out until every chunk of this call has finished
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!runOne(own)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::runOne(size_t preferredQueue) {
+    Job job;
+    bool found = queues[preferredQueue]->pop(job);
+    for (size_t i = 1; !found && i < queues.size(); ++i) {
+        found = queues[(preferredQueue + i) % queues.size()]->steal(job);
+    }
+    if (!found) {
+        return false;
+    }
+
+    queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    job.invoke(job.context, job.begin, job.end);
+    job.pending->fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void JobSystem::workerLoop(size_t index) {
+    workerQueueIndex = index;
+    workerOwner = this;
+
+    while (true) {
+        if (runOne(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queuedJobs.load(std::memory_order_acquire) > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+TaskGraph::TaskId TaskGraph::add(const char* name, std::function<void(JobSystem&)> task, std::initializer_list<TaskId> dependencies) {
+    nodes.push_back({name, std::move(task), std::vector<TaskId>(dependencies)});
+    return nodes.size() - 1;
+}
+
+void TaskGraph::run(JobSystem& jobs) {
+    done.assign(nodes.size(), 0);
+    size_t remaining = nodes.size();
+
+    while (remaining > 0) {
+        // Collect every task whose dependencies are finished, in insertion order
+        wave.clear();
+        for (TaskId id = 0; id < nodes.size(); ++id) {
+            if (done[id]) continue;
+            bool ready = std::all_of(nodes[id].dependencies.begin(), nodes[id].dependencies.end(),
+                                     [this](TaskId dependency) { return done[dependency] != 0; });
+            if (ready) wave.push_back(id);
+        }
+
+        if (wave.empty()) {
+            break;  // Cycle: nothing can make progress
+        }
+
+        jobs.parallelFor(wave.size(), 1, [this, &jobs](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                nodes[wave[i]].task(jobs);
+            }
+        });
+
+        for (TaskId id : wave) {
+            done[id] = 1;
+        }
+        remaining -= wave.size();
+    }
+}
+
+void TaskGraph::clear() {
+    nodes.clear();
+}
+
+size_t TaskGraph::size() const {
+    return nodes.size();
+}
+
+const char* TaskGraph::getName(TaskId id) const {
+    return nodes[id].name;
+}
@@ -0,0 +1,122 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing thread pool.
+// Each worker owns a queue: it pops its own work LIFO and steals from the others FIFO when empty.
+// The thread calling parallelFor() helps until its jobs are done, so nested calls cannot deadlock.
+// With zero workers everything runs inline on the caller (single-thread fallback).
+class JobSystem {
+   public:
+    explicit JobSystem(size_t workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static size_t defaultWorkerCount();  // One per core, minus the calling thread
+    size_t getWorkerCount() const;
+
+    // Calls fn(begin, end) for consecutive chunks of at most grainSize items covering [0, count).
+    // Chunks may run in any order on any thread; write results to per-index slots and merge them
+    // afterwards in index order to keep the outcome deterministic.
+    template <typename Fn>
+    void parallelFor(size_t count, size_t grainSize, Fn&& fn);
+
+   private:
+    struct Job {
+        void (*invoke)(void* context, size_t begin, size_t end);
+        void* context;
+        size_t begin;
+        size_t end;
+        std::atomic<size_t>* pending;
+    };
+
+    // Fixed-size ring guarded by a mutex; contention is low because owners and thieves work at opposite ends
+    class WorkQueue {
+       public:
+        static constexpr size_t CAPACITY = 1024;
+
+        bool push(const Job& job);
+        bool pop(Job& job);    // Owner end (newest)
+        bool steal(Job& job);  // Thief end (oldest)
+
+       private:
+        std::mutex mutex;
+        Job jobs[CAPACITY];
+        size_t head = 0;  // Oldest
+        size_t count = 0;
+    };
+
+    void dispatch(void (*invoke)(void*, size_t, size_t), void* context, size_t count, size_t grainSize);
+    bool runOne(size_t preferredQueue);
+    void workerLoop(size_t index);
+    size_t currentQueue() const;
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> queuedJobs{0};
+    std::atomic<size_t> nextQueue{0};
+    bool stopping = false;
+};
+
+template <typename Fn>
+void JobSystem::parallelFor(size_t count, size_t grainSize, Fn&& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+
+    // Small ranges and the single-thread fallback skip the queues entirely
+    if (workers.empty() || count <= grainSize) {
+        fn(size_t(0), count);
+        return;
+    }
+
+    using Callable = std::remove_reference_t<Fn>;
+    auto invoke = [](void* context, size_t begin, size_t end) { (*static_cast<Callable*>(context))(begin, end); };
+    dispatch(invoke, const_cast<void*>(static_cast<const void*>(&fn)), count, grainSize);
+}
+
+// Runs named tasks respecting their dependencies. Tasks whose dependencies are all finished form a
+// wave and run concurrently; waves run in the order tasks were added, so results are reproducible.
+class TaskGraph {
+   public:
+    using TaskId = size_t;
+
+    TaskId add(const char* name, std::function<void(JobSystem&)> task, std::initializer_list<TaskId> dependencies = {});
+    void run(JobSystem& jobs);
+    void clear();
+
+    size_t size() const;
+    const char* getName(TaskId id) const;
+
+   private:
+    struct Node {
+        const char* name;
+        std::function<void(JobSystem&)> task;
+        std::vector<TaskId> dependencies;
+    };
+
+    std::vector<Node> nodes;
+
+    // Scratch reused by run()
+    std::vector<unsigned char> done;
+    std::vector<TaskId> wave;
+};
+
+#endif
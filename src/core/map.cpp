@@ -2,10 +2,16 @@
 
 #include <raylib.h>
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 #include "core/constants.hpp"
 #include "entities/obstacle.hpp"
 
-Map::Map() {
+Map::Map() : Map(Constants::WORLD_WIDTH, Constants::WORLD_HEIGHT) {}
+
+Map::Map(int worldWidth, int worldHeight) : width(worldWidth), height(worldHeight) {
     initializeObstacles();
 }
 
@@ -19,78 +25,377 @@ void Map::initializeObstacles() {
 }
 
 void Map::createDefaultObstacles() {
+    std::vector<std::unique_ptr<Obstacle>> layout;
+
     // Create border walls
     // Top wall
-    addObstacle(std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH / 2, 15}, Constants::SCREEN_WIDTH, 30, GRAY));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width / 2, 15}, width, 30, GRAY));
 
     // Bottom wall
-    addObstacle(std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH / 2, Constants::SCREEN_HEIGHT - 15},
-                                                    Constants::SCREEN_WIDTH, 30, GRAY));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width / 2, height - 15}, width, 30, GRAY));
 
     // Left wall
-    addObstacle(std::make_unique<RectangleObstacle>(Position{15, Constants::SCREEN_HEIGHT / 2}, 30, Constants::SCREEN_HEIGHT, GRAY));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{15, height / 2}, 30, height, GRAY));
 
     // Right wall
-    addObstacle(std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH - 15, Constants::SCREEN_HEIGHT / 2}, 30,
-                                                    Constants::SCREEN_HEIGHT, GRAY));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width - 15, height / 2}, 30, height, GRAY));
 
     // Interior obstacles for interesting gameplay
     // Central pillar
-    addObstacle(std::make_unique<CircleObstacle>(Position{Constants::SCREEN_WIDTH / 2, Constants::SCREEN_HEIGHT / 2}, 40, DARKGRAY));
+    layout.push_back(std::make_unique<CircleObstacle>(Position{width / 2, height / 2}, 40, DARKGRAY));
 
     // Corner blocks
-    addObstacle(std::make_unique<RectangleObstacle>(Position{150, 150}, 60, 80, BROWN));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{150, 150}, 60, 80, BROWN));
 
-    addObstacle(std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH - 150, 150}, 60, 80, BROWN));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width - 150, 150}, 60, 80, BROWN));
 
-    addObstacle(std::make_unique<RectangleObstacle>(Position{150, Constants::SCREEN_HEIGHT - 150}, 60, 80, BROWN));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{150, height - 150}, 60, 80, BROWN));
 
-    addObstacle(
-        std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH - 150, Constants::SCREEN_HEIGHT - 150}, 60, 80, BROWN));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width - 150, height - 150}, 60, 80, BROWN));
 
     // Side obstacles
-    addObstacle(std::make_unique<CircleObstacle>(Position{Constants::SCREEN_WIDTH / 4, Constants::SCREEN_HEIGHT / 2}, 25, DARKGREEN));
+    layout.push_back(std::make_unique<CircleObstacle>(Position{width / 4, height / 2}, 25, DARKGREEN));
 
-    addObstacle(std::make_unique<CircleObstacle>(Position{3 * Constants::SCREEN_WIDTH / 4, Constants::SCREEN_HEIGHT / 2}, 25, DARKGREEN));
+    layout.push_back(std::make_unique<CircleObstacle>(Position{3 * width / 4, height / 2}, 25, DARKGREEN));
 
     // Additional rectangular obstacles for cover
-    addObstacle(
-        std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH / 2, Constants::SCREEN_HEIGHT / 4}, 100, 30, DARKBLUE));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width / 2, height / 4}, 100, 30, DARKBLUE));
+
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width / 2, 3 * height / 4}, 100, 30, DARKBLUE));
+
+    // Cover in the middle of each quarter, so a world bigger than the screen isn't open ground
+    // between the corners and the centre
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width / 4, height / 4}, 30, 100, DARKBLUE));
 
-    addObstacle(
-        std::make_unique<RectangleObstacle>(Position{Constants::SCREEN_WIDTH / 2, 3 * Constants::SCREEN_HEIGHT / 4}, 100, 30, DARKBLUE));
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{3 * width / 4, height / 4}, 30, 100, DARKBLUE));
+
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{width / 4, 3 * height / 4}, 30, 100, DARKBLUE));
+
+    layout.push_back(std::make_unique<RectangleObstacle>(Position{3 * width / 4, 3 * height / 4}, 30, 100, DARKBLUE));
+
+    addObstacles(std::move(layout));
 }
 
-void Map::draw() const {
-    for (const auto& obstacle : obstacles) {
-        obstacle->draw();
-    }
+void Map::draw(const WorldRect& view) const {
+    forEachObstacleIn(view, [this](int index) { obstacles[index]->draw(); });
+}
+
+int Map::getWidth() const {
+    return width;
+}
+
+int Map::getHeight() const {
+    return height;
 }
 
 bool Map::isPlayerColliding(Position playerPos, int playerRadius) const {
-    for (const auto& obstacle : obstacles) {
-        if (obstacle->isCollidingWith(playerPos, playerRadius)) {
-            return true;
-        }
-    }
-    return false;
+    return overlapsShape(playerPos, playerRadius);
 }
 
 bool Map::isBulletColliding(Position bulletPos, int bulletRadius) const {
-    for (const auto& obstacle : obstacles) {
-        if (obstacle->isCollidingWithBullet(bulletPos, bulletRadius)) {
-            return true;
-        }
-    }
-    return false;
+    return overlapsShape(bulletPos, bulletRadius);
 }
 
+namespace {
+// Earliest t in [0, 1] at which a point moving by (dx, dy) comes within radius of (cx, cy); the point starts outside
+bool sweepPointCircle(float px, float py, float dx, float dy, float cx, float cy, float radius, SweepHit& hit) {
+    float mx = px - cx;
+    float my = py - cy;
+    float a = dx * dx + dy * dy;
+    float b = mx * dx + my * dy;
+    float c = mx * mx + my * my - radius * radius;
+    float discriminant = b * b - a * c;
+    if (a == 0.0f || b >= 0.0f || discriminant < 0.0f) return false;
+
+    float t = (-b - std::sqrt(discriminant)) / a;
+    if (t < 0.0f || t > 1.0f) return false;
+
+    hit.time = t;
+    hit.normalX = (mx + dx * t) / radius;
+    hit.normalY = (my + dy * t) / radius;
+    return true;
+}
+
+// Touching already: only motion into the surface (normal pointing out of it) counts as a hit
+bool blocksMotion(float dx, float dy, float normalX, float normalY, SweepHit& hit) {
+    if (dx * normalX + dy * normalY >= -1e-6f) return false;
+    hit = {0.0f, normalX, normalY};
+    return true;
+}
+}  // namespace
+
 void Map::addObstacle(std::unique_ptr<Obstacle> obstacle) {
+    appendShape(*obstacle);
     obstacles.push_back(std::move(obstacle));
+    bvh.build(shapes);
+}
+
+void Map::addObstacles(std::vector<std::unique_ptr<Obstacle>> batch) {
+    for (std::unique_ptr<Obstacle>& obstacle : batch) {
+        appendShape(*obstacle);
+        obstacles.push_back(std::move(obstacle));
+    }
+    bvh.build(shapes);
+}
+
+void Map::appendShape(const Obstacle& obstacle) {
+    Position center = obstacle.getPosition();
+    ObstacleShape shape;
+    shape.type = obstacle.getType();
+    shape.x = static_cast<float>(center.x);
+    shape.y = static_cast<float>(center.y);
+    if (shape.type == ObstacleType::RECTANGLE) {
+        // Same integer extents as RectangleObstacle::isCollidingWith
+        const RectangleObstacle& rectangle = static_cast<const RectangleObstacle&>(obstacle);
+        shape.radius = 0.0f;
+        shape.minX = static_cast<float>(center.x - rectangle.getWidth() / 2);
+        shape.maxX = static_cast<float>(center.x + rectangle.getWidth() / 2);
+        shape.minY = static_cast<float>(center.y - rectangle.getHeight() / 2);
+        shape.maxY = static_cast<float>(center.y + rectangle.getHeight() / 2);
+    } else {
+        shape.radius = static_cast<float>(static_cast<const CircleObstacle&>(obstacle).getRadius());
+        shape.minX = shape.x - shape.radius;
+        shape.maxX = shape.x + shape.radius;
+        shape.minY = shape.y - shape.radius;
+        shape.maxY = shape.y + shape.radius;
+    }
+    shapes.push_back(shape);
 }
 
 void Map::clearObstacles() {
     obstacles.clear();
+    shapes.clear();
+    bvh.clear();
+}
+
+void Map::swapObstacles(Map& other) {
+    obstacles.swap(other.obstacles);
+    shapes.swap(other.shapes);
+    std::swap(bvh, other.bvh);
+}
+
+bool Map::raycast(const Ray& ray, RayHit& hit) const {
+    return bvh.raycast(ray, hit);
+}
+
+void Map::raycast(const Ray* rays, size_t count, RayHit* hits) const {
+    bvh.raycast(rays, count, hits);
+}
+
+namespace {
+// Ray covering the segment between two points
+Ray segment(Position from, Position to) {
+    float dx = static_cast<float>(to.x - from.x);
+    float dy = static_cast<float>(to.y - from.y);
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0f) {
+        return {static_cast<float>(from.x), static_cast<float>(from.y), 1.0f, 0.0f, 0.0f};
+    }
+    return {static_cast<float>(from.x), static_cast<float>(from.y), dx / length, dy / length, length};
+}
+}  // namespace
+
+bool Map::hasLineOfSight(Position from, Position to) const {
+    return !bvh.occluded(segment(from, to));
+}
+
+bool Map::sweepCircle(float x, float y, float radius, float dx, float dy, SweepHit& hit) const {
+    // Only obstacles the swept circle's bounding box reaches
+    float sweepMinX = std::min(x, x + dx) - radius;
+    float sweepMaxX = std::max(x, x + dx) + radius;
+    float sweepMinY = std::min(y, y + dy) - radius;
+    float sweepMaxY = std::max(y, y + dy) + radius;
+
+    // The tree visits obstacles in its own order; ties go to the lowest index, as a scan in order would
+    int found = -1;
+    hit.time = 2.0f;
+    bvh.forEachOverlapping(sweepMinX, sweepMinY, sweepMaxX, sweepMaxY, [&](int index) {
+        const ObstacleShape& shape = shapes[index];
+        SweepHit candidate;
+        bool hits = false;
+        if (shape.type == ObstacleType::CIRCLE) {
+            // The circle grown by our radius, against our center as a point
+            float reach = shape.radius + radius;
+            float mx = x - shape.x;
+            float my = y - shape.y;
+            float distanceSquared = mx * mx + my * my;
+            if (distanceSquared < reach * reach) {
+                float distance = std::sqrt(distanceSquared);
+                hits = distance > 0.0f ? blocksMotion(dx, dy, mx / distance, my / distance, candidate) : false;
+            } else {
+                hits = sweepPointCircle(x, y, dx, dy, shape.x, shape.y, reach, candidate);
+            }
+        } else {
+            // The rectangle grown by our radius, with rounded corners
+            float closestX = std::max(shape.minX, std::min(x, shape.maxX));
+            float closestY = std::max(shape.minY, std::min(y, shape.maxY));
+            float ox = x - closestX;
+            float oy = y - closestY;
+            float distanceSquared = ox * ox + oy * oy;
+            if (distanceSquared < radius * radius) {
+                float normalX = 0.0f;
+                float normalY = 0.0f;
+                if (distanceSquared > 0.0f) {
+                    float distance = std::sqrt(distanceSquared);
+                    normalX = ox / distance;
+                    normalY = oy / distance;
+                } else {
+                    // Center inside the rectangle: push out through the nearest side
+                    float toLeft = x - shape.minX, toRight = shape.maxX - x, toTop = y - shape.minY, toBottom = shape.maxY - y;
+                    float nearest = std::min(std::min(toLeft, toRight), std::min(toTop, toBottom));
+                    if (nearest == toLeft) {
+                        normalX = -1.0f;
+                    } else if (nearest == toRight) {
+                        normalX = 1.0f;
+                    } else if (nearest == toTop) {
+                        normalY = -1.0f;
+                    } else {
+                        normalY = 1.0f;
+                    }
+                }
+                hits = blocksMotion(dx, dy, normalX, normalY, candidate);
+            } else {
+                // Slab test against the grown box, entering through the last slab crossed
+                float enter = -1.0f;
+                float exit = 2.0f;
+                float normalX = 0.0f;
+                float normalY = 0.0f;
+                bool missed = false;
+                const float lows[2] = {shape.minX - radius, shape.minY - radius};
+                const float highs[2] = {shape.maxX + radius, shape.maxY + radius};
+                const float starts[2] = {x, y};
+                const float deltas[2] = {dx, dy};
+                for (int axis = 0; axis < 2 && !missed; ++axis) {
+                    if (deltas[axis] == 0.0f) {
+                        missed = starts[axis] < lows[axis] || starts[axis] > highs[axis];
+                        continue;
+                    }
+                    float near = ((deltas[axis] > 0.0f ? lows[axis] : highs[axis]) - starts[axis]) / deltas[axis];
+                    float far = ((deltas[axis] > 0.0f ? highs[axis] : lows[axis]) - starts[axis]) / deltas[axis];
+                    if (near > enter) {
+                        enter = near;
+                        normalX = axis == 0 ? (deltas[axis] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+                        normalY = axis == 1 ? (deltas[axis] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+                    }
+                    exit = std::min(exit, far);
+                }
+
+                if (!missed && enter <= exit && enter <= 1.0f && exit >= 0.0f) {
+                    float hitX = x + dx * std::max(enter, 0.0f);
+                    float hitY = y + dy * std::max(enter, 0.0f);
+                    bool outsideX = hitX < shape.minX || hitX > shape.maxX;
+                    bool outsideY = hitY < shape.minY || hitY > shape.maxY;
+                    if (outsideX && outsideY) {
+                        // Entered the grown box in a corner square: the real surface there is the rounded corner
+                        float cornerX = hitX < shape.minX ? shape.minX : shape.maxX;
+                        float cornerY = hitY < shape.minY ? shape.minY : shape.maxY;
+                        hits = sweepPointCircle(x, y, dx, dy, cornerX, cornerY, radius, candidate);
+                    } else if (enter >= 0.0f) {
+                        candidate = {enter, normalX, normalY};
+                        hits = true;
+                    }
+                }
+            }
+        }
+
+        if (hits && (candidate.time < hit.time || (candidate.time == hit.time && index < found))) {
+            hit = candidate;
+            found = index;
+        }
+    });
+    return found >= 0;
+}
+
+Position Map::moveCircle(Position from, int radius, Position delta) const {
+    float x = static_cast<float>(from.x);
+    float y = static_cast<float>(from.y);
+    float dx = static_cast<float>(delta.x);
+    float dy = static_cast<float>(delta.y);
+    float r = static_cast<float>(radius);
+
+    for (int contact = 0; contact < MAX_SLIDES && (dx != 0.0f || dy != 0.0f); ++contact) {
+        SweepHit hit;
+        if (!sweepCircle(x, y, r, dx, dy, hit)) {
+            if (contact == 0) {
+                return {from.x + delta.x, from.y + delta.y};  // Free move, nothing to round
+            }
+            x += dx;
+            y += dy;
+            dx = 0.0f;
+            dy = 0.0f;
+            break;
+        }
+
+        // Stop a skin short of the surface, then keep only the remaining motion along it
+        float length = std::sqrt(dx * dx + dy * dy);
+        float travel = std::max(0.0f, hit.time - SKIN / length);
+        x += dx * travel;
+        y += dy * travel;
+        dx *= 1.0f - travel;
+        dy *= 1.0f - travel;
+
+        float into = dx * hit.normalX + dy * hit.normalY;
+        if (into < 0.0f) {
+            dx -= into * hit.normalX;
+            dy -= into * hit.normalY;
+        }
+    }
+
+    // Sliding round a curved surface ends inside the skin, where the nearest pixel can overlap.
+    // Take the closest pixel that doesn't, or stay put.
+    Position rounded = {static_cast<int>(std::lround(x)), static_cast<int>(std::lround(y))};
+    if (!overlapsShape(rounded, radius)) {
+        return rounded;
+    }
+    int left = static_cast<int>(std::floor(x));
+    int top = static_cast<int>(std::floor(y));
+    Position candidates[4] = {{left, top}, {left + 1, top}, {left, top + 1}, {left + 1, top + 1}};
+    std::sort(candidates, candidates + 4, [x, y](Position a, Position b) {
+        return (a.x - x) * (a.x - x) + (a.y - y) * (a.y - y) < (b.x - x) * (b.x - x) + (b.y - y) * (b.y - y);
+    });
+    for (Position candidate : candidates) {
+        if (!overlapsShape(candidate, radius)) return candidate;
+    }
+    return from;
+}
+
+bool Map::overlapsShape(Position position, int radius) const {
+    // Same test as the obstacles' isCollidingWith, exact for whole pixels
+    float x = static_cast<float>(position.x);
+    float y = static_cast<float>(position.y);
+    float r = static_cast<float>(radius);
+    bool overlaps = false;
+    bvh.forEachOverlapping(x - r, y - r, x + r, y + r, [&](int index) {
+        if (overlaps) return;
+        const ObstacleShape& shape = shapes[index];
+        float dx, dy, reach;
+        if (shape.type == ObstacleType::CIRCLE) {
+            dx = x - shape.x;
+            dy = y - shape.y;
+            reach = shape.radius + r;
+        } else {
+            dx = x - std::max(shape.minX, std::min(x, shape.maxX));
+            dy = y - std::max(shape.minY, std::min(y, shape.maxY));
+            reach = r;
+        }
+        overlaps = dx * dx + dy * dy < reach * reach;
+    });
+    return overlaps;
+}
+
+Position Map::getSpawnPoint(uint16_t slot) const {
+    int margin = 50;  // Safe distance from walls and obstacles
+    const Position corners[] = {
+        {margin, margin},                   // Top-left
+        {width - margin, height - margin},  // Bottom-right
+        {width - margin, margin},           // Top-right
+        {margin, height - margin},          // Bottom-left
+    };
+
+    if (slot == 0) {
+        return corners[0];
+    }
+    return corners[1 + (slot - 1) % 3];
 }
 
 const std::vector<std::unique_ptr<Obstacle>>& Map::getObstacles() const {
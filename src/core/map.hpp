@@ -1,34 +1,86 @@
 #ifndef MAP_HPP
 #define MAP_HPP
 
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "core/camera.hpp"
+#include "core/obstacle_bvh.hpp"
 #include "entities/obstacle.hpp"
 #include "entities/position.hpp"
 
+// First contact of a moving circle: fraction of the move travelled and the surface normal there
+struct SweepHit {
+    float time;
+    float normalX;
+    float normalY;
+};
+
 class Map {
    public:
-    Map();
+    static constexpr int MAX_SLIDES = 4;   // Contacts resolved per move; anything left after that is dropped
+    static constexpr float SKIN = 1.0f;    // Gap kept to surfaces so rounding to whole pixels never lands inside
+
+    Map();  // Constants::WORLD_WIDTH by Constants::WORLD_HEIGHT
+    Map(int width, int height);
     ~Map();
 
     void initializeObstacles();
-    void draw() const;
+    void draw(const WorldRect& view) const;  // Only the obstacles the BVH finds in view
+
+    int getWidth() const;
+    int getHeight() const;
 
     // Collision detection methods
     bool isPlayerColliding(Position playerPos, int playerRadius) const;
     bool isBulletColliding(Position bulletPos, int bulletRadius) const;
 
+    // Swept movement: moves a circle by delta, stopping at the first obstacle and sliding along it
+    // for the rest of the distance. Same inputs give the same pixel on every machine, so client
+    // prediction and the authority agree.
+    Position moveCircle(Position from, int radius, Position delta) const;
+    // A circle already touching an obstacle only collides with it when moving further in
+    bool sweepCircle(float x, float y, float radius, float dx, float dy, SweepHit& hit) const;
+
+    // Ray queries over the obstacle BVH; RayHit::obstacle indexes getObstacles()
+    bool raycast(const Ray& ray, RayHit& hit) const;
+    void raycast(const Ray* rays, size_t count, RayHit* hits) const;
+    // Clear when no obstacle lies on the segment between the two points
+    bool hasLineOfSight(Position from, Position to) const;
+    // Calls fn(index into getObstacles()) for every obstacle whose bounding box overlaps the area
+    template <typename Fn>
+    void forEachObstacleIn(const WorldRect& area, Fn&& fn) const;
+
+    // Spawn corner for a player's owner slot: slot 0 (the host) top-left, everyone else shares the other three
+    Position getSpawnPoint(uint16_t slot) const;
+
     // Obstacle management
     void addObstacle(std::unique_ptr<Obstacle> obstacle);
+    // Rebuilds the BVH once for the whole batch instead of once per obstacle
+    void addObstacles(std::vector<std::unique_ptr<Obstacle>> batch);
     void clearObstacles();
+    // Trades obstacles and BVH with a map of the same size, so one built elsewhere goes live in O(1)
+    void swapObstacles(Map& other);
 
     const std::vector<std::unique_ptr<Obstacle>>& getObstacles() const;
 
    private:
+    void appendShape(const Obstacle& obstacle);
+    bool overlapsShape(Position position, int radius) const;
+
+    int width, height;
     std::vector<std::unique_ptr<Obstacle>> obstacles;
+    std::vector<ObstacleShape> shapes;
+    ObstacleBvh bvh;
 
     void createDefaultObstacles();
 };
 
+template <typename Fn>
+void Map::forEachObstacleIn(const WorldRect& area, Fn&& fn) const {
+    bvh.forEachOverlapping(area.minX, area.minY, area.maxX, area.maxY, std::forward<Fn>(fn));
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,602 @@
+#include "core/match.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "entities/player.hpp"
+#include "network/snapshot.hpp"
+
+Match::Match(uint32_t matchId, const Map& gameMap, const NavigationGrid& navigationGrid, uint32_t rate)
+    : id(matchId),
+      map(gameMap),
+      tickRate(rate),
+      tickCount(0),
+      registry(0),
+      simulation(registry, gameMap),
+      tickDt(0.0f),
+      botFill(0),
+      navigation(navigationGrid),
+      spectatorDelay(0),
+      clientBudget(0),
+      loadLevel(LoadLevel::NORMAL),
+      resumeWindow(0) {
+    buildGraph();
+}
+
+void Match::buildGraph() {
+    TaskGraph::TaskId simulate = graph.add("simulation", [this](JobSystem& jobs) { simulation.tick(jobs, tickDt); });
+    TaskGraph::TaskId encode = graph.add("state encoding", [this](JobSystem& jobs) { encodeState(jobs); }, {simulate});
+    TaskGraph::TaskId choose = graph.add("recipients", [this](JobSystem& jobs) { chooseRecipients(jobs); }, {encode});
+    graph.add("state queueing", [this](JobSystem&) { queueState(); }, {choose});
+}
+
+uint32_t Match::getId() const {
+    return id;
+}
+
+size_t Match::getPlayerCount() const {
+    return members.size();
+}
+
+size_t Match::getBotCount() const {
+    return bots ? bots->getBotCount() : 0;
+}
+
+uint64_t Match::getTickCount() const {
+    return tickCount;
+}
+
+const Map& Match::getMap() const {
+    return map;
+}
+
+void Match::setBotFill(size_t players) {
+    botFill = players;
+    balanceBots();
+}
+
+void Match::setSpectatorDelay(uint32_t delayTicks) {
+    spectatorDelay = delayTicks;
+    spectatorFrames.clear();
+}
+
+void Match::watch(uint16_t peerIndex) {
+    if (std::find(spectators.begin(), spectators.end(), peerIndex) == spectators.end()) {
+        spectators.push_back(peerIndex);
+    }
+}
+
+void Match::unwatch(uint16_t peerIndex) {
+    spectators.erase(std::remove(spectators.begin(), spectators.end(), peerIndex), spectators.end());
+    if (spectators.empty()) {
+        spectatorFrames.clear();
+    }
+}
+
+size_t Match::getSpectatorCount() const {
+    return spectators.size();
+}
+
+void Match::setResumeWindow(uint32_t ticks) {
+    resumeWindow = ticks;
+}
+
+size_t Match::getSuspendedCount() const {
+    return suspended.size();
+}
+
+void Match::setClientBudget(size_t bytesPerTick) {
+    clientBudget = bytesPerTick;
+}
+
+void Match::setLoadLevel(LoadLevel level) {
+    if (level == loadLevel) return;
+    loadLevel = level;
+    simulation.setBroadphaseInterval(level >= LoadLevel::COARSE_BROADPHASE ? 2 : 1);
+}
+
+LoadLevel Match::getLoadLevel() const {
+    return loadLevel;
+}
+
+void Match::join(uint16_t peerIndex, uint32_t session, uint8_t version) {
+    if (std::find(members.begin(), members.end(), peerIndex) != members.end()) {
+        return;
+    }
+    uint16_t owner = Protocol::ownerForPeer(peerIndex);
+
+    // A suspended player of another session still holding this slot can't keep it
+    auto holder = std::find_if(suspended.begin(), suspended.end(), [&](const Suspended& entry) { return entry.owner == owner; });
+    if (holder != suspended.end() && (session == 0 || holder->session != session)) {
+        uint16_t held = holder->owner;
+        suspended.erase(holder);
+        removePlayer(held, NO_PEER);
+    }
+
+    members.push_back(peerIndex);
+    memberSessions.push_back(session);
+    memberPriorities.emplace_back();
+
+    auto resumed = std::find_if(suspended.begin(), suspended.end(),
+                                [&](const Suspended& entry) { return session != 0 && entry.session == session; });
+    if (resumed != suspended.end()) {
+        Entity entity = registry.findByNetworkId(resumed->owner);
+        if (resumed->owner != owner) {
+            registry.setNetworkId(entity, NetworkId{owner});
+
+            // Everyone else knew the player under its old slot; under the new one it needs its health sent again
+            uint8_t notice[Protocol::PlayerLeftMessage::SIZE];
+            Protocol::PlayerLeftMessage::write(notice, resumed->owner);
+            sendToAllExcept(peerIndex, Protocol::MessageType::PLAYER_LEFT, notice, sizeof(notice));
+            registry.getHealth(entity).changed = true;
+        }
+        suspended.erase(resumed);
+    } else {
+        Entity entity = Player::spawn(registry, NetworkId{owner}, PLAYER_SPEED, RED, PLAYER_RADIUS, PlayerShape::CIRCLE);
+        Player(registry, entity).setPosition(map.getSpawnPoint(owner));
+    }
+    commandQueueFor(owner).clear();
+
+    uint8_t welcome[Protocol::WelcomeMessage::SIZE];
+    Protocol::WelcomeMessage::write(welcome, owner, tickRate, session, version);
+    sendTo(peerIndex, Protocol::MessageType::WELCOME, welcome, sizeof(welcome));
+
+    // Bots make room first, so the snapshot doesn't show one that is already gone.
+    // Health is only sent when it changes, so the newcomer starts from a snapshot instead.
+    balanceBots();
+    startSnapshot(peerIndex);
+}
+
+void Match::leave(uint16_t peerIndex) {
+    auto member = std::find(members.begin(), members.end(), peerIndex);
+    if (member == members.end()) {
+        return;
+    }
+    size_t index = static_cast<size_t>(member - members.begin());
+    uint32_t session = memberSessions[index];
+    members.erase(member);
+    memberSessions.erase(memberSessions.begin() + static_cast<std::ptrdiff_t>(index));
+    memberPriorities.erase(memberPriorities.begin() + static_cast<std::ptrdiff_t>(index));
+    snapshotStreams.erase(std::remove_if(snapshotStreams.begin(), snapshotStreams.end(),
+                                         [&](const SnapshotStream& stream) { return stream.peer == peerIndex; }),
+                          snapshotStreams.end());
+
+    uint16_t owner = Protocol::ownerForPeer(peerIndex);
+    if (resumeWindow > 0 && session != 0) {
+        // Nothing drives the player until its session comes back
+        commandQueueFor(owner).clear();
+        suspended.push_back({owner, session, tickCount + resumeWindow});
+    } else {
+        removePlayer(owner, peerIndex);
+    }
+    balanceBots();
+}
+
+void Match::expireSuspended() {
+    // Kept in the order they left, so the oldest run out first
+    while (!suspended.empty() && suspended.front().expiresAt <= tickCount) {
+        uint16_t owner = suspended.front().owner;
+        suspended.erase(suspended.begin());
+        removePlayer(owner, NO_PEER);
+    }
+}
+
+void Match::removePlayer(uint16_t owner, uint16_t excludedPeer) {
+    registry.despawn(registry.findByNetworkId(owner));
+
+    uint8_t notice[Protocol::PlayerLeftMessage::SIZE];
+    Protocol::PlayerLeftMessage::write(notice, owner);
+    sendToAllExcept(excludedPeer, Protocol::MessageType::PLAYER_LEFT, notice, sizeof(notice));
+}
+
+void Match::balanceBots() {
+    size_t wanted = members.empty() || botFill <= members.size() ? 0 : botFill - members.size();
+
+    // Newest bots leave first
+    while (getBotCount() > wanted) {
+        uint16_t owner = bots->getLastOwner();
+        bots->remove(owner);
+        removePlayer(owner, NO_PEER);
+    }
+
+    if (wanted == 0) {
+        // Its flow fields go with it
+        bots.reset();
+        return;
+    }
+    if (!bots) {
+        bots = std::make_unique<BotDirector>(map, navigation);
+    }
+    while (getBotCount() < wanted) {
+        uint16_t owner = Protocol::OWNER_BOT_FIRST;
+        while (registry.findByNetworkId(owner) != NULL_ENTITY) {
+            owner++;
+        }
+        bots->add(owner);
+        Entity entity = Player::spawn(registry, NetworkId{owner}, PLAYER_SPEED, RED, PLAYER_RADIUS, PlayerShape::CIRCLE);
+        Player(registry, entity).setPosition(map.getSpawnPoint(owner));
+    }
+}
+
+void Match::receive(uint16_t peerIndex, uint8_t channel, const uint8_t* data, size_t length) {
+    Protocol::MessageType type;
+    if (!Protocol::identify(channel, data, length, type)) {
+        return;
+    }
+
+    // Members only send input and resets; state is ours to decide
+    if (type == Protocol::MessageType::INPUT) {
+        uint32_t newestTick;
+        size_t count;
+        Protocol::InputMessage::read(data, length, newestTick, count);
+        commandQueueFor(Protocol::ownerForPeer(peerIndex)).receive(newestTick, Protocol::InputMessage::element(data, 0), count);
+    } else if (type == Protocol::MessageType::RESET) {
+        resetPlayers();
+        sendToAllExcept(peerIndex, type, data, length);
+    }
+}
+
+void Match::tick(JobSystem& jobs, float dt) {
+    tickCount++;
+    expireSuspended();
+    if (members.empty()) {
+        return;
+    }
+
+    // Bots queue their commands first; after that every player is driven the same way, one command per tick
+    if (bots) {
+        bots->think(registry);
+    }
+    // Acknowledgments are taken here too: the encoding stage runs on workers and must not grow commandQueues
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    std::vector<PlayerInput>& inputs = registry.getInputs();
+    stateAcks.resize(networkIds.size());
+    for (size_t i = 0; i < networkIds.size(); ++i) {
+        CommandQueue& commands = commandQueueFor(networkIds[i].peer);
+        inputs[i] = commands.next();
+        stateAcks[i] = commands.getLastApplied();
+    }
+
+    tickDt = dt;
+    graph.run(jobs);
+    streamSnapshots();
+    if (!spectators.empty()) {
+        sendSpectatorFrame();
+    }
+}
+
+std::vector<OutboundMessage>& Match::getOutbox() {
+    return outbox;
+}
+
+void Match::encodeState(JobSystem& jobs) {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+
+    // Each player's position and bullets are encoded once, into messages only that player's job
+    // touches; who gets them is decided per member in the next stage
+    stateMessages.resize(entities.size() * 2);
+    jobs.parallelFor(entities.size(), PLAYERS_PER_JOB, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Player player(registry, entities[i]);
+            uint16_t owner = networkIds[i].peer;
+
+            OutboundMessage& position = stateMessages[i * 2];
+            position.channel = Protocol::routeOf(Protocol::MessageType::POSITION).channel;
+            position.flags = Protocol::packetFlags(Protocol::MessageType::POSITION);
+            position.payload.resize(Protocol::PositionMessage::SIZE);
+            position.recipients.clear();
+            Position at = player.getPosition();
+            Protocol::PositionMessage::write(position.payload.data(), owner, static_cast<float>(at.x), static_cast<float>(at.y),
+                                             stateAcks[i]);
+
+            using Bullets = Protocol::BulletsMessage;
+            const std::vector<Bullet>& bullets = player.getBullets();
+            size_t bulletCount = std::min(bullets.size(), Bullets::MAX_COUNT);
+            OutboundMessage& shots = stateMessages[i * 2 + 1];
+            shots.channel = Protocol::routeOf(Protocol::MessageType::BULLETS).channel;
+            shots.flags = Protocol::packetFlags(Protocol::MessageType::BULLETS);
+            shots.payload.resize(Bullets::sizeFor(bulletCount));
+            shots.recipients.clear();
+            Bullets::write(shots.payload.data(), owner, player.getShotCount());
+            for (size_t b = 0; b < bulletCount; ++b) {
+                bullets[b].serialize(Bullets::element(shots.payload.data(), b));
+            }
+        }
+    });
+}
+
+void Match::chooseRecipients(JobSystem& jobs) {
+    // Shedding load: on odd ticks a player only goes to the members near it
+    bool nearOnly = loadLevel >= LoadLevel::DISTANT_HALF_RATE && tickCount % 2 == 1;
+    bool budgeted = nearOnly || clientBudget > 0;
+    if (budgeted) {
+        memberPositions.clear();
+        for (uint16_t member : members) {
+            memberPositions.push_back(Player(registry, registry.findByNetworkId(Protocol::ownerForPeer(member))).getPosition());
+        }
+        remapPriorities();
+    }
+
+    // Each member's choice only reads the encoded state and writes that member's own lists
+    memberSends.resize(members.size());
+    memberOrders.resize(members.size());
+    jobs.parallelFor(members.size(), MEMBERS_PER_JOB, [&](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; ++m) {
+            if (budgeted) {
+                choosePlayers(m, nearOnly);
+            } else {
+                sendAllPlayers(m);
+            }
+        }
+    });
+}
+
+void Match::queueState() {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    for (size_t i = 0; i < entities.size(); ++i) {
+        Player player(registry, entities[i]);
+        if (player.hasHealthChanged()) {
+            uint8_t health[Protocol::HealthMessage::SIZE];
+            Protocol::HealthMessage::write(health, networkIds[i].peer, player.getHealth());
+            sendToAllExcept(NO_PEER, Protocol::MessageType::HEALTH, health, sizeof(health));
+            player.clearHealthChangeFlag();
+        }
+    }
+
+    // Merged in member order, so every message lists its recipients the same way whoever chose them
+    for (size_t m = 0; m < members.size(); ++m) {
+        for (uint32_t message : memberSends[m]) {
+            stateMessages[message].recipients.push_back(members[m]);
+        }
+    }
+    // Handed over rather than copied; encodeState() fills them in again next tick
+    for (OutboundMessage& message : stateMessages) {
+        if (!message.recipients.empty()) outbox.push_back(std::move(message));
+    }
+}
+
+void Match::sendAllPlayers(size_t memberIndex) {
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    uint16_t self = Protocol::ownerForPeer(members[memberIndex]);
+    std::vector<uint32_t>& sends = memberSends[memberIndex];
+    sends.clear();
+    for (size_t i = 0; i < networkIds.size(); ++i) {
+        sends.push_back(static_cast<uint32_t>(i * 2));
+        // The owner predicts its own bullets
+        if (networkIds[i].peer != self) sends.push_back(static_cast<uint32_t>(i * 2 + 1));
+    }
+}
+
+void Match::choosePlayers(size_t memberIndex, bool nearOnly) {
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    const std::vector<Transform>& transforms = registry.getTransforms();
+    uint16_t self = Protocol::ownerForPeer(members[memberIndex]);
+    Position from = memberPositions[memberIndex];
+    std::vector<float>& priorities = memberPriorities[memberIndex];
+    std::vector<uint32_t>& sendOrder = memberOrders[memberIndex];
+    std::vector<uint32_t>& sends = memberSends[memberIndex];
+
+    size_t budget = clientBudget > 0 ? clientBudget : SIZE_MAX;
+    sendOrder.clear();
+    sends.clear();
+    for (size_t i = 0; i < networkIds.size(); ++i) {
+        if (networkIds[i].peer == self) {
+            // Prediction is reconciled against every acknowledgment
+            sends.push_back(static_cast<uint32_t>(i * 2));
+            budget -= std::min(budget, stateMessages[i * 2].payload.size() + SEND_OVERHEAD);
+            continue;
+        }
+        float dx = static_cast<float>(transforms[i].position.x - from.x);
+        float dy = static_cast<float>(transforms[i].position.y - from.y);
+        float distance = std::sqrt(dx * dx + dy * dy);
+        if (nearOnly && distance > NEAR_DISTANCE) continue;
+
+        // 1 next to the member, a half a screen away, still growing far off
+        priorities[i] += NEAR_DISTANCE / (NEAR_DISTANCE + distance);
+        sendOrder.push_back(static_cast<uint32_t>(i));
+    }
+    // Only this member's own stream is touched, so members can be chosen for in parallel
+    if (clientBudget > 0) {
+        for (SnapshotStream& stream : snapshotStreams) {
+            if (stream.peer == members[memberIndex]) budget -= std::min(budget, chargeSnapshot(stream, budget));
+        }
+    }
+
+    // A smaller player further down may still fit where a larger one didn't. The first pick always
+    // goes, so a player with more bullets than the whole budget holds still arrives, over budget.
+    std::stable_sort(sendOrder.begin(), sendOrder.end(), [&](uint32_t a, uint32_t b) { return priorities[a] > priorities[b]; });
+    bool first = true;
+    for (uint32_t i : sendOrder) {
+        size_t cost = stateMessages[i * 2].payload.size() + stateMessages[i * 2 + 1].payload.size() + 2 * SEND_OVERHEAD;
+        if (cost > budget && !first) continue;
+        first = false;
+        budget -= std::min(budget, cost);
+        sends.push_back(i * 2);
+        sends.push_back(i * 2 + 1);
+        priorities[i] = 0.0f;
+    }
+}
+
+size_t Match::chargeSnapshot(SnapshotStream& stream, size_t budget) {
+    size_t count = snapshotChunkCount(stream.encoded.size());
+    size_t bytes = 0;
+    stream.allowance = 0;
+    for (size_t chunk = stream.nextChunk; chunk < count && stream.allowance < Protocol::SNAPSHOT_CHUNKS_PER_TICK; ++chunk) {
+        size_t begin = chunk * Protocol::SNAPSHOT_CHUNK_PAYLOAD;
+        size_t length = std::min(Protocol::SNAPSHOT_CHUNK_PAYLOAD, stream.encoded.size() - begin);
+        size_t cost = Protocol::SnapshotMessage::sizeFor(length) + SEND_OVERHEAD;
+        bool starved = stream.allowance == 0 && stream.ticksWaiting + 1 >= SNAPSHOT_STARVE_TICKS;
+        if (bytes + cost > budget && !starved) break;
+        bytes += cost;
+        stream.allowance++;
+    }
+    return bytes;
+}
+
+void Match::remapPriorities() {
+    const std::vector<Entity>& entities = registry.getEntities();
+    if (entities != priorityEntities) {
+        // Players came or went: carry every priority over to the player's new dense index
+        priorityIndex.clear();
+        for (size_t i = 0; i < priorityEntities.size(); ++i) {
+            priorityIndex.emplace(priorityEntities[i], static_cast<uint32_t>(i));
+        }
+        std::vector<float> carried(entities.size());
+        for (std::vector<float>& priorities : memberPriorities) {
+            for (size_t i = 0; i < entities.size(); ++i) {
+                auto before = priorityIndex.find(entities[i]);
+                carried[i] = before != priorityIndex.end() && before->second < priorities.size() ? priorities[before->second] : 0.0f;
+            }
+            priorities.swap(carried);
+            carried.resize(entities.size());
+        }
+        priorityEntities = entities;
+    }
+    // A member who just joined starts with nothing owed
+    for (std::vector<float>& priorities : memberPriorities) {
+        priorities.resize(entities.size(), 0.0f);
+    }
+}
+
+void Match::startSnapshot(uint16_t peerIndex) {
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    snapshotAcks.clear();
+    for (NetworkId networkId : networkIds) {
+        snapshotAcks.push_back(commandQueueFor(networkId.peer).getLastApplied());
+    }
+
+    Snapshot snapshot;
+    snapshot.tick = static_cast<uint32_t>(tickCount);
+    snapshot.worldWidth = map.getWidth();
+    snapshot.worldHeight = map.getHeight();
+    captureSnapshot(registry, snapshotAcks, snapshot);
+
+    SnapshotStream stream{peerIndex, snapshot.tick, 0, 0, 0, {}};
+    encodeSnapshot(snapshot, stream.encoded);
+    snapshotStreams.push_back(std::move(stream));
+}
+
+void Match::streamSnapshots() {
+    // A few chunks per client per tick on their own channel, so a big snapshot never crowds out
+    // the live state or holds it back behind retransmits. Under a budget, as many as choosePlayers() let through.
+    for (SnapshotStream& stream : snapshotStreams) {
+        size_t count = snapshotChunkCount(stream.encoded.size());
+        size_t allowed = clientBudget > 0 ? stream.allowance : Protocol::SNAPSHOT_CHUNKS_PER_TICK;
+        for (size_t sent = 0; sent < allowed && stream.nextChunk < count; ++sent) {
+            writeSnapshotChunk(stream.encoded, stream.tick, stream.nextChunk++, snapshotChunk);
+            sendTo(stream.peer, Protocol::MessageType::SNAPSHOT, snapshotChunk.data(), snapshotChunk.size());
+        }
+        stream.ticksWaiting = allowed > 0 ? 0 : static_cast<uint16_t>(stream.ticksWaiting + 1);
+    }
+    snapshotStreams.erase(std::remove_if(snapshotStreams.begin(), snapshotStreams.end(),
+                                         [](const SnapshotStream& stream) {
+                                             return stream.nextChunk >= snapshotChunkCount(stream.encoded.size());
+                                         }),
+                          snapshotStreams.end());
+}
+
+void Match::sendSpectatorFrame() {
+    if (spectatorFrames.empty()) {
+        spectatorFrames.resize(spectatorDelay + 1);
+    }
+
+    // Slots are reused, so recording a frame stops allocating once every slot has held one
+    std::vector<uint8_t>& current = spectatorFrames[tickCount % spectatorFrames.size()];
+    // Shedding load: odd ticks aren't recorded, so their frames fail the tick check below and are skipped
+    if (loadLevel < LoadLevel::SPECTATORS_HALF_RATE || tickCount % 2 == 0) {
+        encodeSpectatorFrame(current);
+    }
+
+    // The slot after this tick's holds the frame from spectatorDelay ticks ago, unless watching started since
+    const std::vector<uint8_t>& delayed = spectatorFrames[(tickCount + 1) % spectatorFrames.size()];
+    uint32_t delayedTick = static_cast<uint32_t>(tickCount - spectatorDelay);
+    if (delayed.size() < Protocol::SpectateMessage::SIZE || Protocol::SpectateMessage::get<0>(delayed.data()) != delayedTick) {
+        return;
+    }
+
+    OutboundMessage message;
+    message.channel = Protocol::routeOf(Protocol::MessageType::SPECTATE).channel;
+    message.flags = Protocol::packetFlags(Protocol::MessageType::SPECTATE);
+    message.payload = delayed;
+    message.recipients = spectators;
+    outbox.push_back(std::move(message));
+}
+
+void Match::encodeSpectatorFrame(std::vector<uint8_t>& frame) {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+
+    size_t size = Protocol::SpectateMessage::SIZE + entities.size() * Protocol::SpectatePlayer::SIZE;
+    for (Entity entity : entities) {
+        size += Player(registry, entity).getBullets().size() * Bullet::SERIALIZED_SIZE;
+    }
+    frame.resize(size);
+
+    uint8_t* out = frame.data();
+    Protocol::SpectateMessage::write(out, static_cast<uint32_t>(tickCount), static_cast<uint16_t>(entities.size()));
+    out += Protocol::SpectateMessage::SIZE;
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        Player player(registry, entities[i]);
+        Position at = player.getPosition();
+        const std::vector<Bullet>& bullets = player.getBullets();
+
+        Protocol::SpectatePlayer::write(out, networkIds[i].peer, static_cast<float>(at.x), static_cast<float>(at.y),
+                                        player.getHealth(), static_cast<uint16_t>(bullets.size()));
+        out += Protocol::SpectatePlayer::SIZE;
+        for (const Bullet& bullet : bullets) {
+            bullet.serialize(out);
+            out += Bullet::SERIALIZED_SIZE;
+        }
+    }
+}
+
+void Match::resetPlayers() {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    for (size_t i = 0; i < entities.size(); ++i) {
+        Player player(registry, entities[i]);
+        player.setHealth(100);
+        player.clearBullets();
+        player.setPosition(map.getSpawnPoint(networkIds[i].peer));
+    }
+    simulation.invalidateBroadphase();
+}
+
+CommandQueue& Match::commandQueueFor(uint16_t owner) {
+    CommandQueue* botCommands = bots && Protocol::isBotOwner(owner) ? bots->commandQueueFor(owner) : nullptr;
+    if (botCommands) {
+        return *botCommands;
+    }
+    if (owner >= commandQueues.size()) {
+        commandQueues.resize(owner + 1);
+    }
+    return commandQueues[owner];
+}
+
+void Match::sendToAllExcept(uint16_t excludedPeer, Protocol::MessageType type, const uint8_t* data, size_t length) {
+    OutboundMessage message;
+    message.channel = Protocol::routeOf(type).channel;
+    message.flags = Protocol::packetFlags(type);
+    message.payload.assign(data, data + length);
+    for (uint16_t member : members) {
+        if (member != excludedPeer) message.recipients.push_back(member);
+    }
+    outbox.push_back(std::move(message));
+}
+
+void Match::sendTo(uint16_t peerIndex, Protocol::MessageType type, const uint8_t* data, size_t length) {
+    OutboundMessage message;
+    message.channel = Protocol::routeOf(type).channel;
+    message.flags = Protocol::packetFlags(type);
+    message.payload.assign(data, data + length);
+    message.recipients.push_back(peerIndex);
+    outbox.push_back(std::move(message));
+}
+
@@ -0,0 +1,178 @@
+#ifndef MATCH_HPP
+#define MATCH_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "core/bots.hpp"
+#include "core/job_system.hpp"
+#include "core/map.hpp"
+#include "core/navigation.hpp"
+#include "core/registry.hpp"
+#include "core/simulation.hpp"
+#include "core/tick_watchdog.hpp"
+#include "network/input_commands.hpp"
+#include "network/protocol.hpp"
+
+// A message a match wants sent; one payload shared by every recipient
+struct OutboundMessage {
+    uint8_t channel;
+    uint32_t flags;  // ENet packet flags
+    std::vector<uint8_t> payload;
+    std::vector<uint16_t> recipients;  // ENet peer indices
+};
+
+// One independent game hosted by the match server. Headless: no window, no sockets.
+// The server thread that owns the match feeds it connection events and messages and
+// collects what it wants to send from the outbox after every tick.
+// The match is the authority: members send input commands, every tick it simulates all players
+// and sends their state back. An empty match only holds its id and a few empty containers.
+class Match {
+   public:
+    static constexpr int PLAYER_RADIUS = 10;
+
+    // navigation is map's grid for PLAYER_RADIUS, built once and shared by every match on the map
+    Match(uint32_t id, const Map& map, const NavigationGrid& navigation, uint32_t tickRate);
+
+    uint32_t getId() const;
+    size_t getPlayerCount() const;  // Connected people, not counting bots
+    size_t getBotCount() const;
+    uint64_t getTickCount() const;
+    const Map& getMap() const;
+
+    // While anyone is connected, bots fill the match up to this many players and leave again as
+    // people join. 0 (the default) turns bots off.
+    void setBotFill(size_t players);
+
+    // Spectators watch without playing. Every tick the match encodes one frame of the whole match
+    // and sends the frame from delayTicks ago to all of them as a single message, so the cost of a
+    // spectator is one more recipient. Frames are only recorded while someone watches, so a new
+    // spectator's stream starts once the delay has passed.
+    void setSpectatorDelay(uint32_t delayTicks);
+    void watch(uint16_t peerIndex);
+    void unwatch(uint16_t peerIndex);
+    size_t getSpectatorCount() const;
+
+    // A member who joins gets a welcome carrying its session, then the whole match as a snapshot,
+    // a few datagram-sized chunks per tick behind the live messages (see network/snapshot.hpp).
+    // Joining with the session of a player who left within the resume window takes that player
+    // back, under the new peer's slot, with everything it had. 0 never resumes anything. The
+    // welcome tells the member the protocol version the server agreed to speak with it.
+    void join(uint16_t peerIndex, uint32_t session, uint8_t version = Protocol::PROTOCOL_VERSION);
+    void leave(uint16_t peerIndex);
+
+    // How long a player whose member left stays in the match, standing still, waiting to be
+    // resumed. 0 (the default) removes players as soon as they leave.
+    void setResumeWindow(uint32_t ticks);
+    size_t getSuspendedCount() const;
+
+    // Caps the bytes of player state each member is sent per tick. Every tick each player's priority
+    // for a member grows by how relevant it is there (the nearer, the faster) and the member gets the
+    // players with the highest priority that still fit, each of which starts over from zero. Far
+    // players arrive less often but none starve. A member's own player is always sent and health
+    // changes are reliable, so neither waits for the budget. Snapshot chunks come out of what the
+    // member's own player leaves, at least one every SNAPSHOT_STARVE_TICKS so the snapshot always
+    // completes. 0 (the default) sends everything.
+    void setClientBudget(size_t bytesPerTick);
+
+    // Set by the shard's watchdog when its ticks run over budget (see LoadLevel)
+    void setLoadLevel(LoadLevel level);
+    LoadLevel getLoadLevel() const;
+
+    void receive(uint16_t peerIndex, uint8_t channel, const uint8_t* data, size_t length);
+    // Simulation, encoding every player's state and choosing each member's share of it run as a
+    // task graph, the last two spread across the pool's workers; the outbox comes out the same
+    // for any worker count.
+    void tick(JobSystem& jobs, float dt);
+
+    // Messages produced since the outbox was last drained
+    std::vector<OutboundMessage>& getOutbox();
+
+   private:
+    static constexpr uint16_t NO_PEER = 0xFFFF;
+
+    struct Suspended {
+        uint16_t owner;
+        uint32_t session;
+        uint64_t expiresAt;  // Tick
+    };
+
+    struct SnapshotStream {
+        uint16_t peer;
+        uint32_t tick;
+        uint16_t nextChunk;
+        uint16_t allowance;     // Chunks the member's budget has room for this tick
+        uint16_t ticksWaiting;  // Since the last chunk went
+        std::vector<uint8_t> encoded;
+    };
+    static constexpr int PLAYER_SPEED = 5;
+    static constexpr int NEAR_DISTANCE = 800;  // About a screen: anyone farther is off that member's view
+    static constexpr size_t SEND_OVERHEAD = 8;  // Stand-in for ENet's header on every message in a datagram
+    static constexpr size_t PLAYERS_PER_JOB = 8;
+    static constexpr size_t MEMBERS_PER_JOB = 2;
+    static constexpr uint16_t SNAPSHOT_STARVE_TICKS = 8;  // A budget too small for any chunk still lets one through this often
+
+    void sendToAllExcept(uint16_t excludedPeer, Protocol::MessageType type, const uint8_t* data, size_t length);
+    void sendTo(uint16_t peerIndex, Protocol::MessageType type, const uint8_t* data, size_t length);
+    void buildGraph();
+    void encodeState(JobSystem& jobs);
+    void chooseRecipients(JobSystem& jobs);
+    void queueState();
+    void choosePlayers(size_t memberIndex, bool nearOnly);
+    size_t chargeSnapshot(SnapshotStream& stream, size_t budget);
+    void sendAllPlayers(size_t memberIndex);
+    void remapPriorities();
+    void sendSpectatorFrame();
+    void encodeSpectatorFrame(std::vector<uint8_t>& frame);
+    void startSnapshot(uint16_t peerIndex);
+    void streamSnapshots();
+    void expireSuspended();
+    void resetPlayers();
+    void balanceBots();
+    void removePlayer(uint16_t owner, uint16_t excludedPeer);
+    CommandQueue& commandQueueFor(uint16_t owner);
+
+    uint32_t id;
+    const Map& map;
+    uint32_t tickRate;
+    uint64_t tickCount;
+
+    Registry registry;
+    Simulation simulation;
+    TaskGraph graph;
+    float tickDt;
+    std::vector<uint16_t> members;            // ENet peer indices, in join order
+    std::vector<uint32_t> memberSessions;     // Parallel to members
+    std::vector<Position> memberPositions;    // Parallel to members, refreshed while state is budgeted or throttled
+    std::vector<CommandQueue> commandQueues;  // Indexed by owner slot, people only
+
+    size_t botFill;
+    const NavigationGrid& navigation;
+    std::unique_ptr<BotDirector> bots;  // Only while the match has bots
+
+    std::vector<uint16_t> spectators;  // ENet peer indices
+    uint32_t spectatorDelay;
+    std::vector<std::vector<uint8_t>> spectatorFrames;  // Ring of the last spectatorDelay + 1 ticks, empty while unwatched
+
+    size_t clientBudget;
+    std::vector<std::vector<float>> memberPriorities;    // Parallel to members, each indexed like the registry's dense arrays
+    std::vector<Entity> priorityEntities;                // The dense order the priorities are kept in
+    std::unordered_map<Entity, uint32_t> priorityIndex;  // Scratch: each of priorityEntities to its index
+    std::vector<OutboundMessage> stateMessages;          // Scratch for the tick: position and bullets per player
+    std::vector<uint32_t> stateAcks;                     // Scratch: each player's newest command applied, by dense index
+    std::vector<std::vector<uint32_t>> memberSends;      // Scratch, parallel to members: stateMessages chosen this tick
+    std::vector<std::vector<uint32_t>> memberOrders;     // Scratch for choosePlayers(), parallel to members
+
+    LoadLevel loadLevel;
+    uint32_t resumeWindow;
+    std::vector<Suspended> suspended;
+    std::vector<SnapshotStream> snapshotStreams;  // One per member still receiving its snapshot
+    std::vector<uint32_t> snapshotAcks;           // Scratch for startSnapshot()
+    std::vector<uint8_t> snapshotChunk;           // Scratch for streamSnapshots()
+
+    std::vector<OutboundMessage> outbox;
+};
+
+#endif
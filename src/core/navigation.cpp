@@ -0,0 +1,198 @@
+#include "core/navigation.hpp"
+
+#include <cstdlib>
+
+namespace {
+// Neighbour offsets, orthogonal first
+constexpr int NEIGHBOUR_X[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+constexpr int NEIGHBOUR_Y[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+// Agents aiming at a cell center stop correcting an axis once they are this close to it
+constexpr int STEERING_DEADZONE = 2;
+
+int sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+// A diagonal step from (x, y) by neighbour i may not cut an obstacle's corner: both cells beside it must be open
+bool cutsCorner(const NavigationGrid& grid, int x, int y, int i) {
+    if (i < 4) return false;
+    int width = grid.getWidth();
+    return !grid.isWalkable(static_cast<uint32_t>(y * width + x + NEIGHBOUR_X[i])) ||
+           !grid.isWalkable(static_cast<uint32_t>((y + NEIGHBOUR_Y[i]) * width + x));
+}
+}  // namespace
+
+NavigationGrid::NavigationGrid(const Map& map, int agentRadius, int size) : cellSize(size > 0 ? size : DEFAULT_CELL_SIZE) {
+    width = (map.getWidth() + cellSize - 1) / cellSize;
+    height = (map.getHeight() + cellSize - 1) / cellSize;
+    walkable.assign(static_cast<size_t>(width) * height, 0);
+
+    // Players are also kept a radius inside the world's edges
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            Position center = centerOf(static_cast<uint32_t>(y * width + x));
+            bool inside = center.x >= agentRadius && center.x <= map.getWidth() - agentRadius && center.y >= agentRadius &&
+                          center.y <= map.getHeight() - agentRadius;
+            walkable[y * width + x] = inside && !map.isPlayerColliding(center, agentRadius);
+        }
+    }
+}
+
+int NavigationGrid::getWidth() const {
+    return width;
+}
+
+int NavigationGrid::getHeight() const {
+    return height;
+}
+
+int NavigationGrid::getCellSize() const {
+    return cellSize;
+}
+
+size_t NavigationGrid::getCellCount() const {
+    return walkable.size();
+}
+
+uint32_t NavigationGrid::cellAt(Position position) const {
+    if (position.x < 0 || position.y < 0) return NO_CELL;
+    int x = position.x / cellSize;
+    int y = position.y / cellSize;
+    if (x >= width || y >= height) return NO_CELL;
+    return static_cast<uint32_t>(y * width + x);
+}
+
+Position NavigationGrid::centerOf(uint32_t cell) const {
+    int x = static_cast<int>(cell % width);
+    int y = static_cast<int>(cell / width);
+    return {x * cellSize + cellSize / 2, y * cellSize + cellSize / 2};
+}
+
+bool NavigationGrid::isWalkable(uint32_t cell) const {
+    return cell < walkable.size() && walkable[cell] != 0;
+}
+
+FlowField::FlowField(const NavigationGrid& navigation)
+    : grid(navigation),
+      wantedTarget(NavigationGrid::NO_CELL),
+      builtTarget(NavigationGrid::NO_CELL),
+      searchTarget(NavigationGrid::NO_CELL),
+      frontierHead(0),
+      searching(false) {}
+
+void FlowField::setTarget(uint32_t cell) {
+    wantedTarget = cell;
+}
+
+bool FlowField::isReady() const {
+    return builtTarget != NavigationGrid::NO_CELL;
+}
+
+bool FlowField::isBuilding() const {
+    return searching || (wantedTarget != NavigationGrid::NO_CELL && wantedTarget != builtTarget);
+}
+
+void FlowField::start() {
+    searchTarget = wantedTarget;
+    pending.assign(grid.getCellCount(), UNREACHED);
+    frontier.clear();
+    frontierHead = 0;
+    searching = true;
+
+    // Seeded even when the target's own cell is blocked (a player pressed against a wall);
+    // the walkable cells around it are reached from there
+    pending[searchTarget] = 0;
+    frontier.push_back(searchTarget);
+}
+
+size_t FlowField::advance(size_t budget) {
+    if (!searching) {
+        if (!isBuilding()) return 0;
+        start();
+    }
+
+    int width = grid.getWidth();
+    int height = grid.getHeight();
+    size_t expanded = 0;
+    while (expanded < budget && frontierHead < frontier.size()) {
+        uint32_t cell = frontier[frontierHead++];
+        int x = static_cast<int>(cell % width);
+        int y = static_cast<int>(cell / width);
+        uint16_t next = static_cast<uint16_t>(pending[cell] + 1);
+        expanded++;
+
+        for (int i = 0; i < 8; ++i) {
+            int nx = x + NEIGHBOUR_X[i];
+            int ny = y + NEIGHBOUR_Y[i];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+
+            uint32_t neighbour = static_cast<uint32_t>(ny * width + nx);
+            if (pending[neighbour] != UNREACHED || !grid.isWalkable(neighbour)) continue;
+            if (cutsCorner(grid, x, y, i)) continue;
+
+            pending[neighbour] = next;
+            frontier.push_back(neighbour);
+        }
+    }
+
+    if (frontierHead == frontier.size()) {
+        distances.swap(pending);
+        builtTarget = searchTarget;
+        searching = false;
+    }
+    return expanded;
+}
+
+uint16_t FlowField::distanceAt(uint32_t cell) const {
+    if (!isReady() || cell >= distances.size()) return UNREACHED;
+    return distances[cell];
+}
+
+Position FlowField::directionAt(Position position) const {
+    uint32_t cell = grid.cellAt(position);
+    if (!isReady() || cell == NavigationGrid::NO_CELL) return {0, 0};
+
+    uint16_t here = distances[cell];
+    if (here == 0) return {0, 0};
+
+    // Closest neighbour to the target. Ties (common: distance counts diagonal steps as one) go to
+    // the step pointing most directly at the target. Off the field (an agent squeezed into a
+    // blocked cell) any neighbour on it will do.
+    int width = grid.getWidth();
+    int x = static_cast<int>(cell % width);
+    int y = static_cast<int>(cell / width);
+    Position target = grid.centerOf(builtTarget);
+    int towardX = target.x - position.x;
+    int towardY = target.y - position.y;
+    bool onField = here != UNREACHED;
+
+    uint32_t best = NavigationGrid::NO_CELL;
+    uint16_t bestDistance = UNREACHED;
+    long bestAlignment = 0;
+    for (int i = 0; i < 8; ++i) {
+        int nx = x + NEIGHBOUR_X[i];
+        int ny = y + NEIGHBOUR_Y[i];
+        if (nx < 0 || ny < 0 || nx >= width || ny >= grid.getHeight()) continue;
+
+        uint32_t neighbour = static_cast<uint32_t>(ny * width + nx);
+        uint16_t distance = distances[neighbour];
+        if (distance == UNREACHED || (onField && distance >= here)) continue;
+        if (onField && cutsCorner(grid, x, y, i)) continue;
+
+        long alignment = static_cast<long>(NEIGHBOUR_X[i]) * towardX + static_cast<long>(NEIGHBOUR_Y[i]) * towardY;
+        if (i >= 4) alignment = alignment * 5 / 7;  // Diagonal steps are sqrt(2) longer
+        if (best == NavigationGrid::NO_CELL || distance < bestDistance || (distance == bestDistance && alignment > bestAlignment)) {
+            best = neighbour;
+            bestDistance = distance;
+            bestAlignment = alignment;
+        }
+    }
+    if (best == NavigationGrid::NO_CELL) return {0, 0};
+
+    // Head for the neighbour's center, which keeps agents off the walls of narrow passages
+    Position center = grid.centerOf(best);
+    int dx = center.x - position.x;
+    int dy = center.y - position.y;
+    return {std::abs(dx) > STEERING_DEADZONE ? sign(dx) : 0, std::abs(dy) > STEERING_DEADZONE ? sign(dy) : 0};
+}
@@ -0,0 +1,77 @@
+#ifndef NAVIGATION_HPP
+#define NAVIGATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/map.hpp"
+#include "entities/position.hpp"
+
+// Walkable cells for one agent size, rasterized from the map's obstacles.
+// A cell is walkable when a circle of the agent's radius fits at its center.
+class NavigationGrid {
+   public:
+    static constexpr int DEFAULT_CELL_SIZE = 10;
+    static constexpr uint32_t NO_CELL = 0xFFFFFFFF;
+
+    NavigationGrid(const Map& map, int agentRadius, int cellSize = DEFAULT_CELL_SIZE);
+
+    int getWidth() const;
+    int getHeight() const;
+    int getCellSize() const;
+    size_t getCellCount() const;
+
+    uint32_t cellAt(Position position) const;  // NO_CELL outside the grid
+    Position centerOf(uint32_t cell) const;
+    bool isWalkable(uint32_t cell) const;
+
+   private:
+    int width;
+    int height;
+    int cellSize;
+    std::vector<uint8_t> walkable;
+};
+
+// Distance to one target cell from every walkable cell, for any number of agents heading there.
+// Agents move the same distance per tick straight or diagonally, so the distance is a breadth
+// first search over 8 neighbours; diagonal steps may not cut an obstacle's corner.
+//
+// The search runs incrementally: advance() expands a bounded number of cells per call, and the
+// last completed field keeps steering agents until the next one is done. A target that moves
+// while a search is running is picked up by the search after it.
+class FlowField {
+   public:
+    static constexpr uint16_t UNREACHED = 0xFFFF;
+
+    explicit FlowField(const NavigationGrid& grid);
+
+    void setTarget(uint32_t cell);
+    // Expands at most budget cells, returns how many it did
+    size_t advance(size_t budget);
+    bool isReady() const;     // A completed field exists
+    bool isBuilding() const;  // A search is pending or running
+
+    // Unit step (each axis -1, 0 or 1) that brings an agent at position closer to the target.
+    // {0, 0} in the target cell, with no completed field yet, or when the target can't be reached.
+    Position directionAt(Position position) const;
+    uint16_t distanceAt(uint32_t cell) const;
+
+   private:
+    void start();
+
+    const NavigationGrid& grid;
+
+    uint32_t wantedTarget;
+    uint32_t builtTarget;
+    std::vector<uint16_t> distances;  // Completed field for builtTarget
+
+    // Search in progress
+    uint32_t searchTarget;
+    std::vector<uint16_t> pending;
+    std::vector<uint32_t> frontier;
+    size_t frontierHead;
+    bool searching;
+};
+
+#endif
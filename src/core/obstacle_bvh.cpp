@@ -0,0 +1,385 @@
+#include "core/obstacle_bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr int BIN_COUNT = 16;      // Candidate split planes per axis
+constexpr int MAX_SAH_DEPTH = 32;  // Deeper than this the build falls back to median splits
+
+// Node boxes are grown by this so rays running exactly along an edge still reach the shapes there
+constexpr float NODE_PADDING = 0.5f;
+
+// 1 / d, with a huge value of the same sign instead of infinity so 0 * it stays 0 in the slab tests
+float inverse(float d) {
+    if (d == 0.0f) return 1e30f;
+    return 1.0f / d;
+}
+
+// Distance at which a ray enters a box, or a value above limit when it misses or the box is further away
+float enterBox(float minX, float minY, float maxX, float maxY, float ox, float oy, float invX, float invY, float limit) {
+    float x1 = (minX - ox) * invX;
+    float x2 = (maxX - ox) * invX;
+    float y1 = (minY - oy) * invY;
+    float y2 = (maxY - oy) * invY;
+    float enter = std::max(std::max(std::min(x1, x2), std::min(y1, y2)), 0.0f);
+    float exit = std::min(std::max(x1, x2), std::max(y1, y2));
+    return exit >= enter && enter <= limit ? enter : 2e30f;
+}
+
+// Exact test against one shape, closer than limit. Same extents as the obstacles' collision tests.
+bool intersect(const ObstacleShape& shape, float ox, float oy, float dx, float dy, float invX, float invY, float limit, float& distance,
+               float& normalX, float& normalY) {
+    if (shape.type == ObstacleType::CIRCLE) {
+        float mx = ox - shape.x;
+        float my = oy - shape.y;
+        float b = mx * dx + my * dy;
+        float c = mx * mx + my * my - shape.radius * shape.radius;
+        if (c > 0.0f && b > 0.0f) return false;  // Outside and pointing away
+        float discriminant = b * b - c;
+        if (discriminant < 0.0f) return false;
+
+        float t = -b - std::sqrt(discriminant);
+        if (t > limit) return false;
+        if (t <= 0.0f) {
+            distance = 0.0f;
+            normalX = -dx;
+            normalY = -dy;
+            return true;
+        }
+        distance = t;
+        normalX = (mx + dx * t) / shape.radius;
+        normalY = (my + dy * t) / shape.radius;
+        return true;
+    }
+
+    // A ray parallel to a slab is inside it for its whole length or never, edges included
+    float nearX = -1e30f, farX = 1e30f, nearY = -1e30f, farY = 1e30f;
+    if (dx != 0.0f) {
+        float x1 = (shape.minX - ox) * invX;
+        float x2 = (shape.maxX - ox) * invX;
+        nearX = std::min(x1, x2);
+        farX = std::max(x1, x2);
+    } else if (ox < shape.minX || ox > shape.maxX) {
+        return false;
+    }
+    if (dy != 0.0f) {
+        float y1 = (shape.minY - oy) * invY;
+        float y2 = (shape.maxY - oy) * invY;
+        nearY = std::min(y1, y2);
+        farY = std::max(y1, y2);
+    } else if (oy < shape.minY || oy > shape.maxY) {
+        return false;
+    }
+    float enter = std::max(nearX, nearY);
+    float exit = std::min(farX, farY);
+    if (exit < std::max(enter, 0.0f) || enter > limit) return false;
+
+    if (enter <= 0.0f) {
+        distance = 0.0f;
+        normalX = -dx;
+        normalY = -dy;
+        return true;
+    }
+    // Entered through the last slab crossed
+    distance = enter;
+    normalX = nearX >= nearY ? (dx > 0.0f ? -1.0f : 1.0f) : 0.0f;
+    normalY = nearX >= nearY ? 0.0f : (dy > 0.0f ? -1.0f : 1.0f);
+    return true;
+}
+
+template <typename Box>
+float perimeter(const Box& box) {
+    return box.maxX - box.minX + box.maxY - box.minY;
+}
+
+template <typename Box>
+void grow(Box& box, const Box& other) {
+    box.minX = std::min(box.minX, other.minX);
+    box.minY = std::min(box.minY, other.minY);
+    box.maxX = std::max(box.maxX, other.maxX);
+    box.maxY = std::max(box.maxY, other.maxY);
+    box.count += other.count;
+}
+
+float centroid(const ObstacleShape& shape, int axis) {
+    return axis == 0 ? shape.minX + shape.maxX : shape.minY + shape.maxY;
+}
+}  // namespace
+
+void ObstacleBvh::clear() {
+    nodes.clear();
+    leafShapes.clear();
+    leafObstacles.clear();
+}
+
+void ObstacleBvh::build(const std::vector<ObstacleShape>& shapes) {
+    clear();
+    if (shapes.empty()) {
+        return;
+    }
+
+    buildShapes = shapes;
+    order.resize(shapes.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    nodes.reserve(shapes.size() * 2);
+    nodes.resize(1);
+    buildNode(0, 0, static_cast<uint32_t>(shapes.size()), 1);
+
+    leafShapes.reserve(order.size());
+    leafObstacles.reserve(order.size());
+    for (uint32_t index : order) {
+        leafShapes.push_back(buildShapes[index]);
+        leafObstacles.push_back(static_cast<int>(index));
+    }
+}
+
+void ObstacleBvh::buildNode(uint32_t index, uint32_t first, uint32_t count, int level) {
+    Node node;
+    node.minX = node.minY = 1e30f;
+    node.maxX = node.maxY = -1e30f;
+    float centroidMin[2] = {1e30f, 1e30f};
+    float centroidMax[2] = {-1e30f, -1e30f};
+    for (uint32_t i = first; i < first + count; ++i) {
+        const ObstacleShape& shape = buildShapes[order[i]];
+        node.minX = std::min(node.minX, shape.minX);
+        node.minY = std::min(node.minY, shape.minY);
+        node.maxX = std::max(node.maxX, shape.maxX);
+        node.maxY = std::max(node.maxY, shape.maxY);
+        for (int axis = 0; axis < 2; ++axis) {
+            centroidMin[axis] = std::min(centroidMin[axis], centroid(shape, axis));
+            centroidMax[axis] = std::max(centroidMax[axis], centroid(shape, axis));
+        }
+    }
+
+    node.minX -= NODE_PADDING;
+    node.minY -= NODE_PADDING;
+    node.maxX += NODE_PADDING;
+    node.maxY += NODE_PADDING;
+
+    if (count <= MAX_LEAF_SIZE) {
+        node.leftOrFirst = first;
+        node.count = static_cast<uint16_t>(count);
+        node.axis = 0;
+        nodes[index] = node;
+        return;
+    }
+
+    // Binned surface area heuristic: a ray reaches a box about in proportion to its perimeter in 2D,
+    // so pick the split that minimises shapes tested times the chance of reaching them
+    struct Bin {
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+        uint32_t count = 0;
+    };
+    float bestCost = 1e30f;
+    int bestAxis = -1;
+    int bestSplit = 0;
+    for (int axis = 0; axis < 2; ++axis) {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f) continue;
+
+        Bin bins[BIN_COUNT];
+        float scale = BIN_COUNT / extent;
+        for (uint32_t i = first; i < first + count; ++i) {
+            const ObstacleShape& shape = buildShapes[order[i]];
+            Bin& bin = bins[std::min(BIN_COUNT - 1, static_cast<int>((centroid(shape, axis) - centroidMin[axis]) * scale))];
+            bin.minX = std::min(bin.minX, shape.minX);
+            bin.minY = std::min(bin.minY, shape.minY);
+            bin.maxX = std::max(bin.maxX, shape.maxX);
+            bin.maxY = std::max(bin.maxY, shape.maxY);
+            bin.count++;
+        }
+
+        // Sweep from the right to get the cost of every right-hand side, then from the left
+        float rightCost[BIN_COUNT];
+        Bin right;
+        for (int split = BIN_COUNT - 1; split > 0; --split) {
+            grow(right, bins[split]);
+            rightCost[split] = right.count * perimeter(right);
+        }
+        Bin left;
+        for (int split = 1; split < BIN_COUNT; ++split) {
+            grow(left, bins[split - 1]);
+            float cost = left.count * perimeter(left) + rightCost[split];
+            if (left.count > 0 && left.count < count && cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t half;
+    int axis;
+    if (bestAxis >= 0 && level < MAX_SAH_DEPTH) {
+        axis = bestAxis;
+        float scale = BIN_COUNT / (centroidMax[axis] - centroidMin[axis]);
+        auto middle = std::partition(order.begin() + first, order.begin() + first + count, [&](uint32_t index) {
+            return std::min(BIN_COUNT - 1, static_cast<int>((centroid(buildShapes[index], axis) - centroidMin[axis]) * scale)) < bestSplit;
+        });
+        half = static_cast<uint32_t>(middle - (order.begin() + first));
+    } else {
+        // Median split along the axis the centers spread most on, which bounds the depth
+        axis = centroidMax[0] - centroidMin[0] >= centroidMax[1] - centroidMin[1] ? 0 : 1;
+        half = count / 2;
+        std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                         [this, axis](uint32_t a, uint32_t b) { return centroid(buildShapes[a], axis) < centroid(buildShapes[b], axis); });
+    }
+
+    // Both children side by side, so the right one is always left + 1
+    uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes.resize(nodes.size() + 2);
+    node.leftOrFirst = left;
+    node.count = 0;
+    node.axis = static_cast<uint16_t>(axis);
+    nodes[index] = node;
+
+    buildNode(left, first, half, level + 1);
+    buildNode(left + 1, first + half, count - half, level + 1);
+}
+
+template <bool ANY_HIT>
+bool ObstacleBvh::traceRay(const Ray& ray, RayHit& hit) const {
+    hit = {ray.maxDistance, -1, 0.0f, 0.0f};
+    if (nodes.empty()) {
+        return false;
+    }
+
+    float invX = inverse(ray.directionX);
+    float invY = inverse(ray.directionY);
+    struct Entry {
+        uint32_t node;
+        float enter;
+    };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+
+    const Node& root = nodes[0];
+    float rootEnter = enterBox(root.minX, root.minY, root.maxX, root.maxY, ray.originX, ray.originY, invX, invY, hit.distance);
+    if (rootEnter <= hit.distance) {
+        stack[top++] = {0, rootEnter};
+    }
+
+    while (top > 0) {
+        Entry entry = stack[--top];
+        if (entry.enter > hit.distance) continue;  // A closer hit turned up since this was pushed
+
+        const Node& node = nodes[entry.node];
+        if (node.count > 0) {
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+                float distance, normalX, normalY;
+                if (!intersect(leafShapes[i], ray.originX, ray.originY, ray.directionX, ray.directionY, invX, invY, hit.distance, distance,
+                               normalX, normalY)) {
+                    continue;
+                }
+                if (distance < hit.distance || hit.obstacle < 0) {
+                    hit = {distance, leafObstacles[i], normalX, normalY};
+                    if (ANY_HIT) return true;
+                }
+            }
+            continue;
+        }
+
+        // Nearer child on top of the stack so it can shorten the ray before the other is tried
+        const Node& left = nodes[node.leftOrFirst];
+        const Node& right = nodes[node.leftOrFirst + 1];
+        Entry near = {node.leftOrFirst,
+                      enterBox(left.minX, left.minY, left.maxX, left.maxY, ray.originX, ray.originY, invX, invY, hit.distance)};
+        Entry far = {node.leftOrFirst + 1,
+                     enterBox(right.minX, right.minY, right.maxX, right.maxY, ray.originX, ray.originY, invX, invY, hit.distance)};
+        if (far.enter < near.enter) std::swap(near, far);
+        if (far.enter <= hit.distance) stack[top++] = far;
+        if (near.enter <= hit.distance) stack[top++] = near;
+    }
+    return hit.obstacle >= 0;
+}
+
+void ObstacleBvh::tracePacket(const Ray* rays, int count, RayHit* hits) const {
+    // Structure of arrays so the per-node box test runs over all lanes in one loop
+    float originX[PACKET_SIZE], originY[PACKET_SIZE], invX[PACKET_SIZE], invY[PACKET_SIZE], limit[PACKET_SIZE];
+    uint32_t active = 0;
+    float meanX = 0.0f;
+    float meanY = 0.0f;
+    for (int lane = 0; lane < PACKET_SIZE; ++lane) {
+        const Ray& ray = rays[lane < count ? lane : 0];
+        originX[lane] = ray.originX;
+        originY[lane] = ray.originY;
+        invX[lane] = inverse(ray.directionX);
+        invY[lane] = inverse(ray.directionY);
+        limit[lane] = ray.maxDistance;
+        if (lane < count) {
+            active |= 1u << lane;
+            meanX += ray.directionX;
+            meanY += ray.directionY;
+            hits[lane] = {ray.maxDistance, -1, 0.0f, 0.0f};
+        }
+    }
+    if (nodes.empty()) {
+        return;
+    }
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+
+        uint32_t reached = 0;
+        for (int lane = 0; lane < PACKET_SIZE; ++lane) {
+            float x1 = (node.minX - originX[lane]) * invX[lane];
+            float x2 = (node.maxX - originX[lane]) * invX[lane];
+            float y1 = (node.minY - originY[lane]) * invY[lane];
+            float y2 = (node.maxY - originY[lane]) * invY[lane];
+            float enter = std::max(std::max(std::min(x1, x2), std::min(y1, y2)), 0.0f);
+            float exit = std::min(std::max(x1, x2), std::max(y1, y2));
+            reached |= static_cast<uint32_t>(exit >= enter && enter <= limit[lane]) << lane;
+        }
+        reached &= active;
+        if (reached == 0) continue;
+
+        if (node.count == 0) {
+            // Front to back along the split axis for the packet's average direction
+            float along = node.axis == 0 ? meanX : meanY;
+            uint32_t near = node.leftOrFirst + (along < 0.0f ? 1 : 0);
+            uint32_t far = node.leftOrFirst + (along < 0.0f ? 0 : 1);
+            stack[top++] = far;
+            stack[top++] = near;
+            continue;
+        }
+
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+            for (int lane = 0; lane < PACKET_SIZE; ++lane) {
+                if ((reached & (1u << lane)) == 0) continue;
+
+                const Ray& ray = rays[lane];
+                float distance, normalX, normalY;
+                if (!intersect(leafShapes[i], ray.originX, ray.originY, ray.directionX, ray.directionY, invX[lane], invY[lane], limit[lane],
+                               distance, normalX, normalY)) {
+                    continue;
+                }
+                if (distance < limit[lane] || hits[lane].obstacle < 0) {
+                    limit[lane] = distance;
+                    hits[lane] = {distance, leafObstacles[i], normalX, normalY};
+                }
+            }
+        }
+    }
+}
+
+bool ObstacleBvh::raycast(const Ray& ray, RayHit& hit) const {
+    return traceRay<false>(ray, hit);
+}
+
+bool ObstacleBvh::occluded(const Ray& ray) const {
+    RayHit hit;
+    return traceRay<true>(ray, hit);
+}
+
+void ObstacleBvh::raycast(const Ray* rays, size_t count, RayHit* hits) const {
+    for (size_t first = 0; first < count; first += PACKET_SIZE) {
+        int lanes = static_cast<int>(std::min<size_t>(PACKET_SIZE, count - first));
+        tracePacket(rays + first, lanes, hits + first);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef OBSTACLE_BVH_HPP
+#define OBSTACLE_BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "entities/obstacle.hpp"
+
+// Obstacle geometry flattened for the map queries: no virtual calls, one cache line each
+struct ObstacleShape {
+    ObstacleType type;
+    float x, y;                    // Center
+    float radius;                  // Circles only
+    float minX, minY, maxX, maxY;  // Rectangle extents, or the circle's bounding box
+};
+
+// Half-line from origin along a unit direction, cut off at maxDistance
+struct Ray {
+    float originX, originY;
+    float directionX, directionY;
+    float maxDistance;
+};
+
+// Nearest obstacle along a ray. A ray starting inside an obstacle hits it at distance 0 with the
+// normal facing back along the ray. A miss leaves obstacle at -1 and distance at maxDistance.
+struct RayHit {
+    float distance;
+    int obstacle;  // Index of the obstacle as it was added, -1 for none
+    float normalX, normalY;
+};
+
+// Bounding volume hierarchy over static obstacles, built once when they change.
+// Nodes are a flat array with siblings next to each other; leaves hold copies of their shapes in
+// tree order, so a traversal reads memory front to back. Queries are const and safe from any thread.
+class ObstacleBvh {
+   public:
+    static constexpr int MAX_LEAF_SIZE = 2;
+    static constexpr int PACKET_SIZE = 8;  // Rays traced together by the batched queries
+
+    void build(const std::vector<ObstacleShape>& shapes);
+    void clear();
+
+    bool raycast(const Ray& ray, RayHit& hit) const;
+    // True when any obstacle lies on the ray before maxDistance; stops at the first one found
+    bool occluded(const Ray& ray) const;
+
+    // Rays go through the tree in packets: a node is visited once for all rays that reach it.
+    // Pays off when rays start near each other and point roughly the same way (a fan of shots,
+    // a bot scanning); scattered rays are faster one at a time.
+    void raycast(const Ray* rays, size_t count, RayHit* hits) const;
+
+    // Calls fn(obstacle) once for every obstacle whose bounding box overlaps the box, in tree order
+    template <typename Fn>
+    void forEachOverlapping(float minX, float minY, float maxX, float maxY, Fn&& fn) const;
+
+   private:
+    static constexpr int STACK_SIZE = 64;  // Enough for the SAH levels plus median splits of any map below them
+
+    struct Node {
+        float minX, minY, maxX, maxY;
+        uint32_t leftOrFirst;  // Interior: left child, the right one follows it. Leaf: first shape.
+        uint16_t count;        // Shapes in a leaf, 0 for interior nodes
+        uint16_t axis;         // Split axis of an interior node, orders the children front to back
+    };
+
+    template <bool ANY_HIT>
+    bool traceRay(const Ray& ray, RayHit& hit) const;
+    void tracePacket(const Ray* rays, int count, RayHit* hits) const;
+    void buildNode(uint32_t index, uint32_t first, uint32_t count, int level);
+
+    std::vector<Node> nodes;
+    std::vector<ObstacleShape> leafShapes;  // In leaf order
+    std::vector<int> leafObstacles;         // Obstacle index of each leaf shape
+
+    // Scratch for build()
+    std::vector<uint32_t> order;
+    std::vector<ObstacleShape> buildShapes;
+};
+
+template <typename Fn>
+void ObstacleBvh::forEachOverlapping(float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+    if (nodes.empty()) {
+        return;
+    }
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) continue;
+
+        if (node.count == 0) {
+            stack[top++] = node.leftOrFirst + 1;
+            stack[top++] = node.leftOrFirst;
+            continue;
+        }
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+            const ObstacleShape& shape = leafShapes[i];
+            if (shape.maxX < minX || shape.minX > maxX || shape.maxY < minY || shape.minY > maxY) continue;
+            fn(leafObstacles[i]);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,220 @@
+#include "core/particles.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE2 1
+#endif
+
+#include "core/quad_batch.hpp"
+
+namespace {
+constexpr float PI = 3.14159265f;
+
+size_t roundUpToLanes(size_t value, size_t lanes) {
+    return (value + lanes - 1) / lanes * lanes;
+}
+}  // namespace
+
+ParticlePool::ParticlePool(size_t maxParticles, float size, float dragPerSecond)
+    : capacity(maxParticles), count(0), halfSize(size * 0.5f), drag(dragPerSecond), seed(0x9E3779B9u) {
+    // Padding lanes hold dead particles, so update() never needs a scalar tail
+    size_t padded = roundUpToLanes(capacity, LANES);
+    xs.assign(padded, 0.0f);
+    ys.assign(padded, 0.0f);
+    velocityXs.assign(padded, 0.0f);
+    velocityYs.assign(padded, 0.0f);
+    lives.assign(padded, 0.0f);
+    fadeRates.assign(padded, 0.0f);
+    colors.assign(padded, Color{0, 0, 0, 0});
+}
+
+float ParticlePool::random() {
+    // xorshift32: cosmetic randomness that costs nothing and never touches shared state
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return static_cast<float>(seed >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticlePool::emit(float x, float y, float angle, float spread, float minSpeed, float maxSpeed, float life, Color color, int burst) {
+    if (life <= 0.0f) return;
+
+    size_t room = capacity - count;
+    size_t spawned = std::min(room, static_cast<size_t>(std::max(burst, 0)));
+    for (size_t i = 0; i < spawned; ++i) {
+        float heading = angle + (random() * 2.0f - 1.0f) * spread;
+        float speed = minSpeed + (maxSpeed - minSpeed) * random();
+        // Lifetimes vary a little so a burst thins out instead of vanishing at once
+        float lifetime = life * (0.6f + 0.4f * random());
+
+        size_t slot = count++;
+        xs[slot] = x;
+        ys[slot] = y;
+        velocityXs[slot] = std::cos(heading) * speed;
+        velocityYs[slot] = std::sin(heading) * speed;
+        lives[slot] = lifetime;
+        fadeRates[slot] = 1.0f / lifetime;
+        colors[slot] = color;
+    }
+}
+
+void ParticlePool::update(float dt) {
+    if (count == 0) return;
+
+    float damping = std::max(0.0f, 1.0f - drag * dt);
+    size_t lanes = roundUpToLanes(count, LANES);
+#ifdef PARTICLES_SSE2
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 damp = _mm_set1_ps(damping);
+    for (size_t i = 0; i < lanes; i += LANES) {
+        __m128 velocityX = _mm_loadu_ps(&velocityXs[i]);
+        __m128 velocityY = _mm_loadu_ps(&velocityYs[i]);
+        _mm_storeu_ps(&xs[i], _mm_add_ps(_mm_loadu_ps(&xs[i]), _mm_mul_ps(velocityX, step)));
+        _mm_storeu_ps(&ys[i], _mm_add_ps(_mm_loadu_ps(&ys[i]), _mm_mul_ps(velocityY, step)));
+        _mm_storeu_ps(&velocityXs[i], _mm_mul_ps(velocityX, damp));
+        _mm_storeu_ps(&velocityYs[i], _mm_mul_ps(velocityY, damp));
+        _mm_storeu_ps(&lives[i], _mm_sub_ps(_mm_loadu_ps(&lives[i]), step));
+    }
+#else
+    // Same arithmetic as the SSE2 path, laid out so the compiler can vectorize it
+    for (size_t i = 0; i < lanes; ++i) {
+        xs[i] += velocityXs[i] * dt;
+        ys[i] += velocityYs[i] * dt;
+        velocityXs[i] *= damping;
+        velocityYs[i] *= damping;
+        lives[i] -= dt;
+    }
+#endif
+
+    // Dead particles are replaced by the last live one; draw order doesn't matter
+    size_t i = 0;
+    while (i < count) {
+#ifdef PARTICLES_SSE2
+        // Most blocks of four have nobody dying this frame
+        if (i % LANES == 0 && i + LANES <= count && _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(&lives[i]), _mm_setzero_ps())) == 0) {
+            i += LANES;
+            continue;
+        }
+#endif
+        if (lives[i] > 0.0f) {
+            ++i;
+            continue;
+        }
+        size_t last = --count;
+        xs[i] = xs[last];
+        ys[i] = ys[last];
+        velocityXs[i] = velocityXs[last];
+        velocityYs[i] = velocityYs[last];
+        lives[i] = lives[last];
+        fadeRates[i] = fadeRates[last];
+        colors[i] = colors[last];
+        lives[last] = 0.0f;
+    }
+}
+
+void ParticlePool::draw() const {
+    if (count == 0) return;
+
+    // The whole pool is one draw call
+    QuadBatch::begin(count);
+    for (size_t i = 0; i < count; ++i) {
+        float alpha = std::min(1.0f, lives[i] * fadeRates[i]);
+        Color color = colors[i];
+        color.a = static_cast<unsigned char>(color.a * alpha);
+        QuadBatch::add(xs[i] - halfSize, ys[i] - halfSize, xs[i] + halfSize, ys[i] + halfSize, color);
+    }
+    QuadBatch::end();
+}
+
+void ParticlePool::clear() {
+    std::fill(lives.begin(), lives.begin() + count, 0.0f);
+    count = 0;
+}
+
+size_t ParticlePool::size() const {
+    return count;
+}
+
+size_t ParticlePool::getCapacity() const {
+    return capacity;
+}
+
+float ParticlePool::getX(size_t index) const {
+    return xs[index];
+}
+
+float ParticlePool::getY(size_t index) const {
+    return ys[index];
+}
+
+float ParticlePool::getLife(size_t index) const {
+    return lives[index];
+}
+
+ParticleEffects::ParticleEffects() : sparks(1024, 3.0f, 4.0f), flashes(256, 4.0f, 10.0f), bursts(1024, 4.0f, 2.5f) {}
+
+void ParticleEffects::onHits(Registry& registry, const std::vector<Hit>& hits) {
+    for (const Hit& hit : hits) {
+        // Sparks fly back the way the bullet came
+        float angle = 0.0f;
+        if (registry.isValid(hit.shooter)) {
+            Position from = registry.getTransform(hit.shooter).position;
+            angle = std::atan2(static_cast<float>(from.y - hit.at.y), static_cast<float>(from.x - hit.at.x));
+        }
+        sparks.emit(static_cast<float>(hit.at.x), static_cast<float>(hit.at.y), angle, 0.9f, 60.0f, 220.0f, 0.35f, GOLD, 12);
+    }
+}
+
+void ParticleEffects::observe(Registry& registry) {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<Transform>& transforms = registry.getTransforms();
+    const std::vector<Health>& healths = registry.getHealths();
+    const std::vector<Weapon>& weapons = registry.getWeapons();
+    const std::vector<Appearance>& appearances = registry.getAppearances();
+
+    seen.resize(entities.size(), Seen{NULL_ENTITY, 0, false});
+    for (size_t i = 0; i < entities.size(); ++i) {
+        bool alive = healths[i].current > 0;
+        const std::vector<Bullet>& bullets = weapons[i].bullets;
+        Seen& last = seen[i];
+
+        // A player new to this dense slot (joined, or swapped in by a despawn) has no history yet
+        if (last.entity == entities[i]) {
+            float x = static_cast<float>(transforms[i].position.x);
+            float y = static_cast<float>(transforms[i].position.y);
+            // The shot count moves only when the player fires, even if a bullet expired or hit in the same tick
+            if (weapons[i].shots != last.shots && !bullets.empty()) {
+                Vector2 direction = bullets.back().getDirection();
+                float angle = std::atan2(direction.y, direction.x);
+                float muzzle = static_cast<float>(transforms[i].radius);
+                flashes.emit(x + direction.x * muzzle, y + direction.y * muzzle, angle, 0.45f, 80.0f, 260.0f, 0.08f, YELLOW, 8);
+            }
+            if (last.alive && !alive) {
+                bursts.emit(x, y, 0.0f, PI, 40.0f, 200.0f, 0.9f, appearances[i].color, 48);
+            }
+        }
+        last = Seen{entities[i], weapons[i].shots, alive};
+    }
+}
+
+void ParticleEffects::update(float dt) {
+    sparks.update(dt);
+    flashes.update(dt);
+    bursts.update(dt);
+}
+
+void ParticleEffects::draw() const {
+    bursts.draw();
+    sparks.draw();
+    flashes.draw();
+}
+
+void ParticleEffects::clear() {
+    sparks.clear();
+    flashes.clear();
+    bursts.clear();
+    seen.clear();
+}
@@ -0,0 +1,82 @@
+#ifndef PARTICLES_HPP
+#define PARTICLES_HPP
+
+#include <raylib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/registry.hpp"
+#include "core/simulation.hpp"
+
+// Fixed-capacity particles for one kind of effect. State is kept as parallel arrays (x, y,
+// velocity, life), allocated once and padded to whole SIMD lanes, so update() integrates and
+// fades four particles per instruction and nothing is allocated after construction.
+// Particles only ever live on this machine. A burst that doesn't fit spawns what does.
+class ParticlePool {
+   public:
+    ParticlePool(size_t capacity, float size, float drag);
+
+    // count particles at (x, y) heading within spread radians either side of angle, with speeds
+    // between minSpeed and maxSpeed pixels a second, each living for life seconds
+    void emit(float x, float y, float angle, float spread, float minSpeed, float maxSpeed, float life, Color color, int count);
+    void update(float dt);
+    void draw() const;  // One batch of quads for the whole pool
+    void clear();
+
+    size_t size() const;
+    size_t getCapacity() const;
+    float getX(size_t index) const;
+    float getY(size_t index) const;
+    float getLife(size_t index) const;
+
+   private:
+    static constexpr size_t LANES = 4;
+
+    float random();  // 0..1
+
+    size_t capacity;
+    size_t count;
+    float halfSize;
+    float drag;  // Fraction of velocity lost per second
+    uint32_t seed;
+
+    std::vector<float> xs, ys;
+    std::vector<float> velocityXs, velocityYs;
+    std::vector<float> lives;      // Seconds left
+    std::vector<float> fadeRates;  // 1 / initial life, turns life into alpha
+    std::vector<Color> colors;
+};
+
+// Hit sparks, muzzle flashes and death bursts, spawned from what the game already knows: hits
+// from the simulation, and shots and deaths noticed from players' shot counts and health. Nothing
+// about them is sent over the network; every machine makes its own.
+class ParticleEffects {
+   public:
+    ParticleEffects();
+
+    // Hits resolved by one simulation tick
+    void onHits(Registry& registry, const std::vector<Hit>& hits);
+    // Once per frame, after the players' state for the frame is known
+    void observe(Registry& registry);
+
+    void update(float dt);
+    void draw() const;
+    void clear();
+
+   private:
+    // What observe() saw of the player at the same dense index last time
+    struct Seen {
+        Entity entity;
+        uint8_t shots;
+        bool alive;
+    };
+
+    ParticlePool sparks;
+    ParticlePool flashes;
+    ParticlePool bursts;
+    std::vector<Seen> seen;
+};
+
+#endif
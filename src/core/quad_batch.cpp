@@ -0,0 +1,23 @@
+#include "core/quad_batch.hpp"
+
+#include <rlgl.h>
+
+void QuadBatch::begin(size_t quads) {
+    rlCheckRenderBatchLimit(static_cast<int>(quads) * 4);
+    // Bind raylib's white texture, or the quads would sample whatever text drew last
+    rlSetTexture(rlGetTextureIdDefault());
+    rlBegin(RL_QUADS);
+}
+
+void QuadBatch::add(float left, float top, float right, float bottom, Color color) {
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    rlVertex2f(left, top);
+    rlVertex2f(left, bottom);
+    rlVertex2f(right, bottom);
+    rlVertex2f(right, top);
+}
+
+void QuadBatch::end() {
+    rlEnd();
+    rlSetTexture(0);
+}
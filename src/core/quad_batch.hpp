@@ -0,0 +1,16 @@
+#ifndef QUAD_BATCH_HPP
+#define QUAD_BATCH_HPP
+
+#include <raylib.h>
+
+#include <cstddef>
+
+// Untextured quads straight into raylib's vertex batch, so a whole run of them is one draw call.
+// Every add() goes between a begin() sized for at least that many quads and an end().
+namespace QuadBatch {
+void begin(size_t quads);
+void add(float left, float top, float right, float bottom, Color color);
+void end();
+}  // namespace QuadBatch
+
+#endif
@@ -0,0 +1,199 @@
+#include "core/registry.hpp"
+
+#include <utility>
+
+Registry::Registry(size_t capacity) {
+    sparse.reserve(capacity);
+    generations.reserve(capacity);
+    freeSlots.reserve(capacity);
+    entities.reserve(capacity);
+    transforms.reserve(capacity);
+    healths.reserve(capacity);
+    weapons.reserve(capacity);
+    inputs.reserve(capacity);
+    networkIds.reserve(capacity);
+    appearances.reserve(capacity);
+}
+
+uint32_t Registry::slotOf(Entity entity) {
+    return entity & SLOT_MASK;
+}
+
+uint32_t Registry::generationOf(Entity entity) {
+    return entity >> GENERATION_SHIFT;
+}
+
+Entity Registry::spawn(const Transform& transform, const Health& health, Weapon weapon, NetworkId networkId,
+                       const Appearance& appearance) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(sparse.size());
+        sparse.push_back(0);
+        generations.push_back(0);
+    }
+
+    Entity entity = slot | (static_cast<uint32_t>(generations[slot]) << GENERATION_SHIFT);
+    sparse[slot] = static_cast<uint32_t>(entities.size());
+
+    entities.push_back(entity);
+    transforms.push_back(transform);
+    healths.push_back(health);
+    weapons.push_back(std::move(weapon));
+    inputs.push_back(PlayerInput{{0, 0}, false});
+    networkIds.push_back(networkId);
+    appearances.push_back(appearance);
+
+    if (networkId.peer != NetworkId::LOCAL) {
+        if (networkId.peer >= byNetworkId.size()) {
+            byNetworkId.resize(networkId.peer + 1, NULL_ENTITY);
+        }
+        byNetworkId[networkId.peer] = entity;
+    }
+
+    return entity;
+}
+
+void Registry::despawn(Entity entity) {
+    if (!isValid(entity)) {
+        return;
+    }
+
+    uint32_t slot = slotOf(entity);
+    uint32_t index = sparse[slot];
+    uint32_t last = static_cast<uint32_t>(entities.size() - 1);
+
+    uint16_t peer = networkIds[index].peer;
+    if (peer != NetworkId::LOCAL && peer < byNetworkId.size() && byNetworkId[peer] == entity) {
+        byNetworkId[peer] = NULL_ENTITY;
+    }
+
+    // Move the last entity into the hole to keep every array dense
+    if (index != last) {
+        entities[index] = entities[last];
+        transforms[index] = transforms[last];
+        healths[index] = healths[last];
+        weapons[index] = std::move(weapons[last]);
+        inputs[index] = inputs[last];
+        networkIds[index] = networkIds[last];
+        appearances[index] = appearances[last];
+        sparse[slotOf(entities[index])] = index;
+    }
+
+    entities.pop_back();
+    transforms.pop_back();
+    healths.pop_back();
+    weapons.pop_back();
+    inputs.pop_back();
+    networkIds.pop_back();
+    appearances.pop_back();
+
+    generations[slot]++;
+    freeSlots.push_back(slot);
+}
+
+void Registry::clear() {
+    while (!entities.empty()) {
+        despawn(entities.back());
+    }
+}
+
+bool Registry::isValid(Entity entity) const {
+    if (entity == NULL_ENTITY) {
+        return false;
+    }
+    uint32_t slot = slotOf(entity);
+    return slot < sparse.size() && generations[slot] == generationOf(entity) && sparse[slot] < entities.size() &&
+           entities[sparse[slot]] == entity;
+}
+
+size_t Registry::size() const {
+    return entities.size();
+}
+
+size_t Registry::indexOf(Entity entity) const {
+    return sparse[slotOf(entity)];
+}
+
+Entity Registry::entityAt(size_t index) const {
+    return entities[index];
+}
+
+Entity Registry::findByNetworkId(uint16_t peer) const {
+    if (peer >= byNetworkId.size()) {
+        return NULL_ENTITY;
+    }
+    return byNetworkId[peer];
+}
+
+void Registry::setNetworkId(Entity entity, NetworkId networkId) {
+    if (!isValid(entity)) {
+        return;
+    }
+
+    NetworkId& current = networkIds[indexOf(entity)];
+    if (current.peer != NetworkId::LOCAL && current.peer < byNetworkId.size() && byNetworkId[current.peer] == entity) {
+        byNetworkId[current.peer] = NULL_ENTITY;
+    }
+    current = networkId;
+    if (networkId.peer != NetworkId::LOCAL) {
+        if (networkId.peer >= byNetworkId.size()) {
+            byNetworkId.resize(networkId.peer + 1, NULL_ENTITY);
+        }
+        byNetworkId[networkId.peer] = entity;
+    }
+}
+
+Transform& Registry::getTransform(Entity entity) {
+    return transforms[indexOf(entity)];
+}
+
+Health& Registry::getHealth(Entity entity) {
+    return healths[indexOf(entity)];
+}
+
+Weapon& Registry::getWeapon(Entity entity) {
+    return weapons[indexOf(entity)];
+}
+
+PlayerInput& Registry::getInput(Entity entity) {
+    return inputs[indexOf(entity)];
+}
+
+NetworkId Registry::getNetworkId(Entity entity) const {
+    return networkIds[indexOf(entity)];
+}
+
+const Appearance& Registry::getAppearance(Entity entity) const {
+    return appearances[indexOf(entity)];
+}
+
+const std::vector<Entity>& Registry::getEntities() const {
+    return entities;
+}
+
+std::vector<Transform>& Registry::getTransforms() {
+    return transforms;
+}
+
+std::vector<Health>& Registry::getHealths() {
+    return healths;
+}
+
+std::vector<Weapon>& Registry::getWeapons() {
+    return weapons;
+}
+
+std::vector<PlayerInput>& Registry::getInputs() {
+    return inputs;
+}
+
+const std::vector<NetworkId>& Registry::getNetworkIds() const {
+    return networkIds;
+}
+
+const std::vector<Appearance>& Registry::getAppearances() const {
+    return appearances;
+}
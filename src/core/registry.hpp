@@ -0,0 +1,76 @@
+#ifndef REGISTRY_HPP
+#define REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "entities/components.hpp"
+
+// Entity handle: low 24 bits are the slot, high 8 bits a generation that invalidates stale handles
+using Entity = uint32_t;
+constexpr Entity NULL_ENTITY = 0xFFFFFFFF;
+
+// Sparse-set entity registry. Every live entity owns exactly one of each component and all
+// component arrays are kept densely packed in the same order, so systems iterate them linearly.
+// Spawn and despawn are O(1); despawn swaps the last entity into the freed dense slot.
+class Registry {
+   public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit Registry(size_t capacity = DEFAULT_CAPACITY);
+
+    Entity spawn(const Transform& transform, const Health& health, Weapon weapon, NetworkId networkId, const Appearance& appearance);
+    void despawn(Entity entity);
+    void clear();
+
+    bool isValid(Entity entity) const;
+    size_t size() const;
+    size_t indexOf(Entity entity) const;  // Dense index, entity must be valid
+    Entity entityAt(size_t index) const;
+    Entity findByNetworkId(uint16_t peer) const;  // NULL_ENTITY if no player uses that peer
+    void setNetworkId(Entity entity, NetworkId networkId);  // Moves a player to another peer slot, which must be free
+
+    // Per-entity component access
+    Transform& getTransform(Entity entity);
+    Health& getHealth(Entity entity);
+    Weapon& getWeapon(Entity entity);
+    PlayerInput& getInput(Entity entity);
+    NetworkId getNetworkId(Entity entity) const;
+    const Appearance& getAppearance(Entity entity) const;
+
+    // Dense component arrays, all indexed like getEntities()
+    const std::vector<Entity>& getEntities() const;
+    std::vector<Transform>& getTransforms();
+    std::vector<Health>& getHealths();
+    std::vector<Weapon>& getWeapons();
+    std::vector<PlayerInput>& getInputs();
+    const std::vector<NetworkId>& getNetworkIds() const;
+    const std::vector<Appearance>& getAppearances() const;
+
+   private:
+    static constexpr uint32_t SLOT_MASK = 0x00FFFFFF;
+    static constexpr uint32_t GENERATION_SHIFT = 24;
+
+    static uint32_t slotOf(Entity entity);
+    static uint32_t generationOf(Entity entity);
+
+    // Sparse side: slot -> dense index, plus generation per slot
+    std::vector<uint32_t> sparse;
+    std::vector<uint8_t> generations;
+    std::vector<uint32_t> freeSlots;
+
+    // Dense side
+    std::vector<Entity> entities;
+    std::vector<Transform> transforms;
+    std::vector<Health> healths;
+    std::vector<Weapon> weapons;
+    std::vector<PlayerInput> inputs;
+    std::vector<NetworkId> networkIds;
+    std::vector<Appearance> appearances;
+
+    // Peer slot -> entity, for O(1) lookup when network traffic arrives
+    std::vector<Entity> byNetworkId;
+};
+
+#endif
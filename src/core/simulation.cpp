@@ -0,0 +1,134 @@
+#include "core/simulation.hpp"
+
+#include <algorithm>
+
+#include "entities/player.hpp"
+
+Simulation::Simulation(Registry& reg, const Map& gameMap)
+    : registry(reg), map(gameMap), tickDt(0.0f), resolveDamage(true), broadphaseInterval(1), ticksSinceBroadphase(0) {
+    buildGraph();
+}
+
+void Simulation::buildGraph() {
+    TaskGraph::TaskId movement = graph.add("movement", [this](JobSystem& jobs) { movePlayers(jobs); });
+    TaskGraph::TaskId bullets = graph.add("bullets", [this](JobSystem& jobs) { integrateBullets(jobs); }, {movement});
+    TaskGraph::TaskId broad = graph.add("broadphase", [this](JobSystem&) { buildBroadphase(); }, {bullets});
+    TaskGraph::TaskId detect = graph.add("hit detection", [this](JobSystem& jobs) { detectHits(jobs); }, {broad});
+    graph.add("hit resolution", [this](JobSystem&) { resolveHits(); }, {detect});
+}
+
+void Simulation::tick(JobSystem& jobs, float dt) {
+    tickDt = dt;
+    graph.run(jobs);
+}
+
+const std::vector<Hit>& Simulation::getHits() const {
+    return hits;
+}
+
+void Simulation::setResolveDamage(bool resolve) {
+    resolveDamage = resolve;
+}
+
+void Simulation::setBroadphaseInterval(int ticks) {
+    broadphaseInterval = std::max(1, ticks);
+    invalidateBroadphase();
+}
+
+void Simulation::invalidateBroadphase() {
+    broadphaseEntities.clear();
+}
+
+void Simulation::movePlayers(JobSystem& jobs) {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<PlayerInput>& inputs = registry.getInputs();
+
+    // Each player only writes its own transform and weapon
+    jobs.parallelFor(entities.size(), PLAYERS_PER_JOB, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Player(registry, entities[i]).move(&map, inputs[i], tickDt);
+        }
+    });
+}
+
+void Simulation::integrateBullets(JobSystem& jobs) {
+    const std::vector<Entity>& entities = registry.getEntities();
+
+    jobs.parallelFor(entities.size(), PLAYERS_PER_JOB, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Player(registry, entities[i]).updateBullets(&map);
+        }
+    });
+}
+
+void Simulation::buildBroadphase() {
+    // The grid holds dense indices, so it is stale the moment anyone joins or leaves
+    const std::vector<Entity>& entities = registry.getEntities();
+    if (++ticksSinceBroadphase < broadphaseInterval && !entities.empty() && entities == broadphaseEntities) {
+        return;
+    }
+
+    // A player moves at most its speed along each axis per tick
+    const std::vector<Transform>& transforms = registry.getTransforms();
+    int fastest = 0;
+    for (const Transform& transform : transforms) {
+        fastest = std::max(fastest, transform.speed);
+    }
+    broadphase.build(transforms, registry.getHealths(), Bullet::MAX_RADIUS + fastest * (broadphaseInterval - 1));
+    broadphaseEntities = entities;
+    ticksSinceBroadphase = 0;
+}
+
+void Simulation::detectHits(JobSystem& jobs) {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<Health>& healths = registry.getHealths();
+    std::vector<Weapon>& weapons = registry.getWeapons();
+
+    if (hitsByShooter.size() < entities.size()) {
+        hitsByShooter.resize(entities.size());
+    }
+
+    // Shooters run in parallel: each only erases its own bullets and appends to its own hit list,
+    // victims are only read here
+    jobs.parallelFor(entities.size(), PLAYERS_PER_JOB, [&](size_t begin, size_t end) {
+        for (size_t shooter = begin; shooter < end; ++shooter) {
+            std::vector<Hit>& shooterHits = hitsByShooter[shooter];
+            shooterHits.clear();
+
+            std::vector<Bullet>& bullets = weapons[shooter].bullets;
+            auto spent = std::remove_if(bullets.begin(), bullets.end(), [&](const Bullet& bullet) {
+                // Only players sharing the bullet's grid cell get the exact test; a grid kept from an
+                // earlier tick can still list someone who died since. A bullet stops at the first
+                // player it hits in dense order.
+                size_t victim = entities.size();
+                broadphase.forEachCandidate(bullet.getPosition(), [&](uint32_t candidate) {
+                    if (candidate != shooter && candidate < victim && healths[candidate].current > 0 &&
+                        Player(registry, entities[candidate]).isCollidingWith(bullet)) {
+                        victim = candidate;
+                    }
+                });
+
+                if (victim == entities.size()) {
+                    return false;
+                }
+                shooterHits.push_back({entities[shooter], entities[victim], bullet.getArchetype().damage, bullet.getPosition()});
+                return true;
+            });
+            bullets.erase(spent, bullets.end());
+        }
+    });
+}
+
+void Simulation::resolveHits() {
+    // Serial merge in shooter order keeps damage application deterministic
+    hits.clear();
+    size_t count = registry.size();
+    for (size_t shooter = 0; shooter < count; ++shooter) {
+        for (const Hit& hit : hitsByShooter[shooter]) {
+            if (resolveDamage) {
+                Player(registry, hit.victim).takeDamage(hit.damage);
+            }
+            hits.push_back(hit);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <vector>
+
+#include "core/broadphase.hpp"
+#include "core/job_system.hpp"
+#include "core/map.hpp"
+#include "core/registry.hpp"
+
+struct Hit {
+    Entity shooter;
+    Entity victim;
+    int damage;
+    Position at;  // Where the bullet was
+};
+
+// One gameplay tick over every player in a registry, built as a task graph:
+//   movement -> bullet integration -> broadphase -> hit detection -> hit resolution
+// Each stage runs in parallel per player; results are merged in dense registry order,
+// so the outcome does not depend on the number of threads or their timing.
+class Simulation {
+   public:
+    Simulation(Registry& registry, const Map& map);
+
+    // Applies every player's current PlayerInput component for one tick of length dt
+    void tick(JobSystem& jobs, float dt);
+
+    // Hits resolved by the last tick, in deterministic order
+    const std::vector<Hit>& getHits() const;
+
+    // Predicting clients still drop bullets that hit, but leave health to the authority
+    void setResolveDamage(bool resolve);
+
+    // Under load the hit grid can be rebuilt every few ticks instead of every tick. Players go in
+    // with slack for how far they can move until the next rebuild, so hits stay exact.
+    void setBroadphaseInterval(int ticks);
+    void invalidateBroadphase();  // After players were moved or revived outside a tick
+
+   private:
+    void buildGraph();
+    void movePlayers(JobSystem& jobs);
+    void integrateBullets(JobSystem& jobs);
+    void buildBroadphase();
+    void detectHits(JobSystem& jobs);
+    void resolveHits();
+
+    // Dense ranges below this size are not worth splitting across threads
+    static constexpr size_t PLAYERS_PER_JOB = 8;
+
+    Registry& registry;
+    const Map& map;
+    float tickDt;
+    bool resolveDamage;
+
+    TaskGraph graph;
+    Broadphase broadphase;
+    int broadphaseInterval;
+    int ticksSinceBroadphase;
+    std::vector<Entity> broadphaseEntities;  // Dense order the grid was built for
+
+    std::vector<std::vector<Hit>> hitsByShooter;  // Indexed by the shooter's dense index
+    std::vector<Hit> hits;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "core/tick_watchdog.hpp"
+
+#include <iostream>
+
+namespace {
+constexpr float SMOOTHING = 1.0f / 16.0f;  // Weight of the newest tick in the moving average
+}  // namespace
+
+const char* describeLoadLevel(LoadLevel level) {
+    switch (level) {
+        case LoadLevel::NORMAL:
+            return "normal";
+        case LoadLevel::DISTANT_HALF_RATE:
+            return "distant players at half rate";
+        case LoadLevel::COARSE_BROADPHASE:
+            return "hit grid rebuilt every other tick";
+        case LoadLevel::SPECTATORS_HALF_RATE:
+            return "spectators at half rate";
+    }
+    return "unknown";
+}
+
+TickWatchdog::TickWatchdog(const std::string& watchdogName, std::chrono::nanoseconds budget)
+    : name(watchdogName),
+      budgetNs(static_cast<double>(budget.count() > 0 ? budget.count() : 1)),
+      load(0.0f),
+      level(LoadLevel::NORMAL),
+      ticksAtLevel(0),
+      overruns(0),
+      steps(0) {}
+
+bool TickWatchdog::record(std::chrono::nanoseconds tickTime) {
+    float share = static_cast<float>(tickTime.count() / budgetNs);
+    load += (share - load) * SMOOTHING;
+    if (share > 1.0f) {
+        overruns++;
+    }
+    ticksAtLevel++;
+
+    int current = static_cast<int>(level);
+    if (load > OVERLOADED && ticksAtLevel >= HOLD_TICKS && current + 1 < LOAD_LEVEL_COUNT) {
+        step(1);
+        return true;
+    }
+    if (load < RELAXED && ticksAtLevel >= RECOVER_TICKS && current > 0) {
+        step(-1);
+        return true;
+    }
+    return false;
+}
+
+void TickWatchdog::step(int direction) {
+    level = static_cast<LoadLevel>(static_cast<int>(level) + direction);
+    ticksAtLevel = 0;
+    steps++;
+    std::cout << name << (direction > 0 ? " overloaded" : " recovered") << " (ticks at " << static_cast<int>(load * 100.0f)
+              << "% of budget), load level " << static_cast<int>(level) << ": " << describeLoadLevel(level) << std::endl;
+}
+
+LoadLevel TickWatchdog::getLevel() const {
+    return level;
+}
+
+float TickWatchdog::getLoad() const {
+    return load;
+}
+
+unsigned long TickWatchdog::getOverrunCount() const {
+    return overruns;
+}
+
+unsigned long TickWatchdog::getStepCount() const {
+    return steps;
+}
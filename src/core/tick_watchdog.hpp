@@ -0,0 +1,52 @@
+#ifndef TICK_WATCHDOG_HPP
+#define TICK_WATCHDOG_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Steps of load shedding, mildest first. Each step keeps what the ones before it shed.
+enum class LoadLevel : uint8_t {
+    NORMAL,
+    DISTANT_HALF_RATE,     // Players far from a member reach it every other tick
+    COARSE_BROADPHASE,     // The hit grid is rebuilt every other tick, with slack for the movement in between
+    SPECTATORS_HALF_RATE,  // Spectators get every other frame
+};
+constexpr int LOAD_LEVEL_COUNT = static_cast<int>(LoadLevel::SPECTATORS_HALF_RATE) + 1;
+
+const char* describeLoadLevel(LoadLevel level);
+
+// Measures every tick against its budget and moves the load level one step at a time: up while
+// ticks keep running close to or over the budget, down again once they have been comfortably
+// inside it for a while. The load is a moving average, so a single slow tick moves nothing, and a
+// level is held for a while before the next change so the steps can't oscillate. Every change is logged.
+class TickWatchdog {
+   public:
+    static constexpr float OVERLOADED = 0.9f;       // Average share of the budget that sheds another step
+    static constexpr float RELAXED = 0.5f;          // Average share of the budget that restores one
+    static constexpr uint32_t HOLD_TICKS = 60;      // Ticks at a level before shedding further
+    static constexpr uint32_t RECOVER_TICKS = 300;  // Ticks at a level before recovering a step
+
+    TickWatchdog(const std::string& name, std::chrono::nanoseconds budget);
+
+    // Once per tick with how long it took; true when the level changed
+    bool record(std::chrono::nanoseconds tickTime);
+
+    LoadLevel getLevel() const;
+    float getLoad() const;  // Moving average of tick time over budget
+    unsigned long getOverrunCount() const;
+    unsigned long getStepCount() const;
+
+   private:
+    void step(int direction);
+
+    std::string name;
+    double budgetNs;
+    float load;
+    LoadLevel level;
+    uint32_t ticksAtLevel;
+    unsigned long overruns;
+    unsigned long steps;
+};
+
+#endif
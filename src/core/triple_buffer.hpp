@@ -0,0 +1,47 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the newest complete value from one producer thread to one consumer thread without locks.
+//
+// Of the three slots the producer owns one (back), the consumer owns one (front) and the third
+// (middle) is in flight. publish() swaps back and middle in one atomic exchange and marks the
+// middle fresh; acquire() swaps a fresh middle with front. Neither side ever waits for the other
+// and the consumer only ever sees whole values. Values the consumer is too slow for are skipped,
+// never queued. Slots are reused, so a T built on vectors stops allocating once warm.
+template <typename T>
+class TripleBuffer {
+   public:
+    TripleBuffer() : middle(2), backIndex(1), frontIndex(0) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer: fill back(), then publish() it. The slot back() returns afterwards holds an older value.
+    T& back() { return slots[backIndex]; }
+    void publish() {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Consumer: true if front() now holds a value it hasn't seen. front() stays put until the next acquire().
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    T& front() { return slots[frontIndex]; }
+
+   private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    T slots[3];
+    std::atomic<uint8_t> middle;  // Slot index, plus FRESH while the consumer hasn't taken it
+    uint8_t backIndex;            // Producer only
+    uint8_t frontIndex;           // Consumer only
+};
+
+#endif
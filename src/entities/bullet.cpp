@@ -2,54 +2,96 @@
 
 #include <cstring>
 
-#include "core/constants.hpp"
 #include "raymath.h"
 
-Bullet::Bullet(Position startPos, Vector2 dir, float spd, Color clr)
-    : position(startPos), direction(Vector2Normalize(dir)), speed(spd), color(clr) {}
+namespace {
+// Indexed by ProjectileType
+constexpr ProjectileArchetype ARCHETYPES[] = {
+    {"rifle", 10.0f, 4, 10, 120, 0.0f, 1, 0.3f, RED},
+    {"shotgun", 9.0f, 3, 6, 30, 0.5f, 5, 0.8f, ORANGE},
+    {"sniper", 20.0f, 2, 35, 90, 0.0f, 1, 1.2f, PURPLE},
+};
+static_assert(sizeof(ARCHETYPES) / sizeof(ARCHETYPES[0]) == PROJECTILE_TYPE_COUNT, "One archetype per ProjectileType");
+
+constexpr bool withinMaxRadius() {
+    for (const ProjectileArchetype& archetype : ARCHETYPES) {
+        if (archetype.radius > Bullet::MAX_RADIUS) return false;
+    }
+    return true;
+}
+static_assert(withinMaxRadius(), "Bullet::MAX_RADIUS must cover every archetype");
+}  // namespace
+
+const ProjectileArchetype& Bullet::archetypeOf(uint8_t type) {
+    return ARCHETYPES[type < PROJECTILE_TYPE_COUNT ? type : 0];
+}
+
+Bullet::Bullet(Position startPos, Vector2 dir, uint8_t projectileType)
+    : position(startPos), direction(Vector2Normalize(dir)), age(0), type(projectileType < PROJECTILE_TYPE_COUNT ? projectileType : 0) {}
 
 void Bullet::update() {
+    float speed = getArchetype().speed;
     position.x += direction.x * speed;
     position.y += direction.y * speed;
+    if (age < UINT16_MAX) age++;
 }
 
 void Bullet::draw() const {
-    DrawCircle(position.x, position.y, radius, color);
+    const ProjectileArchetype& archetype = getArchetype();
+    DrawCircle(position.x, position.y, archetype.radius, archetype.color);
 }
 
-bool Bullet::isOffScreen() const {
-    return position.x < 0 || position.x > Constants::SCREEN_WIDTH || position.y < 0 || position.y > Constants::SCREEN_HEIGHT;
+bool Bullet::isOutside(int worldWidth, int worldHeight) const {
+    return position.x < 0 || position.x > worldWidth || position.y < 0 || position.y > worldHeight;
+}
+
+bool Bullet::isSpent() const {
+    return age >= getArchetype().lifetime;
 }
 
 Position Bullet::getPosition() const {
     return position;
 }
 
-std::vector<uint8_t> Bullet::serialize() const {
-    std::vector<uint8_t> buffer;
+Vector2 Bullet::getDirection() const {
+    return direction;
+}
+
+uint8_t Bullet::getType() const {
+    return type;
+}
+
+const ProjectileArchetype& Bullet::getArchetype() const {
+    return ARCHETYPES[type];
+}
+
+int Bullet::getRadius() const {
+    return getArchetype().radius;
+}
+
+void Bullet::serialize(uint8_t* out) const {
+    size_t offset = 0;
 
     // Serialize position
-    buffer.insert(buffer.end(), reinterpret_cast<const uint8_t*>(&position),
-                  reinterpret_cast<const uint8_t*>(&position) + sizeof(position));
+    std::memcpy(out + offset, &position, sizeof(position));
+    offset += sizeof(position);
 
     // Serialize direction
-    buffer.insert(buffer.end(), reinterpret_cast<const uint8_t*>(&direction),
-                  reinterpret_cast<const uint8_t*>(&direction) + sizeof(direction));
-
-    // Serialize speed
-    buffer.insert(buffer.end(), reinterpret_cast<const uint8_t*>(&speed), reinterpret_cast<const uint8_t*>(&speed) + sizeof(speed));
+    std::memcpy(out + offset, &direction, sizeof(direction));
+    offset += sizeof(direction);
 
-    // Serialize color
-    buffer.insert(buffer.end(), reinterpret_cast<const uint8_t*>(&color), reinterpret_cast<const uint8_t*>(&color) + sizeof(color));
+    // Serialize age, so a receiver knows how long the projectile has left
+    std::memcpy(out + offset, &age, sizeof(age));
+    offset += sizeof(age);
 
-    return buffer;
+    // Serialize type
+    out[offset] = type;
 }
 
 Bullet Bullet::deserialize(const uint8_t* data, size_t& offset) {
     Position pos;
     Vector2 dir;
-    float spd;
-    Color clr;
+    uint16_t bulletAge;
 
     // Deserialize position
     std::memcpy(&pos, data + offset, sizeof(pos));
@@ -59,13 +101,15 @@ Bullet Bullet::deserialize(const uint8_t* data, size_t& offset) {
     std::memcpy(&dir, data + offset, sizeof(dir));
     offset += sizeof(dir);
 
-    // Deserialize speed
-    std::memcpy(&spd, data + offset, sizeof(spd));
-    offset += sizeof(spd);
+    // Deserialize age
+    std::memcpy(&bulletAge, data + offset, sizeof(bulletAge));
+    offset += sizeof(bulletAge);
 
-    // Deserialize color
-    std::memcpy(&clr, data + offset, sizeof(clr));
-    offset += sizeof(clr);
+    // Deserialize type
+    uint8_t bulletType = data[offset];
+    offset += sizeof(bulletType);
 
-    return Bullet(pos, dir, spd, clr);
+    Bullet bullet(pos, dir, bulletType);
+    bullet.age = bulletAge;
+    return bullet;
 }
@@ -3,30 +3,61 @@
 
 #include <raylib.h>
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 
 #include "entities/position.hpp"
 
+// Everything about a kind of projectile that every projectile of that kind shares. A Bullet only
+// stores which kind it is, so the table below is the one place a weapon is defined.
+struct ProjectileArchetype {
+    const char* name;
+    float speed;        // Pixels per tick
+    int radius;
+    int damage;         // Per projectile that hits
+    uint16_t lifetime;  // Ticks before the projectile is spent, wherever it is
+    float spread;       // Radians between the outermost pellets of one shot
+    int pellets;        // Projectiles per shot, fanned evenly across the spread
+    float cooldown;     // Seconds between shots
+    Color color;
+};
+
+enum class ProjectileType : uint8_t {
+    RIFLE,
+    SHOTGUN,
+    SNIPER,
+};
+constexpr size_t PROJECTILE_TYPE_COUNT = static_cast<size_t>(ProjectileType::SNIPER) + 1;
+
 class Bullet {
    public:
-    Bullet(Position startPos, Vector2 dir, float speed, Color color);
+    static constexpr int MAX_RADIUS = 4;  // Of any archetype, for margins that must cover every projectile
+
+    // Unknown types, say from a malformed packet, read as the first archetype
+    static const ProjectileArchetype& archetypeOf(uint8_t type);
+
+    Bullet(Position startPos, Vector2 dir, uint8_t type);
 
     void update();
     void draw() const;
-    bool isOffScreen() const;
+    bool isOutside(int worldWidth, int worldHeight) const;
+    bool isSpent() const;  // Outlived its archetype's lifetime
     Position getPosition() const;
+    Vector2 getDirection() const;  // Unit vector
+    uint8_t getType() const;
+    const ProjectileArchetype& getArchetype() const;
+    int getRadius() const;
 
     // Serialization and deserialization methods
-    std::vector<uint8_t> serialize() const;
+    static constexpr size_t SERIALIZED_SIZE = sizeof(Position) + sizeof(Vector2) + sizeof(uint16_t) + sizeof(uint8_t);
+    void serialize(uint8_t* out) const;  // Writes exactly SERIALIZED_SIZE bytes
     static Bullet deserialize(const uint8_t* data, size_t& offset);
 
    private:
     Position position;
     Vector2 direction;
-    float speed;
-    Color color;
-    float radius = 4;
+    uint16_t age;  // Ticks since it was fired
+    uint8_t type;  // Index into the archetype table
 };
 
 #endif
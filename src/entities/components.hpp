@@ -0,0 +1,57 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <raylib.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "entities/bullet.hpp"
+#include "entities/position.hpp"
+
+// Plain data components stored densely by the Registry
+
+enum class PlayerShape {
+    CIRCLE,
+    SQUARE,
+};
+
+struct Transform {
+    Position position;
+    Position facing;  // Last non-zero movement direction, used for aiming
+    int radius;
+    int speed;
+};
+
+struct Health {
+    int current;
+    int max;
+    bool changed;
+};
+
+struct Weapon {
+    uint8_t type;  // ProjectileType it fires; the archetype decides the cooldown
+    float timeSinceLastShot;
+    uint8_t shots;                // Times it fired, wrapping; changes only when it fires
+    std::vector<Bullet> bullets;  // Live bullets owned by this player
+};
+
+// What the player is asking to do this tick, from the keyboard or the network
+struct PlayerInput {
+    Position direction;  // Each axis -1, 0 or 1
+    bool fire;
+    uint8_t select = 0;  // 0 keeps the weapon, otherwise switches to ProjectileType select - 1
+};
+
+struct NetworkId {
+    static constexpr uint16_t LOCAL = 0xFFFF;
+
+    uint16_t peer;  // Peer slot the player's updates arrive from, LOCAL for this machine's player
+};
+
+struct Appearance {
+    Color color;
+    PlayerShape shape;
+};
+
+#endif
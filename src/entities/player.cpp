@@ -5,90 +5,89 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <utility>
 
 #include "core/constants.hpp"
 #include "core/map.hpp"
 
-Player::Player(int spd, Color clr, int rad, PlayerShape shp) {
-    position = {Constants::SCREEN_WIDTH / 2, Constants::SCREEN_HEIGHT / 2};
-    speed = spd;
-    color = clr;
-    radius = rad;
-    shape = shp;
-
-    lastDirection = {0, -1};
-    shootCooldown = 0.3f;
-    timeSinceLastShot = shootCooldown;
-
-    // Initialize health
-    maxHealth = 100;
-    health = maxHealth;
-    healthChanged = false;
-}
+Player::Player(Registry& reg, Entity ent) : registry(&reg), entity(ent) {}
 
 Player::~Player() {
     // Destructor implementation
 }
 
-void Player::move() {
-    if (!isAlive()) {
-        return;  // Dead players cannot move
-    }
-
-    timeSinceLastShot += GetFrameTime();
+Entity Player::spawn(Registry& registry, NetworkId networkId, int spd, Color clr, int rad, PlayerShape shp) {
+    Transform transform;
+    transform.position = {Constants::WORLD_WIDTH / 2, Constants::WORLD_HEIGHT / 2};
+    transform.facing = {0, -1};
+    transform.radius = rad;
+    transform.speed = spd;
 
-    Position input = getInput();
+    // Initialize health
+    Health health;
+    health.max = 100;
+    health.current = health.max;
+    health.changed = false;
 
-    if (input.x != 0 || input.y != 0) {
-        lastDirection = input;
-    }
+    Weapon weapon;
+    weapon.type = static_cast<uint8_t>(ProjectileType::RIFLE);
+    weapon.timeSinceLastShot = Bullet::archetypeOf(weapon.type).cooldown;
+    weapon.shots = 0;
 
-    Position newPos = {position.x + input.x * speed, position.y + input.y * speed};
+    return registry.spawn(transform, health, std::move(weapon), networkId, Appearance{clr, shp});
+}
 
-    newPos.x = std::max(radius, std::min(newPos.x, Constants::SCREEN_WIDTH - radius));
-    newPos.y = std::max(radius, std::min(newPos.y, Constants::SCREEN_HEIGHT - radius));
+Entity Player::getEntity() const {
+    return entity;
+}
 
-    position = newPos;
+void Player::move() {
+    move(nullptr, sampleInput(), GetFrameTime());
 }
 
 void Player::move(const Map* map) {
+    move(map, sampleInput(), GetFrameTime());
+}
+
+void Player::move(const Map* map, const PlayerInput& input, float dt) {
     if (!isAlive()) {
         return;  // Dead players cannot move
     }
 
-    timeSinceLastShot += GetFrameTime();
+    Transform& transform = registry->getTransform(entity);
+    Weapon& weapon = registry->getWeapon(entity);
+    weapon.timeSinceLastShot += dt;
 
-    Position input = getInput();
-
-    if (input.x != 0 || input.y != 0) {
-        lastDirection = input;
+    // The selection is absolute, so replaying a command selects the same weapon again
+    if (input.select > 0 && input.select <= PROJECTILE_TYPE_COUNT) {
+        weapon.type = static_cast<uint8_t>(input.select - 1);
+    }
+    if (input.fire) {
+        shoot();
     }
 
-    Position newPos = {position.x + input.x * speed, position.y + input.y * speed};
-
-    // Check collision with map obstacles before moving
-    if (map && map->isPlayerColliding(newPos, radius)) {
-        // Try moving only horizontally
-        Position horizontalPos = {position.x + input.x * speed, position.y};
-        if (!map->isPlayerColliding(horizontalPos, radius)) {
-            newPos = horizontalPos;
-        } else {
-            // Try moving only vertically
-            Position verticalPos = {position.x, position.y + input.y * speed};
-            if (!map->isPlayerColliding(verticalPos, radius)) {
-                newPos = verticalPos;
-            } else {
-                // Can't move in either direction, stay in place
-                newPos = position;
-            }
-        }
+    Position direction = input.direction;
+    if (direction.x != 0 || direction.y != 0) {
+        transform.facing = direction;
     }
 
-    // Keep player within screen bounds
-    newPos.x = std::max(radius, std::min(newPos.x, Constants::SCREEN_WIDTH - radius));
-    newPos.y = std::max(radius, std::min(newPos.y, Constants::SCREEN_HEIGHT - radius));
+    Position position = transform.position;
+    int speed = transform.speed;
+    int radius = transform.radius;
+    Position delta = {direction.x * speed, direction.y * speed};
 
-    position = newPos;
+    // Sweep against the map's obstacles and slide along whatever we run into
+    Position newPos = map ? map->moveCircle(position, radius, delta) : Position{position.x + delta.x, position.y + delta.y};
+
+    // Keep player within world bounds
+    int worldWidth = map ? map->getWidth() : Constants::WORLD_WIDTH;
+    int worldHeight = map ? map->getHeight() : Constants::WORLD_HEIGHT;
+    newPos.x = std::max(radius, std::min(newPos.x, worldWidth - radius));
+    newPos.y = std::max(radius, std::min(newPos.y, worldHeight - radius));
+
+    transform.position = newPos;
 }
 
 void Player::attack() {
@@ -96,39 +95,59 @@ void Player::attack() {
 }
 
 void Player::draw() {
+    const float everywhere = std::numeric_limits<float>::max();
+    draw(WorldRect{-everywhere, -everywhere, everywhere, everywhere});
+}
+
+void Player::draw(const WorldRect& view) {
     if (isAlive()) {
-        if (shape == PlayerShape::CIRCLE) {
-            DrawCircle(position.x, position.y, radius, color);
-        } else if (shape == PlayerShape::SQUARE) {
-            DrawRectangle(position.x - radius, position.y - radius, radius * 2, radius * 2, color);
+        const Transform& transform = registry->getTransform(entity);
+        const Appearance& appearance = registry->getAppearance(entity);
+        Position position = transform.position;
+        int radius = transform.radius;
+
+        // A square's corners reach further than its radius, by less than the next whole radius
+        if (view.overlaps(static_cast<float>(position.x), static_cast<float>(position.y), radius * 1.5f)) {
+            if (appearance.shape == PlayerShape::CIRCLE) {
+                DrawCircle(position.x, position.y, radius, appearance.color);
+            } else if (appearance.shape == PlayerShape::SQUARE) {
+                DrawRectangle(position.x - radius, position.y - radius, radius * 2, radius * 2, appearance.color);
+            }
         }
-        this->drawBullets();
+        // Bullets travel away from their shooter, so they are culled one by one
+        this->drawBullets(view);
     }
-    // Dead players are not drawn at all - they become invisible
+    // Dead players are not drawn at all; ParticleEffects marks the death with a burst
 }
 
-Position Player::getInput() {
-    Position input = {0, 0};
+PlayerInput Player::sampleInput() const {
+    PlayerInput input = {{0, 0}, false};
 
     if (!isAlive()) {
         return input;  // Dead players cannot receive input
     }
 
-    if (IsKeyDown(KEY_W)) input.y = -1;
-    if (IsKeyDown(KEY_S)) input.y = 1;
-    if (IsKeyDown(KEY_A)) input.x = -1;
-    if (IsKeyDown(KEY_D)) input.x = 1;
+    if (IsKeyDown(KEY_W)) input.direction.y = -1;
+    if (IsKeyDown(KEY_S)) input.direction.y = 1;
+    if (IsKeyDown(KEY_A)) input.direction.x = -1;
+    if (IsKeyDown(KEY_D)) input.direction.x = 1;
 
-    if (IsKeyDown(KEY_SPACE)) {
-        shoot();
-    }
+    input.fire = IsKeyDown(KEY_SPACE);
+
+    // Number keys pick the weapon
+    if (IsKeyDown(KEY_ONE)) input.select = 1 + static_cast<uint8_t>(ProjectileType::RIFLE);
+    if (IsKeyDown(KEY_TWO)) input.select = 1 + static_cast<uint8_t>(ProjectileType::SHOTGUN);
+    if (IsKeyDown(KEY_THREE)) input.select = 1 + static_cast<uint8_t>(ProjectileType::SNIPER);
 
     return input;
 }
 
 void Player::shoot() {
-    if (timeSinceLastShot >= shootCooldown) {
-        Vector2 dir = {static_cast<float>(lastDirection.x), static_cast<float>(lastDirection.y)};
+    Weapon& weapon = registry->getWeapon(entity);
+    const ProjectileArchetype& archetype = Bullet::archetypeOf(weapon.type);
+    if (weapon.timeSinceLastShot >= archetype.cooldown) {
+        const Transform& transform = registry->getTransform(entity);
+        Vector2 dir = {static_cast<float>(transform.facing.x), static_cast<float>(transform.facing.y)};
 
         float len = std::sqrt(dir.x * dir.x + dir.y * dir.y);
         if (len != 0) {
@@ -136,22 +155,35 @@ void Player::shoot() {
             dir.y /= len;
         }
 
-        bullets.emplace_back(position, dir, 10.0f, RED);
-        timeSinceLastShot = 0.0f;
+        // Pellets fan out evenly rather than randomly, so the authority and a predicting client agree
+        for (int pellet = 0; pellet < archetype.pellets; ++pellet) {
+            float angle = archetype.pellets > 1 ? archetype.spread * (static_cast<float>(pellet) / (archetype.pellets - 1) - 0.5f) : 0.0f;
+            float c = std::cos(angle);
+            float s = std::sin(angle);
+            weapon.bullets.emplace_back(transform.position, Vector2{dir.x * c - dir.y * s, dir.x * s + dir.y * c}, weapon.type);
+        }
+        weapon.timeSinceLastShot = 0.0f;
+        weapon.shots++;
     }
 }
 
 void Player::updateBullets() {
+    std::vector<Bullet>& bullets = registry->getWeapon(entity).bullets;
     if (!isAlive()) {
         bullets.clear();  // Clear all bullets when player dies
         return;
     }
 
     for (auto& b : bullets) b.update();
-    bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [](const Bullet& b) { return b.isOffScreen(); }), bullets.end());
+    bullets.erase(std::remove_if(bullets.begin(), bullets.end(),
+                                 [](const Bullet& b) {
+                                     return b.isSpent() || b.isOutside(Constants::WORLD_WIDTH, Constants::WORLD_HEIGHT);
+                                 }),
+                  bullets.end());
 }
 
 void Player::updateBullets(const Map* map) {
+    std::vector<Bullet>& bullets = registry->getWeapon(entity).bullets;
     if (!isAlive()) {
         bullets.clear();  // Clear all bullets when player dies
         return;
@@ -159,13 +191,15 @@ void Player::updateBullets(const Map* map) {
 
     for (auto& b : bullets) b.update();
 
-    // Remove bullets that are off screen or hit obstacles
+    // Remove bullets that are spent, left the world or hit obstacles
+    int worldWidth = map ? map->getWidth() : Constants::WORLD_WIDTH;
+    int worldHeight = map ? map->getHeight() : Constants::WORLD_HEIGHT;
     bullets.erase(std::remove_if(bullets.begin(), bullets.end(),
-                                 [map](const Bullet& b) {
-                                     if (b.isOffScreen()) {
+                                 [map, worldWidth, worldHeight](const Bullet& b) {
+                                     if (b.isSpent() || b.isOutside(worldWidth, worldHeight)) {
                                          return true;
                                      }
-                                     if (map && map->isBulletColliding(b.getPosition(), 4)) {  // 4 is bullet radius
+                                     if (map && map->isBulletColliding(b.getPosition(), b.getRadius())) {
                                          return true;
                                      }
                                      return false;
@@ -173,66 +207,92 @@ void Player::updateBullets(const Map* map) {
                   bullets.end());
 }
 
-void Player::drawBullets() const {
-    for (const auto& b : bullets) b.draw();
+void Player::drawBullets(const WorldRect& view) const {
+    for (const auto& b : getBullets()) {
+        Position position = b.getPosition();
+        if (view.overlaps(static_cast<float>(position.x), static_cast<float>(position.y), b.getRadius())) b.draw();
+    }
 }
 
 const std::vector<Bullet>& Player::getBullets() const {
-    return bullets;
+    return registry->getWeapon(entity).bullets;
+}
+
+void Player::setBullets(const std::pmr::vector<Bullet>& newBullets) {
+    registry->getWeapon(entity).bullets.assign(newBullets.begin(), newBullets.end());
+}
+
+uint8_t Player::getShotCount() const {
+    return registry->getWeapon(entity).shots;
+}
+
+void Player::setShotCount(uint8_t shots) {
+    registry->getWeapon(entity).shots = shots;
+}
+
+void Player::clearBullets() {
+    registry->getWeapon(entity).bullets.clear();
 }
 
-void Player::setBullets(const std::vector<Bullet>& newBullets) {
-    bullets = newBullets;
+int Player::removeBulletsHitting(const Player& target) {
+    std::vector<Bullet>& bullets = registry->getWeapon(entity).bullets;
+    auto hit = std::remove_if(bullets.begin(), bullets.end(), [&target](const Bullet& b) { return target.isCollidingWith(b); });
+    int hits = static_cast<int>(std::distance(hit, bullets.end()));
+    bullets.erase(hit, bullets.end());
+    return hits;
 }
 
 Position Player::getPosition() const {
-    return position;
+    return registry->getTransform(entity).position;
 }
 
 void Player::setPosition(Position newPos) {
-    position = newPos;
+    registry->getTransform(entity).position = newPos;
 }
 
 int Player::getHealth() const {
-    return health;
+    return registry->getHealth(entity).current;
 }
 
 void Player::setHealth(int newHealth) {
-    int oldHealth = health;
-    health = std::max(0, std::min(newHealth, maxHealth));
-    if (oldHealth != health) {
-        healthChanged = true;
+    Health& health = registry->getHealth(entity);
+    int oldHealth = health.current;
+    health.current = std::max(0, std::min(newHealth, health.max));
+    if (oldHealth != health.current) {
+        health.changed = true;
     }
 }
 
 void Player::takeDamage(int damage) {
-    int oldHealth = health;
-    health = std::max(0, health - damage);
-    if (oldHealth != health) {
-        healthChanged = true;
+    Health& health = registry->getHealth(entity);
+    int oldHealth = health.current;
+    health.current = std::max(0, health.current - damage);
+    if (oldHealth != health.current) {
+        health.changed = true;
     }
 }
 
 bool Player::isAlive() const {
-    return health > 0;
+    return registry->getHealth(entity).current > 0;
 }
 
 bool Player::isCollidingWith(const Bullet& bullet) const {
+    const Transform& transform = registry->getTransform(entity);
     Position bulletPos = bullet.getPosition();
-    int dx = bulletPos.x - position.x;
-    int dy = bulletPos.y - position.y;
-    float distance = std::sqrt(dx * dx + dy * dy);
-    return distance <= (radius + 4);  // 4 is bullet radius
+    int dx = bulletPos.x - transform.position.x;
+    int dy = bulletPos.y - transform.position.y;
+    int reach = transform.radius + bullet.getRadius();
+    return dx * dx + dy * dy <= reach * reach;  // Compare squared distances, no sqrt needed
 }
 
 int Player::getRadius() const {
-    return radius;
+    return registry->getTransform(entity).radius;
 }
 
 bool Player::hasHealthChanged() const {
-    return healthChanged;
+    return registry->getHealth(entity).changed;
 }
 
 void Player::clearHealthChangeFlag() {
-    healthChanged = false;
+    registry->getHealth(entity).changed = false;
 }
@@ -3,29 +3,37 @@
 
 #include <raylib.h>
 
+#include <memory_resource>
 #include <vector>
 
+#include "core/camera.hpp"
+#include "core/registry.hpp"
 #include "entities/bullet.hpp"
 #include "entities/character.hpp"
+#include "entities/components.hpp"
 #include "entities/position.hpp"
 
 // Forward declaration
 class Map;
 
-enum class PlayerShape {
-    CIRCLE,
-    SQUARE,
-};
-
+// Lightweight handle over one player's components in a Registry.
+// Cheap to construct on demand; the state itself lives in the registry's dense arrays.
 class Player : public Character {
    public:
-    Player(int spd, Color clr, int rad, PlayerShape shp);
+    Player(Registry& registry, Entity entity);
     ~Player() override;
 
+    static Entity spawn(Registry& registry, NetworkId networkId, int spd, Color clr, int rad, PlayerShape shp);
+
+    Entity getEntity() const;
+
     void move() override;
     void move(const Map* map);  // Overloaded move with collision detection
+    // Applies one tick of input; the keyboard overloads above sample input and forward here
+    void move(const Map* map, const PlayerInput& input, float dt);
     void attack() override;
     void draw() override;
+    void draw(const WorldRect& view);  // Overloaded draw that skips the player and bullets out of view
 
     Position getPosition() const;
     void setPosition(Position newPos);
@@ -33,9 +41,13 @@ class Player : public Character {
     void shoot();
     void updateBullets();
     void updateBullets(const Map* map);  // Overloaded updateBullets with collision detection
-    void drawBullets() const;
+    void drawBullets(const WorldRect& view) const;
     const std::vector<Bullet>& getBullets() const;
-    void setBullets(const std::vector<Bullet>& newBullets);
+    void setBullets(const std::pmr::vector<Bullet>& newBullets);  // Copies in place, keeping existing capacity
+    uint8_t getShotCount() const;                                 // Shots fired, wrapping
+    void setShotCount(uint8_t shots);                             // A remote player's count, from the authority
+    void clearBullets();
+    int removeBulletsHitting(const Player& target);  // Returns the number of bullets that hit
 
     // Health system
     int getHealth() const;
@@ -49,25 +61,12 @@ class Player : public Character {
     bool isCollidingWith(const Bullet& bullet) const;
     int getRadius() const;
 
-   protected:
-    Position getInput();
+    // Keyboard state for this frame, all zero for dead players
+    PlayerInput sampleInput() const;
 
-    Position position;
-    int speed;
-    int radius;
-    Color color;
-    PlayerShape shape;
-
-    Position lastDirection;
-    float shootCooldown;
-    float timeSinceLastShot;
-
-    std::vector<Bullet> bullets;
-
-    // Health properties
-    int health;
-    int maxHealth;
-    mutable bool healthChanged;
+   protected:
+    Registry* registry;
+    Entity entity;
 };
 
 #endif
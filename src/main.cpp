@@ -2,17 +2,103 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
+#include "bench/benchmark.hpp"
 #include "core/game.hpp"
+#include "network/client/spectator.hpp"
+#include "network/compression.hpp"
+#include "network/netsim/scenarios.hpp"
+#include "network/netsim/udp_proxy.hpp"
+#include "network/network_config.hpp"
+#include "network/server/relay.hpp"
+#include "network/server/server.hpp"
+
+namespace {
+// The options into config, printing the first that doesn't apply
+template <typename Config>
+bool configure(Config& config, const ConfigOptions::Options& options) {
+    std::string error;
+    if (ConfigOptions::applyOptions(config, options, error)) return true;
+    std::cerr << error << std::endl;
+    return false;
+}
+}  // namespace
 
 int main(int argc, char** argv) {
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " [host|client]" << std::endl;
+    if (argc >= 2 && std::string(argv[1]) == "bench") {
+        return runBenchmarks(argc >= 3 ? argv[2] : "");
+    }
+    if (argc >= 4 && std::string(argv[1]) == "train") {
+        // Compression model from traffic recorded with --compression-record
+        return Compression::train(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+    }
+
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " [host|client|server|spectate|relay|proxy|netsim] [--config=FILE] [--key=value ...]"
+                  << std::endl;
+        std::cout << "       " << argv[0] << " bench [name]" << std::endl;
+        std::cout << "       " << argv[0] << " train MODEL RECORDING..." << std::endl;
         return 1;
     }
 
     std::string role = argv[1];
-    Game game(role == "host");
+    if (role != "host" && role != "client" && role != "server" && role != "spectate" && role != "relay" && role != "proxy" &&
+        role != "netsim") {
+        std::cout << "Unknown role: " << role << std::endl;
+        return 1;
+    }
+
+    ConfigOptions::Options options;
+    std::string error;
+    if (!ConfigOptions::load(argc, argv, 2, options, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if (role == "server") {
+        // Dedicated multi-match server, no window
+        MatchServerConfig config;
+        if (!configure(config, options)) return 1;
+        runServer(config);
+        return 0;
+    }
+
+    if (role == "spectate") {
+        // Watch a match through the server or a relay, e.g. --server=10.0.0.5 --match=3
+        SpectatorConfig config;
+        if (!configure(config, options)) return 1;
+        runSpectator(config);
+        return 0;
+    }
+
+    if (role == "relay") {
+        // Spectator fan-out in front of a server, no window, e.g. --server=10.0.0.5 --listen=1240 --peers=2000
+        RelayConfig config;
+        if (!configure(config, options)) return 1;
+        runRelay(config);
+        return 0;
+    }
+
+    if (role == "proxy") {
+        // Impaired link between clients and a server, e.g. --port=1234 --delay=50 --loss=2
+        ProxyConfig config;
+        if (!configure(config, options)) return 1;
+        runProxy(config);
+        return 0;
+    }
+
+    if (role == "netsim") {
+        // Scripted clients against a local server through the proxy, no window
+        ScenarioConfig config;
+        if (!configure(config, options)) return 1;
+        return runScenarios(config);
+    }
+
+    NetworkConfig config;
+    if (!configure(config, options)) return 1;
+
+    Game game(role == "host", config);
     game.start();
     return 0;
 }
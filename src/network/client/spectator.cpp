@@ -0,0 +1,199 @@
+#include "network/client/spectator.hpp"
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+
+#include "core/camera.hpp"
+#include "core/constants.hpp"
+#include "core/map.hpp"
+#include "core/particles.hpp"
+#include "entities/player.hpp"
+#include "network/compression.hpp"
+#include "network/packet_pool.hpp"
+#include "network/protocol.hpp"
+
+namespace {
+// Walks the frame once without touching anything; true when every record fits exactly
+bool isWellFormed(const uint8_t* data, size_t length) {
+    if (!Schema::matches<Protocol::SpectateMessage>(data, length)) return false;
+
+    uint16_t playerCount = Protocol::SpectateMessage::get<1>(data);
+    size_t offset = Protocol::SpectateMessage::SIZE;
+    for (uint16_t i = 0; i < playerCount; ++i) {
+        if (length - offset < Protocol::SpectatePlayer::SIZE) return false;
+
+        uint16_t bulletCount = Protocol::SpectatePlayer::get<4>(data + offset);
+        offset += Protocol::SpectatePlayer::SIZE;
+        if ((length - offset) / Bullet::SERIALIZED_SIZE < bulletCount) return false;
+        offset += bulletCount * Bullet::SERIALIZED_SIZE;
+    }
+    return offset == length;
+}
+}  // namespace
+
+bool SpectatorConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "match") {
+        uint32_t request = 0;
+        if (!ConfigOptions::parseField(key, value, Protocol::MAX_MATCH_REQUEST, request, error)) return false;
+        match = request + 1;
+        return true;
+    }
+    return network.set(key, value, error);
+}
+
+bool applySpectatorFrame(Registry& registry, const uint8_t* data, size_t length) {
+    if (!isWellFormed(data, length)) {
+        return false;
+    }
+
+    uint16_t playerCount = Protocol::SpectateMessage::get<1>(data);
+    size_t offset = Protocol::SpectateMessage::SIZE;
+
+    std::vector<uint16_t> present;
+    std::pmr::vector<Bullet> bullets;
+    for (uint16_t i = 0; i < playerCount; ++i) {
+        uint16_t owner;
+        float x, y;
+        int32_t health;
+        uint16_t bulletCount;
+        Protocol::SpectatePlayer::read(data + offset, owner, x, y, health, bulletCount);
+        offset += Protocol::SpectatePlayer::SIZE;
+
+        bullets.clear();
+        for (uint16_t b = 0; b < bulletCount; ++b) {
+            bullets.push_back(Bullet::deserialize(data, offset));
+        }
+
+        Entity entity = registry.findByNetworkId(owner);
+        if (entity == NULL_ENTITY) {
+            Color color = owner == Protocol::OWNER_HOST ? BLUE : RED;
+            entity = Player::spawn(registry, NetworkId{owner}, 5, color, 10, PlayerShape::CIRCLE);
+        }
+        Player player(registry, entity);
+        player.setPosition({static_cast<int>(x), static_cast<int>(y)});
+        player.setHealth(health);
+        player.clearHealthChangeFlag();
+        player.setBullets(bullets);
+        present.push_back(owner);
+    }
+
+    // Players missing from the frame have left
+    std::vector<Entity> gone;
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (std::find(present.begin(), present.end(), networkIds[i].peer) == present.end()) gone.push_back(entities[i]);
+    }
+    for (Entity entity : gone) {
+        registry.despawn(entity);
+    }
+    return true;
+}
+
+void runSpectator(const SpectatorConfig& config) {
+    std::string error;
+    if (!config.network.validate(error)) {
+        std::cerr << "Invalid network config: " << error << std::endl;
+        return;
+    }
+
+    ENetAddress address;
+    if (!config.network.resolveServerAddress(address)) {
+        std::cerr << "Cannot resolve server address " << config.network.serverAddress << std::endl;
+        return;
+    }
+
+    if (PacketPool::initialize() != 0) {
+        std::cerr << "Failed to initialize ENet." << std::endl;
+        return;
+    }
+
+    const NetworkConfig& network = config.network;
+    ENetHost* host = enet_host_create(nullptr, 1, network.channelCount, network.peerIncomingBandwidth, network.peerOutgoingBandwidth);
+    if (!host || !Compression::install(host, network)) {
+        std::cerr << "Failed to create ENet client." << std::endl;
+        if (host) enet_host_destroy(host);
+        enet_deinitialize();
+        return;
+    }
+    enet_host_connect(host, &address, network.channelCount, Protocol::connectData(Protocol::CONNECT_SPECTATOR, config.match));
+    std::cout << "Connecting to " << network.serverAddress << ":" << network.port << " as a spectator..." << std::endl;
+
+    InitWindow(Constants::SCREEN_WIDTH, Constants::SCREEN_HEIGHT, "2d-shooter (spectating)");
+    SetTargetFPS(60);
+
+    Map map;
+    // An overview of the whole world rather than one player's view of it
+    FollowCamera camera(Constants::SCREEN_WIDTH, Constants::SCREEN_HEIGHT);
+    camera.fit(map.getWidth(), map.getHeight());
+    const WorldRect view = camera.getView();
+    Registry registry;
+    ParticleEffects effects;
+    bool connected = false;
+    uint32_t frameTick = 0;
+    while (!WindowShouldClose()) {
+        // Only the newest frame matters; older ones that arrived in the same frame are skipped
+        ENetPacket* newest = nullptr;
+        ENetEvent event;
+        while (enet_host_service(host, &event, 0) > 0) {
+            if (event.type == ENET_EVENT_TYPE_CONNECT) {
+                connected = true;
+            } else if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
+                if ((event.data & ~Protocol::VERSION_MASK) == Protocol::DISCONNECT_VERSION) {
+                    std::cerr << "The server speaks protocol version " << (event.data & Protocol::VERSION_MASK) << ", this build "
+                              << int(Protocol::PROTOCOL_VERSION) << std::endl;
+                }
+                connected = false;
+                registry.clear();
+            } else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+                if (event.channelID == Protocol::CHANNEL_SPECTATE &&
+                    Schema::matches<Protocol::SpectateMessage>(event.packet->data, event.packet->dataLength)) {
+                    if (newest) enet_packet_destroy(newest);
+                    newest = event.packet;
+                } else {
+                    enet_packet_destroy(event.packet);
+                }
+            }
+        }
+        if (newest) {
+            if (applySpectatorFrame(registry, newest->data, newest->dataLength)) {
+                frameTick = Protocol::SpectateMessage::get<0>(newest->data);
+            }
+            enet_packet_destroy(newest);
+        }
+        effects.observe(registry);
+        effects.update(GetFrameTime());
+
+        BeginDrawing();
+        ClearBackground(RAYWHITE);
+        BeginMode2D(camera.get());
+        map.draw(view);
+        for (Entity entity : registry.getEntities()) {
+            Player(registry, entity).draw(view);
+        }
+        effects.draw();
+        EndMode2D();
+
+        const char* status = nullptr;
+        if (!connected) {
+            status = "Connecting...";
+        } else if (registry.size() == 0) {
+            status = "Waiting for the match (spectators are delayed)...";
+        }
+        if (status) {
+            int textWidth = MeasureText(status, 20);
+            DrawText(status, Constants::SCREEN_WIDTH / 2 - textWidth / 2, Constants::SCREEN_HEIGHT / 2 - 100, 20, DARKGRAY);
+        } else {
+            DrawText(TextFormat("SPECTATING  %d players  tick %u", static_cast<int>(registry.size()), frameTick), 10, 10, 14, DARKGRAY);
+        }
+        EndDrawing();
+    }
+
+    CloseWindow();
+    enet_host_destroy(host);
+    enet_deinitialize();
+}
@@ -0,0 +1,27 @@
+#ifndef SPECTATOR_HPP
+#define SPECTATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "core/registry.hpp"
+#include "network/network_config.hpp"
+
+// Spectator options on top of NetworkConfig's server/port (a match server or relay):
+//   match=ID   match to watch (default: the server picks its busiest)
+struct SpectatorConfig {
+    NetworkConfig network;
+    uint32_t match = 0;  // Requested match id + 1, 0 lets the server choose
+
+    bool set(const std::string& key, const std::string& value, std::string& error);
+};
+
+// Makes the registry hold exactly the players in a Protocol::SPECTATE frame, in their state.
+// False for a malformed frame, which leaves the registry as it was.
+bool applySpectatorFrame(Registry& registry, const uint8_t* data, size_t length);
+
+// Window that draws a match from its delayed spectator stream; sends nothing but the connect
+void runSpectator(const SpectatorConfig& config);
+
+#endif
@@ -0,0 +1,414 @@
+#include "network/compression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <utility>
+
+namespace {
+constexpr char MODEL_MAGIC[4] = {'S', 'H', 'B', 'M'};
+
+bool isSendCommand(uint8_t command) {
+    switch (command) {
+        case ENET_PROTOCOL_COMMAND_SEND_RELIABLE:
+        case ENET_PROTOCOL_COMMAND_SEND_UNRELIABLE:
+        case ENET_PROTOCOL_COMMAND_SEND_FRAGMENT:
+        case ENET_PROTOCOL_COMMAND_SEND_UNSEQUENCED:
+        case ENET_PROTOCOL_COMMAND_SEND_UNRELIABLE_FRAGMENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ENet hands a datagram over as separate buffers: one per command, each send command followed by its payload
+bool carriesEnabledChannel(const ENetBuffer* buffers, size_t count, uint32_t channels) {
+    if (channels == NetworkConfig::ALL_CHANNELS) {
+        return true;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (buffers[i].dataLength < sizeof(ENetProtocolCommandHeader)) continue;
+        const auto* header = static_cast<const ENetProtocolCommandHeader*>(buffers[i].data);
+        if (!isSendCommand(header->command & ENET_PROTOCOL_COMMAND_MASK)) continue;
+
+        if (header->channelID < 32 && (channels & (1u << header->channelID))) {
+            return true;
+        }
+        ++i;  // Skip the payload
+    }
+    return false;
+}
+
+// Context behind the ENet compressor hook, owned by the host once installed
+struct Compressor {
+    CompressionMode mode = CompressionMode::NONE;
+    uint32_t channels = NetworkConfig::ALL_CHANNELS;
+    std::unique_ptr<HuffmanCoder> huffman;
+    void* rangeCoder = nullptr;
+
+    std::string recordPath;
+    ByteModel recorded;
+
+    uint64_t datagrams = 0;
+    uint64_t compressedDatagrams = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+size_t compressDatagram(void* context, const ENetBuffer* inBuffers, size_t inBufferCount, size_t inLimit, enet_uint8* outData,
+                        size_t outLimit) {
+    Compressor& compressor = *static_cast<Compressor*>(context);
+    if (!carriesEnabledChannel(inBuffers, inBufferCount, compressor.channels)) {
+        return 0;
+    }
+
+    if (!compressor.recordPath.empty()) {
+        for (size_t i = 0; i < inBufferCount; ++i) {
+            compressor.recorded.add(static_cast<const uint8_t*>(inBuffers[i].data), inBuffers[i].dataLength);
+        }
+    }
+
+    size_t written = 0;
+    if (compressor.mode == CompressionMode::RANGE) {
+        written = enet_range_coder_compress(compressor.rangeCoder, inBuffers, inBufferCount, inLimit, outData, outLimit);
+    } else if (compressor.mode == CompressionMode::HUFFMAN) {
+        written = compressor.huffman->compress(inBuffers, inBufferCount, outData, outLimit);
+    }
+
+    // ENet sends the datagram raw unless it actually got smaller
+    compressor.datagrams++;
+    compressor.bytesIn += inLimit;
+    if (written > 0 && written < inLimit) {
+        compressor.compressedDatagrams++;
+        compressor.bytesOut += written;
+    } else {
+        compressor.bytesOut += inLimit;
+    }
+    return written;
+}
+
+size_t decompressDatagram(void* context, const enet_uint8* inData, size_t inLimit, enet_uint8* outData, size_t outLimit) {
+    Compressor& compressor = *static_cast<Compressor*>(context);
+    if (compressor.mode == CompressionMode::RANGE) {
+        return enet_range_coder_decompress(compressor.rangeCoder, inData, inLimit, outData, outLimit);
+    }
+    if (compressor.mode == CompressionMode::HUFFMAN) {
+        return compressor.huffman->decompress(inData, inLimit, outData, outLimit);
+    }
+    return 0;
+}
+
+void destroyCompressor(void* context) {
+    Compressor* compressor = static_cast<Compressor*>(context);
+
+    if (!compressor->recordPath.empty()) {
+        if (compressor->recorded.save(compressor->recordPath)) {
+            std::cout << "Recorded " << compressor->recorded.getTotal() << " bytes of traffic to " << compressor->recordPath << std::endl;
+        } else {
+            std::cerr << "Cannot write traffic recording " << compressor->recordPath << std::endl;
+        }
+    }
+    if (compressor->mode != CompressionMode::NONE && compressor->datagrams > 0) {
+        std::printf("Compression: %llu of %llu datagrams compressed, %llu -> %llu bytes (%.2f)\n",
+                    static_cast<unsigned long long>(compressor->compressedDatagrams),
+                    static_cast<unsigned long long>(compressor->datagrams), static_cast<unsigned long long>(compressor->bytesIn),
+                    static_cast<unsigned long long>(compressor->bytesOut), static_cast<double>(compressor->bytesOut) / compressor->bytesIn);
+    }
+
+    if (compressor->rangeCoder) {
+        enet_range_coder_destroy(compressor->rangeCoder);
+    }
+    delete compressor;
+}
+}  // namespace
+
+ByteModel::ByteModel() {
+    counts.fill(0);
+}
+
+void ByteModel::add(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        counts[data[i]]++;
+    }
+}
+
+void ByteModel::merge(const ByteModel& other) {
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+}
+
+uint64_t ByteModel::getCount(uint8_t byte) const {
+    return counts[byte];
+}
+
+uint64_t ByteModel::getTotal() const {
+    uint64_t total = 0;
+    for (uint64_t count : counts) total += count;
+    return total;
+}
+
+bool ByteModel::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(MODEL_MAGIC, sizeof(MODEL_MAGIC));
+    file.write(reinterpret_cast<const char*>(counts.data()), sizeof(counts));
+    return static_cast<bool>(file);
+}
+
+bool ByteModel::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MODEL_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, MODEL_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(counts.data()), sizeof(counts)));
+}
+
+HuffmanCoder::HuffmanCoder(const ByteModel& model) {
+    buildLengths(model);
+    buildCodes();
+}
+
+void HuffmanCoder::buildLengths(const ByteModel& model) {
+    // Every byte value stays codable, even ones the model never saw
+    std::array<uint64_t, 256> weights;
+    for (size_t symbol = 0; symbol < weights.size(); ++symbol) {
+        weights[symbol] = model.getCount(static_cast<uint8_t>(symbol)) + 1;
+    }
+
+    while (true) {
+        // Ties break on node index, so both ends build exactly the same code
+        using Node = std::pair<uint64_t, size_t>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        std::vector<size_t> parent(2 * weights.size() - 1, 0);
+        for (size_t symbol = 0; symbol < weights.size(); ++symbol) {
+            queue.push({weights[symbol], symbol});
+        }
+
+        size_t next = weights.size();
+        while (queue.size() > 1) {
+            Node a = queue.top();
+            queue.pop();
+            Node b = queue.top();
+            queue.pop();
+            parent[a.second] = next;
+            parent[b.second] = next;
+            queue.push({a.first + b.first, next++});
+        }
+
+        // Parents always have higher indices than their children; the root is last
+        std::vector<int> depth(parent.size(), 0);
+        int longest = 0;
+        for (size_t node = parent.size() - 1; node-- > 0;) {
+            depth[node] = depth[parent[node]] + 1;
+        }
+        for (size_t symbol = 0; symbol < lengths.size(); ++symbol) {
+            lengths[symbol] = static_cast<uint8_t>(depth[symbol]);
+            longest = std::max(longest, depth[symbol]);
+        }
+        if (longest <= MAX_CODE_LENGTH) {
+            return;
+        }
+
+        // Flatten the distribution until the longest code fits the decode table
+        for (uint64_t& weight : weights) {
+            weight = (weight >> 1) + 1;
+        }
+    }
+}
+
+void HuffmanCoder::buildCodes() {
+    // Canonical code: shorter codes first, equal lengths in symbol order
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> lengthCounts = {};
+    for (uint8_t length : lengths) lengthCounts[length]++;
+
+    std::array<uint16_t, MAX_CODE_LENGTH + 1> nextCode = {};
+    uint16_t code = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        code = static_cast<uint16_t>((code + lengthCounts[length - 1]) << 1);
+        nextCode[length] = code;
+    }
+
+    decodeTable.assign(size_t(1) << MAX_CODE_LENGTH, DecodeEntry{0, 0});
+    for (size_t symbol = 0; symbol < lengths.size(); ++symbol) {
+        int length = lengths[symbol];
+        uint16_t canonical = nextCode[length]++;
+
+        // Emitted LSB-first, so store the code bit-reversed
+        uint16_t reversed = 0;
+        for (int bit = 0; bit < length; ++bit) {
+            reversed = static_cast<uint16_t>((reversed << 1) | ((canonical >> bit) & 1));
+        }
+        codes[symbol] = reversed;
+
+        for (size_t index = reversed; index < decodeTable.size(); index += size_t(1) << length) {
+            decodeTable[index] = {static_cast<uint8_t>(symbol), static_cast<uint8_t>(length)};
+        }
+    }
+}
+
+size_t HuffmanCoder::compress(const ENetBuffer* buffers, size_t bufferCount, uint8_t* out, size_t outLimit) const {
+    size_t length = 0;
+    for (size_t i = 0; i < bufferCount; ++i) length += buffers[i].dataLength;
+    if (length > UINT16_MAX || outLimit < sizeof(uint16_t)) {
+        return 0;
+    }
+
+    uint16_t original = static_cast<uint16_t>(length);
+    std::memcpy(out, &original, sizeof(original));
+    size_t position = sizeof(original);
+
+    uint64_t bits = 0;
+    int bitCount = 0;
+    for (size_t i = 0; i < bufferCount; ++i) {
+        const uint8_t* data = static_cast<const uint8_t*>(buffers[i].data);
+        for (size_t j = 0; j < buffers[i].dataLength; ++j) {
+            bits |= static_cast<uint64_t>(codes[data[j]]) << bitCount;
+            bitCount += lengths[data[j]];
+            while (bitCount >= 8) {
+                if (position >= outLimit) return 0;
+                out[position++] = static_cast<uint8_t>(bits);
+                bits >>= 8;
+                bitCount -= 8;
+            }
+        }
+    }
+
+    if (bitCount > 0) {
+        if (position >= outLimit) return 0;
+        out[position++] = static_cast<uint8_t>(bits);
+    }
+    return position;
+}
+
+size_t HuffmanCoder::compress(const uint8_t* data, size_t length, uint8_t* out, size_t outLimit) const {
+    ENetBuffer buffer;
+    buffer.data = const_cast<uint8_t*>(data);
+    buffer.dataLength = length;
+    return compress(&buffer, 1, out, outLimit);
+}
+
+size_t HuffmanCoder::decompress(const uint8_t* data, size_t length, uint8_t* out, size_t outLimit) const {
+    uint16_t original;
+    if (length < sizeof(original)) {
+        return 0;
+    }
+    std::memcpy(&original, data, sizeof(original));
+    if (original > outLimit) {
+        return 0;
+    }
+
+    const uint64_t mask = (uint64_t(1) << MAX_CODE_LENGTH) - 1;
+    size_t position = sizeof(original);
+    uint64_t bits = 0;
+    int bitCount = 0;
+    for (size_t i = 0; i < original; ++i) {
+        while (bitCount <= 56 && position < length) {
+            bits |= static_cast<uint64_t>(data[position++]) << bitCount;
+            bitCount += 8;
+        }
+
+        const DecodeEntry& entry = decodeTable[bits & mask];
+        if (entry.length == 0 || entry.length > bitCount) {
+            return 0;  // Truncated or not ours
+        }
+        out[i] = entry.symbol;
+        bits >>= entry.length;
+        bitCount -= entry.length;
+    }
+    return original;
+}
+
+double HuffmanCoder::getBitsPerByte(const ByteModel& model) const {
+    uint64_t total = model.getTotal();
+    if (total == 0) {
+        return 0.0;
+    }
+
+    double bits = 0.0;
+    for (size_t symbol = 0; symbol < lengths.size(); ++symbol) {
+        bits += static_cast<double>(model.getCount(static_cast<uint8_t>(symbol))) * lengths[symbol];
+    }
+    return bits / total;
+}
+
+bool Compression::install(ENetHost* host, const NetworkConfig& config) {
+    if (config.compression == CompressionMode::NONE && config.compressionRecord.empty()) {
+        return true;
+    }
+
+    auto compressor = std::make_unique<Compressor>();
+    compressor->mode = config.compression;
+    compressor->channels = config.compressedChannels;
+    compressor->recordPath = config.compressionRecord;
+
+    if (config.compression == CompressionMode::HUFFMAN) {
+        ByteModel model;
+        if (!model.load(config.compressionModel)) {
+            std::cerr << "Cannot load compression model " << config.compressionModel << std::endl;
+            return false;
+        }
+        compressor->huffman = std::make_unique<HuffmanCoder>(model);
+    } else if (config.compression == CompressionMode::RANGE) {
+        compressor->rangeCoder = enet_range_coder_create();
+        if (!compressor->rangeCoder) {
+            std::cerr << "Cannot create range coder" << std::endl;
+            return false;
+        }
+    }
+
+    ENetCompressor hook;
+    hook.context = compressor.release();
+    hook.compress = compressDatagram;
+    hook.decompress = decompressDatagram;
+    hook.destroy = destroyCompressor;
+    enet_host_compress(host, &hook);
+    return true;
+}
+
+int Compression::train(const std::string& output, const std::vector<std::string>& recordings) {
+    ByteModel model;
+    for (const std::string& path : recordings) {
+        ByteModel recording;
+        if (!recording.load(path)) {
+            std::cerr << "Cannot read traffic recording " << path << std::endl;
+            return 1;
+        }
+        model.merge(recording);
+    }
+
+    uint64_t total = model.getTotal();
+    if (total == 0) {
+        std::cerr << "No traffic in the recordings" << std::endl;
+        return 1;
+    }
+    if (!model.save(output)) {
+        std::cerr << "Cannot write compression model " << output << std::endl;
+        return 1;
+    }
+
+    double entropy = 0.0;
+    for (int byte = 0; byte < 256; ++byte) {
+        uint64_t count = model.getCount(static_cast<uint8_t>(byte));
+        if (count == 0) continue;
+        double p = static_cast<double>(count) / total;
+        entropy -= p * std::log2(p);
+    }
+
+    HuffmanCoder coder(model);
+    double bitsPerByte = coder.getBitsPerByte(model);
+    std::printf("Trained on %llu bytes from %zu recording(s): %.2f bits/byte (entropy %.2f), expected ratio %.2f\n",
+                static_cast<unsigned long long>(total), recordings.size(), bitsPerByte, entropy, bitsPerByte / 8.0);
+    std::printf("Model written to %s\n", output.c_str());
+    return 0;
+}
@@ -0,0 +1,73 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <enet/enet.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "network/network_config.hpp"
+
+// Byte frequencies of network traffic. Recordings, trained models and the Huffman coder all
+// use this one table; a trained model is just the merged recordings.
+class ByteModel {
+   public:
+    ByteModel();
+
+    void add(const uint8_t* data, size_t length);
+    void merge(const ByteModel& other);
+    uint64_t getCount(uint8_t byte) const;
+    uint64_t getTotal() const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+   private:
+    std::array<uint64_t, 256> counts;
+};
+
+// Static canonical Huffman code built from a ByteModel. Both ends must build it from the same
+// model file; every byte value gets a code, so traffic unlike the model still round-trips.
+// Compressed layout: original length (uint16), then the codes packed LSB-first.
+class HuffmanCoder {
+   public:
+    static constexpr int MAX_CODE_LENGTH = 12;  // Keeps the decode table at 4096 entries
+
+    explicit HuffmanCoder(const ByteModel& model);
+
+    // Both return 0 when the result doesn't fit in outLimit (ENet then sends the datagram raw)
+    size_t compress(const ENetBuffer* buffers, size_t bufferCount, uint8_t* out, size_t outLimit) const;
+    size_t compress(const uint8_t* data, size_t length, uint8_t* out, size_t outLimit) const;
+    size_t decompress(const uint8_t* data, size_t length, uint8_t* out, size_t outLimit) const;
+
+    // Average code length in bits for traffic distributed like the model
+    double getBitsPerByte(const ByteModel& model) const;
+
+   private:
+    struct DecodeEntry {
+        uint8_t symbol;
+        uint8_t length;
+    };
+
+    void buildLengths(const ByteModel& model);
+    void buildCodes();
+
+    std::array<uint8_t, 256> lengths;
+    std::array<uint16_t, 256> codes;  // Bit-reversed, ready to emit LSB-first
+    std::vector<DecodeEntry> decodeTable;
+};
+
+namespace Compression {
+// Installs the compressor the config asks for (and/or the traffic recorder) on a host.
+// ENet compresses whole datagrams; one is compressed when it carries a message on an enabled channel.
+// Returns false if the model can't be loaded.
+bool install(ENetHost* host, const NetworkConfig& config);
+
+// Trainer: merges traffic recordings into a model file and reports how well it would compress them
+int train(const std::string& output, const std::vector<std::string>& recordings);
+}  // namespace Compression
+
+#endif
@@ -0,0 +1,80 @@
+#include "network/input_commands.hpp"
+
+#include "network/protocol.hpp"
+
+void CommandHistory::push(uint32_t tick, const PlayerInput& input) {
+    commands[tick % CAPACITY] = {tick, input};
+    newestTick = tick;
+}
+
+const InputCommand* CommandHistory::find(uint32_t tick) const {
+    const InputCommand& command = commands[tick % CAPACITY];
+    if (tick == 0 || command.tick != tick) {
+        return nullptr;
+    }
+    return &command;
+}
+
+uint32_t CommandHistory::getNewestTick() const {
+    return newestTick;
+}
+
+size_t CommandHistory::encodeRecent(uint8_t* out, size_t maxCount) const {
+    size_t count = 0;
+    while (count < maxCount && count < newestTick) {
+        const InputCommand* command = find(newestTick - static_cast<uint32_t>(count));
+        if (!command) break;
+        out[count++] = Protocol::encodeButtons(command->input);
+    }
+    return count;
+}
+
+void CommandHistory::clear() {
+    *this = CommandHistory();
+}
+
+void CommandQueue::receive(uint32_t newestTick, const uint8_t* received, size_t count) {
+    if (newestTick == 0 || count == 0 || count > newestTick) {
+        return;
+    }
+
+    if (newestReceived == 0) {
+        // First packet from this player: start at the oldest command it carries
+        lastApplied = newestTick - static_cast<uint32_t>(count);
+    }
+    if (newestTick > newestReceived) {
+        newestReceived = newestTick;
+    }
+    if (newestReceived - lastApplied > MAX_BACKLOG) {
+        lastApplied = newestReceived - MAX_BACKLOG;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t tick = newestTick - static_cast<uint32_t>(i);
+        if (tick <= lastApplied) break;
+        ticks[tick % CAPACITY] = tick;
+        buttons[tick % CAPACITY] = received[i];
+    }
+}
+
+PlayerInput CommandQueue::next() {
+    uint32_t tick = lastApplied + 1;
+    uint32_t slot = tick % CAPACITY;
+    if (ticks[slot] == tick) {
+        lastInput = Protocol::decodeButtons(buttons[slot]);
+        lastApplied = tick;
+    } else if (newestReceived > tick) {
+        // Newer packets arrived without it, so it is lost for good: stand in with the previous input
+        lastApplied = tick;
+    }
+    // Otherwise the client hasn't sent this tick yet; repeat the previous input without consuming it
+    return lastInput;
+}
+
+uint32_t CommandQueue::getLastApplied() const {
+    return lastApplied;
+}
+
+void CommandQueue::clear() {
+    *this = CommandQueue();
+}
@@ -0,0 +1,55 @@
+#ifndef INPUT_COMMANDS_HPP
+#define INPUT_COMMANDS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "entities/components.hpp"
+
+// One tick of a player's input. Ticks count from 1; tick 0 marks an empty slot.
+struct InputCommand {
+    uint32_t tick;
+    PlayerInput input;
+};
+
+// Client side: the commands this player issued recently, by tick.
+// Feeds the redundant upstream packets and the replay after the authority corrects us.
+class CommandHistory {
+   public:
+    static constexpr size_t CAPACITY = 128;  // About two seconds at 60 Hz
+
+    void push(uint32_t tick, const PlayerInput& input);
+    const InputCommand* find(uint32_t tick) const;  // nullptr if unknown or already overwritten
+    uint32_t getNewestTick() const;
+
+    // Writes the button bytes of up to maxCount newest commands, newest first; returns how many
+    size_t encodeRecent(uint8_t* buttons, size_t maxCount) const;
+    void clear();
+
+   private:
+    InputCommand commands[CAPACITY] = {};
+    uint32_t newestTick = 0;
+};
+
+// Authority side: the commands one remote player sent, handed out one per simulation tick.
+// Duplicates from the redundant packets are ignored. A command that never arrives is replaced
+// by the previous input; a client running ahead is trimmed to MAX_BACKLOG ticks of latency.
+class CommandQueue {
+   public:
+    static constexpr uint32_t CAPACITY = 32;
+    static constexpr uint32_t MAX_BACKLOG = 8;
+
+    void receive(uint32_t newestTick, const uint8_t* buttons, size_t count);
+    PlayerInput next();
+    uint32_t getLastApplied() const;  // Newest command tick simulated, 0 before the first
+    void clear();
+
+   private:
+    uint32_t ticks[CAPACITY] = {};
+    uint8_t buttons[CAPACITY] = {};
+    uint32_t lastApplied = 0;
+    uint32_t newestReceived = 0;
+    PlayerInput lastInput = {{0, 0}, false};
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "network/netsim/link_conditions.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include "network/network_config.hpp"
+
+namespace {
+bool parsePercent(const std::string& value, double& out) {
+    if (value.empty()) return false;
+    char* end = nullptr;
+    double number = std::strtod(value.c_str(), &end);
+    if (*end != '\0' || !(number >= 0.0 && number <= 100.0)) return false;
+    out = number;
+    return true;
+}
+}  // namespace
+
+bool LinkConditions::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "delay") {
+        return ConfigOptions::parseField(key, value, 60000, delayMs, error);
+    } else if (key == "jitter") {
+        return ConfigOptions::parseField(key, value, 60000, jitterMs, error);
+    } else if (key == "jitter-shape") {
+        if (value == "uniform") {
+            jitterShape = JitterShape::UNIFORM;
+        } else if (value == "normal") {
+            jitterShape = JitterShape::NORMAL;
+        } else {
+            error = "jitter-shape must be uniform or normal";
+            return false;
+        }
+    } else if (key == "loss" || key == "duplicate") {
+        double percent;
+        if (!parsePercent(value, percent)) {
+            error = "Invalid percentage for " + key + ": " + value;
+            return false;
+        }
+        (key == "loss" ? lossPercent : duplicatePercent) = percent;
+    } else {
+        error.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string LinkConditions::describe() const {
+    char text[96];
+    std::snprintf(text, sizeof(text), "%ums +%ums %s, %.1f%% loss, %.1f%% dup", delayMs, jitterMs,
+                  jitterShape == JitterShape::NORMAL ? "normal" : "uniform", lossPercent, duplicatePercent);
+    return text;
+}
+
+LinkConditioner::LinkConditioner(const LinkConditions& linkConditions, uint32_t seed) : conditions(linkConditions), rng(seed) {}
+
+uint64_t LinkConditioner::sampleDelayUs() {
+    double delayMs = conditions.delayMs;
+    if (conditions.jitterMs > 0) {
+        if (conditions.jitterShape == LinkConditions::JitterShape::NORMAL) {
+            // Half-normal: most datagrams arrive close to the base delay, a few much later
+            std::normal_distribution<double> jitter(0.0, conditions.jitterMs);
+            delayMs += std::fabs(jitter(rng));
+        } else {
+            std::uniform_real_distribution<double> jitter(0.0, conditions.jitterMs);
+            delayMs += jitter(rng);
+        }
+    }
+    return static_cast<uint64_t>(delayMs * 1000.0);
+}
+
+void LinkConditioner::submit(uint64_t nowUs, uint64_t route, const uint8_t* data, size_t length) {
+    std::uniform_real_distribution<double> percent(0.0, 100.0);
+    stats.submitted++;
+    if (percent(rng) < conditions.lossPercent) {
+        stats.dropped++;
+        return;
+    }
+
+    int copies = 1;
+    if (percent(rng) < conditions.duplicatePercent) {
+        stats.duplicated++;
+        copies = 2;
+    }
+    for (int i = 0; i < copies; ++i) {
+        pending.push({nowUs + sampleDelayUs(), nextOrder++, route, std::vector<uint8_t>(data, data + length)});
+    }
+}
+
+bool LinkConditioner::pop(uint64_t nowUs, Datagram& out) {
+    if (pending.empty() || pending.top().dueUs > nowUs) {
+        return false;
+    }
+    // The queue only hands out const references; the bytes are about to be dropped from it anyway
+    out = std::move(const_cast<Datagram&>(pending.top()));
+    pending.pop();
+    stats.delivered++;
+    return true;
+}
+
+const LinkConditioner::Stats& LinkConditioner::getStats() const {
+    return stats;
+}
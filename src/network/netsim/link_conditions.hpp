@@ -0,0 +1,70 @@
+#ifndef LINK_CONDITIONS_HPP
+#define LINK_CONDITIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// What a simulated link does to each datagram, applied to both directions independently:
+//   delay=MS          fixed one-way delay
+//   jitter=MS         extra delay on top, 0..MS (uniform) or a half-normal with MS as sigma (normal)
+//   jitter-shape=S    uniform or normal
+//   loss=PERCENT      chance a datagram is dropped, e.g. 2.5
+//   duplicate=PERCENT chance a datagram is delivered twice, each copy with its own delay
+// Jitter reorders datagrams the way a real path does; there is no separate reorder knob.
+struct LinkConditions {
+    enum class JitterShape { UNIFORM, NORMAL };
+
+    uint32_t delayMs = 0;
+    uint32_t jitterMs = 0;
+    JitterShape jitterShape = JitterShape::UNIFORM;
+    double lossPercent = 0.0;
+    double duplicatePercent = 0.0;
+
+    // Returns false with an empty error for keys that belong to someone else
+    bool set(const std::string& key, const std::string& value, std::string& error);
+    std::string describe() const;
+};
+
+// Holds datagrams until their simulated arrival time. Each datagram carries a route (which proxy
+// session it belongs to) so one conditioner can serve every client in a direction.
+class LinkConditioner {
+   public:
+    struct Datagram {
+        uint64_t dueUs;
+        uint64_t order;  // Keeps equal due times in submission order
+        uint64_t route;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Stats {
+        unsigned long submitted = 0;
+        unsigned long dropped = 0;
+        unsigned long duplicated = 0;
+        unsigned long delivered = 0;
+    };
+
+    LinkConditioner(const LinkConditions& conditions, uint32_t seed);
+
+    void submit(uint64_t nowUs, uint64_t route, const uint8_t* data, size_t length);
+    bool pop(uint64_t nowUs, Datagram& out);  // Next datagram due by nowUs, if any
+    const Stats& getStats() const;
+
+   private:
+    struct LaterFirst {
+        bool operator()(const Datagram& a, const Datagram& b) const { return a.dueUs != b.dueUs ? a.dueUs > b.dueUs : a.order > b.order; }
+    };
+
+    uint64_t sampleDelayUs();
+
+    LinkConditions conditions;
+    std::mt19937 rng;
+    std::priority_queue<Datagram, std::vector<Datagram>, LaterFirst> pending;
+    uint64_t nextOrder = 0;
+    Stats stats;
+};
+
+#endif
@@ -0,0 +1,388 @@
+#include "network/netsim/scenarios.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory_resource>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/job_system.hpp"
+#include "core/map.hpp"
+#include "core/registry.hpp"
+#include "core/simulation.hpp"
+#include "entities/player.hpp"
+#include "network/netsim/udp_proxy.hpp"
+#include "network/network_manager.hpp"
+#include "network/packet_pool.hpp"
+#include "network/prediction.hpp"
+#include "network/server/match_server.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Scenario {
+    std::string name;
+    LinkConditions conditions;
+};
+
+std::vector<Scenario> builtInScenarios() {
+    auto link = [](uint32_t delayMs, uint32_t jitterMs, LinkConditions::JitterShape shape, double loss, double duplicate) {
+        LinkConditions conditions;
+        conditions.delayMs = delayMs;
+        conditions.jitterMs = jitterMs;
+        conditions.jitterShape = shape;
+        conditions.lossPercent = loss;
+        conditions.duplicatePercent = duplicate;
+        return conditions;
+    };
+    const LinkConditions::JitterShape uniform = LinkConditions::JitterShape::UNIFORM;
+    const LinkConditions::JitterShape normal = LinkConditions::JitterShape::NORMAL;
+
+    // Delays are one way, so the round trip is about twice that
+    return {
+        {"clean", link(0, 0, uniform, 0.0, 0.0)},         {"lan", link(2, 1, uniform, 0.0, 0.0)},
+        {"broadband", link(25, 10, uniform, 0.5, 0.0)},   {"wifi", link(15, 20, normal, 2.0, 0.5)},
+        {"mobile", link(60, 40, normal, 5.0, 1.0)},       {"congested", link(120, 60, normal, 10.0, 2.0)},
+    };
+}
+
+double millisBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+double percentile(std::vector<double> samples, double fraction) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    return samples[static_cast<size_t>(fraction * (samples.size() - 1) + 0.5)];
+}
+
+// Headless client: networking, simulation and prediction as in Game, input from a script
+class ScriptedClient {
+   public:
+    explicit ScriptedClient(const NetworkConfig& config) : network(false, config), simulation(registry, map) {
+        simulation.setResolveDamage(false);
+        localPlayer = Player::spawn(registry, NetworkId{NetworkId::LOCAL}, 5, RED, 10, PlayerShape::CIRCLE);
+    }
+
+    bool init() { return network.init(); }
+
+    bool isWelcomed() const { return network.getOwner() != Protocol::OWNER_SELF; }
+    uint16_t getOwner() const { return network.getOwner(); }
+    float getTickSeconds() const { return 1.0f / network.getTickRate(); }
+
+    // Pumps the network and applies whatever the authority sent
+    void receive(Clock::time_point now) {
+        network.service();
+        PeerEvent peerEvent;
+        while (network.pollPeerEvent(peerEvent)) {
+            if (peerEvent.type == PeerEvent::Type::LEFT) {
+                registry.despawn(registry.findByNetworkId(peerEvent.owner));
+            }
+        }
+
+        uint16_t self = network.getOwner();
+        if (self == Protocol::OWNER_SELF) {
+            return;
+        }
+        if (!placed) {
+            Player(registry, localPlayer).setPosition(map.getSpawnPoint(self));
+            placed = true;
+        }
+
+        uint16_t owner;
+        uint8_t shots;
+        float x, y;
+        uint32_t ackTick;
+        while (network.receivePosition(owner, x, y, ackTick)) {
+            Position position = {static_cast<int>(x), static_cast<int>(y)};
+            if (owner != self) {
+                Player(registry, remotePlayer(owner)).setPosition(position);
+            } else if (prediction.reconcile(registry, localPlayer, &map, position, ackTick, getTickSeconds())) {
+                const SentInput& sent = sentInputs[ackTick % CommandHistory::CAPACITY];
+                if (sent.tick == ackTick) ackLatencies.push_back(millisBetween(sent.at, now));
+            }
+        }
+
+        while (network.receiveBullets(owner, shots, bullets)) {
+            if (owner != self) {
+                Player(registry, remotePlayer(owner)).setBullets(bullets);
+                if (owner == watchedOwner) {
+                    if (!bullets.empty() && !watchedHasBullets) bulletAppearances++;
+                    watchedHasBullets = !bullets.empty();
+                }
+            }
+            bullets.clear();
+        }
+
+        int health;
+        while (network.receiveHealth(owner, health)) {
+            Player player(registry, owner == self ? localPlayer : remotePlayer(owner));
+            player.setHealth(health);
+            player.clearHealthChangeFlag();
+        }
+    }
+
+    // One fixed tick of scripted input, sent upstream and predicted like Game::step
+    void step(const PlayerInput& input, Clock::time_point now) {
+        registry.getInput(localPlayer) = input;
+
+        uint8_t buttons[Protocol::INPUT_REDUNDANCY];
+        size_t count;
+        uint32_t tick = prediction.record(input, buttons, count);
+        sentInputs[tick % CommandHistory::CAPACITY] = {tick, now};
+        network.sendInput(tick, buttons, count);
+
+        simulation.tick(jobs, getTickSeconds());
+    }
+
+    bool hasOwnBullets() { return !Player(registry, localPlayer).getBullets().empty(); }
+
+    // Counts the authority's bullets for this owner going from none to some
+    void watch(uint16_t owner) { watchedOwner = owner; }
+    bool seesWatchedBullets() const { return watchedHasBullets; }
+    unsigned long getBulletAppearances() const { return bulletAppearances; }
+
+    void beginMeasurement() {
+        ackLatencies.clear();
+        correctionBaseline = prediction.getCorrectionCount();
+    }
+    const std::vector<double>& getAckLatencies() const { return ackLatencies; }
+    unsigned long getCorrections() const { return prediction.getCorrectionCount() - correctionBaseline; }
+
+   private:
+    struct SentInput {
+        uint32_t tick = 0;
+        Clock::time_point at;
+    };
+
+    Entity remotePlayer(uint16_t owner) {
+        Entity existing = registry.findByNetworkId(owner);
+        if (existing != NULL_ENTITY) return existing;
+        return Player::spawn(registry, NetworkId{owner}, 5, RED, 10, PlayerShape::CIRCLE);
+    }
+
+    NetworkManager network;
+    Map map;
+    Registry registry;
+    Simulation simulation;
+    JobSystem jobs{0};
+    ClientPrediction prediction;
+    Entity localPlayer;
+    bool placed = false;
+    std::pmr::vector<Bullet> bullets;
+
+    SentInput sentInputs[CommandHistory::CAPACITY];
+    std::vector<double> ackLatencies;
+    unsigned long correctionBaseline = 0;
+
+    uint16_t watchedOwner = Protocol::OWNER_SELF;
+    bool watchedHasBullets = false;
+    unsigned long bulletAppearances = 0;
+};
+
+// The walker goes round a square, a side every SIDE_TICKS, and fires whenever nothing of its is in flight
+PlayerInput walkerInput(uint32_t tick) {
+    static constexpr uint32_t SIDE_TICKS = 40;
+    static const Position sides[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    return {sides[(tick / SIDE_TICKS) % 4], false};
+}
+
+struct Result {
+    std::vector<double> ackLatencies;
+    std::vector<double> remoteLatencies;
+    unsigned long corrections = 0;
+    unsigned long fires = 0;
+    unsigned long unseenFires = 0;
+    LinkConditioner::Stats upstream;
+    LinkConditioner::Stats downstream;
+};
+
+bool runScenario(const Scenario& scenario, const ScenarioConfig& config, Result& result) {
+    MatchServerConfig serverConfig;
+    serverConfig.network.bindAddress = "127.0.0.1";
+    serverConfig.network.port = config.port;
+    serverConfig.network.peerCapacity = 8;
+    serverConfig.matchCount = 1;
+    serverConfig.playersPerMatch = 2;
+    serverConfig.shardCount = 1;
+
+    ProxyConfig proxyConfig;
+    proxyConfig.network.bindAddress = "127.0.0.1";
+    proxyConfig.network.serverAddress = "127.0.0.1";
+    proxyConfig.network.port = config.port;
+    proxyConfig.listenPort = static_cast<uint16_t>(config.port + 1);
+    proxyConfig.conditions = scenario.conditions;
+    proxyConfig.seed = config.seed;
+    proxyConfig.reportSeconds = 0;
+
+    NetworkConfig clientConfig;
+    clientConfig.serverAddress = "127.0.0.1";
+    clientConfig.port = proxyConfig.listenPort;
+
+    MatchServer server(serverConfig);
+    if (!server.start()) return false;
+    std::thread serverThread(&MatchServer::run, &server);
+
+    UdpProxy proxy(proxyConfig);
+    if (!proxy.start()) {
+        server.stop();
+        serverThread.join();
+        return false;
+    }
+    std::thread proxyThread(&UdpProxy::run, &proxy);
+
+    bool ok = true;
+    {
+        ScriptedClient walker(clientConfig);
+        ScriptedClient watcher(clientConfig);
+        ok = walker.init() && watcher.init();
+
+        // ENet retries the handshake, so even the lossy scenarios connect within a few seconds
+        Clock::time_point deadline = Clock::now() + std::chrono::seconds(10);
+        while (ok && !(walker.isWelcomed() && watcher.isWelcomed())) {
+            Clock::time_point now = Clock::now();
+            if (now > deadline) {
+                std::cerr << "Clients were not welcomed within 10 seconds" << std::endl;
+                ok = false;
+                break;
+            }
+            walker.receive(now);
+            watcher.receive(now);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (ok) {
+            watcher.watch(walker.getOwner());
+            const auto tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(walker.getTickSeconds()));
+            const auto fireTimeout = std::chrono::seconds(2);
+            Clock::time_point start = Clock::now();
+            Clock::time_point measureFrom = start + std::chrono::seconds(1);
+            Clock::time_point end = measureFrom + std::chrono::seconds(config.seconds);
+            Clock::time_point nextTick = start;
+            bool measuring = false;
+
+            uint32_t tick = 0;
+            bool firePending = false;
+            Clock::time_point firedAt;
+            unsigned long appearances = watcher.getBulletAppearances();
+
+            for (Clock::time_point now = start; now < end; now = Clock::now()) {
+                if (!measuring && now >= measureFrom) {
+                    measuring = true;
+                    walker.beginMeasurement();
+                }
+
+                walker.receive(now);
+                watcher.receive(now);
+
+                // A fresh bullet on the watcher's screen belongs to the one fire in flight
+                if (watcher.getBulletAppearances() != appearances) {
+                    appearances = watcher.getBulletAppearances();
+                    if (firePending && measuring) result.remoteLatencies.push_back(millisBetween(firedAt, now));
+                    firePending = false;
+                }
+                if (firePending && now - firedAt > fireTimeout) {
+                    if (measuring) result.unseenFires++;
+                    firePending = false;
+                }
+
+                while (nextTick <= now) {
+                    tick++;
+                    PlayerInput input = walkerInput(tick);
+                    bool tryFire = !firePending && !walker.hasOwnBullets() && !watcher.seesWatchedBullets();
+                    input.fire = tryFire;
+                    walker.step(input, now);
+                    watcher.step({{0, 0}, false}, now);
+
+                    // The weapon's cooldown may still have refused the shot
+                    if (tryFire && walker.hasOwnBullets()) {
+                        firePending = true;
+                        firedAt = now;
+                        if (measuring) result.fires++;
+                    }
+                    nextTick += tickDuration;
+                }
+
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+
+            result.ackLatencies = walker.getAckLatencies();
+            result.corrections = walker.getCorrections();
+        }
+    }
+
+    proxy.stop();
+    proxyThread.join();
+    server.stop();
+    serverThread.join();
+
+    result.upstream = proxy.getUpstreamStats();
+    result.downstream = proxy.getDownstreamStats();
+    return ok;
+}
+
+void printResult(const Scenario& scenario, const Result& result) {
+    std::printf("%-10s %-38s %6.1f %6.1f   %6.1f %6.1f   %5lu   %3lu/%-4lu   %lu/%lu\n", scenario.name.c_str(),
+                scenario.conditions.describe().c_str(), percentile(result.ackLatencies, 0.5), percentile(result.ackLatencies, 0.95),
+                percentile(result.remoteLatencies, 0.5), percentile(result.remoteLatencies, 0.95), result.corrections, result.unseenFires,
+                result.fires, result.upstream.dropped + result.downstream.dropped,
+                result.upstream.duplicated + result.downstream.duplicated);
+}
+}  // namespace
+
+bool ScenarioConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "scenario") {
+        scenario = value;
+    } else if (key == "seconds") {
+        return ConfigOptions::parseField(key, value, 3600, seconds, error);
+    } else if (key == "port") {
+        return ConfigOptions::parseField(key, value, 65534, port, error);
+    } else if (key == "seed") {
+        return ConfigOptions::parseField(key, value, 0xFFFFFFFF, seed, error);
+    } else if (custom.set(key, value, error)) {
+        hasCustom = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int runScenarios(const ScenarioConfig& config) {
+    std::vector<Scenario> scenarios;
+    if (config.hasCustom) {
+        scenarios.push_back({"custom", config.custom});
+    } else {
+        for (const Scenario& scenario : builtInScenarios()) {
+            if (config.scenario.empty() || config.scenario == scenario.name) scenarios.push_back(scenario);
+        }
+        if (scenarios.empty()) {
+            std::cerr << "Unknown scenario: " << config.scenario << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::pair<const Scenario*, Result>> results;
+    for (const Scenario& scenario : scenarios) {
+        std::cout << "=== " << scenario.name << " (" << scenario.conditions.describe() << ", " << config.seconds << " s) ===" << std::endl;
+        Result result;
+        if (!runScenario(scenario, config, result)) {
+            std::cerr << "Scenario " << scenario.name << " failed" << std::endl;
+            return 1;
+        }
+        results.emplace_back(&scenario, result);
+    }
+
+    // Summary after all the connection chatter
+    std::printf("\n%-10s %-38s %-13s   %-13s   %-5s   %-8s   %s\n", "scenario", "link (one way)", "ack p50/p95", "remote p50/p95", "corr",
+                "unseen", "dropped/dup");
+    for (const auto& entry : results) {
+        printResult(*entry.first, entry.second);
+    }
+
+    std::printf("\nENet allocations (server and clients):\n");
+    PacketPool::printStats();
+    return 0;
+}
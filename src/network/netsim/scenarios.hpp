@@ -0,0 +1,33 @@
+#ifndef SCENARIOS_HPP
+#define SCENARIOS_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "network/netsim/link_conditions.hpp"
+#include "network/protocol.hpp"
+
+// Scripted netcode runs on one machine: a match server, the UdpProxy in front of it and two
+// headless clients built from the same pieces as Game. One client walks a square and fires,
+// the other stands still and watches. Each scenario reports
+//   ack        input sampled -> the authority's acknowledgement reaches the sender (ms)
+//   remote     input sampled -> the resulting bullet shows up on the other client (ms)
+//   corrections, fires the watcher never saw, and what the proxy dropped/duplicated
+//
+// Options: scenario=NAME (default: all built-in ones), seconds=N measured per scenario after a
+// one-second warm-up, port=N for the server (the proxy listens on N + 1), seed=N. Any
+// LinkConditions key (delay=80 loss=5 ...) runs a single custom scenario instead.
+struct ScenarioConfig {
+    std::string scenario;
+    uint32_t seconds = 10;
+    uint16_t port = Protocol::DEFAULT_PORT;
+    uint32_t seed = 1;
+    LinkConditions custom;
+    bool hasCustom = false;
+
+    bool set(const std::string& key, const std::string& value, std::string& error);
+};
+
+int runScenarios(const ScenarioConfig& config);
+
+#endif
@@ -0,0 +1,254 @@
+#include "network/netsim/udp_proxy.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+#include "network/packet_pool.hpp"
+
+namespace {
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ENetSocket openSocket(const ENetAddress& address) {
+    ENetSocket socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+    if (socket == ENET_SOCKET_NULL) return socket;
+    if (enet_socket_bind(socket, &address) < 0) {
+        enet_socket_destroy(socket);
+        return ENET_SOCKET_NULL;
+    }
+    enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+    enet_socket_set_option(socket, ENET_SOCKOPT_RCVBUF, 256 * 1024);
+    enet_socket_set_option(socket, ENET_SOCKOPT_SNDBUF, 256 * 1024);
+    return socket;
+}
+
+void sendDatagram(ENetSocket socket, const ENetAddress& to, const std::vector<uint8_t>& bytes) {
+    ENetBuffer buffer;
+    buffer.data = const_cast<uint8_t*>(bytes.data());
+    buffer.dataLength = bytes.size();
+    enet_socket_send(socket, &to, &buffer, 1);
+}
+}  // namespace
+
+bool ProxyConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "listen") {
+        return ConfigOptions::parseField(key, value, 65535, listenPort, error);
+    } else if (key == "seed") {
+        return ConfigOptions::parseField(key, value, 0xFFFFFFFF, seed, error);
+    } else if (key == "report") {
+        return ConfigOptions::parseField(key, value, 3600, reportSeconds, error);
+    } else if (!conditions.set(key, value, error)) {
+        return error.empty() && network.set(key, value, error);
+    }
+    return true;
+}
+
+UdpProxy::UdpProxy(const ProxyConfig& cfg)
+    : config(cfg),
+      serverAddress{},
+      listenSocket(ENET_SOCKET_NULL),
+      running(false),
+      upstream(cfg.conditions, cfg.seed),
+      downstream(cfg.conditions, cfg.seed + 1),
+      buffer(ENET_PROTOCOL_MAXIMUM_MTU) {
+    if (config.listenPort == 0) {
+        config.listenPort = static_cast<uint16_t>(config.network.port + 1);
+    }
+}
+
+UdpProxy::~UdpProxy() {
+    for (Session& session : sessions) {
+        if (session.upstream != ENET_SOCKET_NULL) enet_socket_destroy(session.upstream);
+    }
+    if (listenSocket != ENET_SOCKET_NULL) {
+        enet_socket_destroy(listenSocket);
+        enet_deinitialize();
+    }
+}
+
+bool UdpProxy::start() {
+    if (PacketPool::initialize() != 0) {
+        std::cerr << "Failed to initialize ENet." << std::endl;
+        return false;
+    }
+
+    if (!config.network.resolveServerAddress(serverAddress)) {
+        std::cerr << "Cannot resolve server address " << config.network.serverAddress << std::endl;
+        enet_deinitialize();
+        return false;
+    }
+
+    ENetAddress listenAddress;
+    NetworkConfig listenConfig = config.network;
+    listenConfig.port = config.listenPort;
+    if (!listenConfig.resolveBindAddress(listenAddress)) {
+        std::cerr << "Cannot resolve bind address " << config.network.bindAddress << std::endl;
+        enet_deinitialize();
+        return false;
+    }
+
+    listenSocket = openSocket(listenAddress);
+    if (listenSocket == ENET_SOCKET_NULL) {
+        std::cerr << "Failed to listen on port " << config.listenPort << std::endl;
+        enet_deinitialize();
+        return false;
+    }
+
+    running = true;
+    std::cout << "Proxy on port " << config.listenPort << " -> " << config.network.serverAddress << ":" << config.network.port << " ("
+              << config.conditions.describe() << ")" << std::endl;
+    return true;
+}
+
+void UdpProxy::stop() {
+    running = false;
+}
+
+void UdpProxy::run() {
+    uint64_t nextReportUs = nowMicros() + config.reportSeconds * 1000000ull;
+    while (running) {
+        uint64_t nowUs = nowMicros();
+        bool busy = receiveFromClients(nowUs);
+        busy |= receiveFromServer(nowUs);
+        deliver(nowUs);
+        expireSessions(nowUs);
+
+        if (config.reportSeconds > 0 && nowUs >= nextReportUs) {
+            report();
+            nextReportUs = nowUs + config.reportSeconds * 1000000ull;
+        }
+
+        // Datagram delays are in milliseconds, so a short nap keeps timing honest without spinning
+        if (!busy) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+uint64_t UdpProxy::key(const ENetAddress& address) {
+    return (static_cast<uint64_t>(address.host) << 16) | address.port;
+}
+
+bool UdpProxy::receiveFromClients(uint64_t nowUs) {
+    bool received = false;
+    ENetAddress from;
+    ENetBuffer receiveBuffer = {buffer.data(), buffer.size()};
+    int length;
+    while ((length = enet_socket_receive(listenSocket, &from, &receiveBuffer, 1)) > 0) {
+        size_t session = sessionFor(from, nowUs);
+        if (session == sessions.size()) continue;  // No socket to forward it with
+        upstream.submit(nowUs, routeOf(session), buffer.data(), static_cast<size_t>(length));
+        received = true;
+    }
+    return received;
+}
+
+bool UdpProxy::receiveFromServer(uint64_t nowUs) {
+    bool received = false;
+    ENetAddress from;
+    ENetBuffer receiveBuffer = {buffer.data(), buffer.size()};
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        Session& session = sessions[i];
+        if (session.upstream == ENET_SOCKET_NULL) continue;
+
+        int length;
+        while ((length = enet_socket_receive(session.upstream, &from, &receiveBuffer, 1)) > 0) {
+            session.lastActiveUs = nowUs;
+            downstream.submit(nowUs, routeOf(i), buffer.data(), static_cast<size_t>(length));
+            received = true;
+        }
+    }
+    return received;
+}
+
+void UdpProxy::deliver(uint64_t nowUs) {
+    LinkConditioner::Datagram datagram;
+    while (upstream.pop(nowUs, datagram)) {
+        const Session* session = sessionOf(datagram.route);
+        if (session) sendDatagram(session->upstream, serverAddress, datagram.bytes);
+    }
+    while (downstream.pop(nowUs, datagram)) {
+        const Session* session = sessionOf(datagram.route);
+        if (session) sendDatagram(listenSocket, session->client, datagram.bytes);
+    }
+}
+
+void UdpProxy::expireSessions(uint64_t nowUs) {
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        Session& session = sessions[i];
+        if (session.upstream != ENET_SOCKET_NULL && nowUs - session.lastActiveUs > SESSION_TIMEOUT_US) {
+            enet_socket_destroy(session.upstream);
+            session.upstream = ENET_SOCKET_NULL;
+            sessionByClient.erase(key(session.client));
+            freeSessions.push_back(i);
+        }
+    }
+}
+
+uint64_t UdpProxy::routeOf(size_t session) const {
+    return (static_cast<uint64_t>(sessions[session].generation) << 32) | session;
+}
+
+const UdpProxy::Session* UdpProxy::sessionOf(uint64_t route) const {
+    const Session& session = sessions[static_cast<size_t>(route & 0xFFFFFFFF)];
+    if (session.upstream == ENET_SOCKET_NULL || session.generation != route >> 32) return nullptr;
+    return &session;
+}
+
+size_t UdpProxy::sessionFor(const ENetAddress& client, uint64_t nowUs) {
+    auto found = sessionByClient.find(key(client));
+    if (found != sessionByClient.end()) {
+        sessions[found->second].lastActiveUs = nowUs;
+        return found->second;
+    }
+
+    // Any local port will do; the server only needs to tell clients apart
+    ENetAddress any;
+    any.host = ENET_HOST_ANY;
+    any.port = 0;
+    ENetSocket socket = openSocket(any);
+    if (socket == ENET_SOCKET_NULL) {
+        std::cerr << "Failed to open an upstream socket for a new client" << std::endl;
+        return sessions.size();
+    }
+
+    size_t session;
+    if (freeSessions.empty()) {
+        session = sessions.size();
+        sessions.push_back({client, socket, nowUs, 0});
+    } else {
+        session = freeSessions.back();
+        freeSessions.pop_back();
+        sessions[session] = {client, socket, nowUs, sessions[session].generation + 1};
+    }
+    sessionByClient[key(client)] = session;
+    return session;
+}
+
+const LinkConditioner::Stats& UdpProxy::getUpstreamStats() const {
+    return upstream.getStats();
+}
+
+const LinkConditioner::Stats& UdpProxy::getDownstreamStats() const {
+    return downstream.getStats();
+}
+
+void UdpProxy::report() const {
+    const LinkConditioner::Stats& up = upstream.getStats();
+    const LinkConditioner::Stats& down = downstream.getStats();
+    std::printf("up: %lu in, %lu dropped, %lu duplicated | down: %lu in, %lu dropped, %lu duplicated | %zu clients\n", up.submitted,
+                up.dropped, up.duplicated, down.submitted, down.dropped, down.duplicated, sessionByClient.size());
+}
+
+void runProxy(const ProxyConfig& config) {
+    UdpProxy proxy(config);
+    if (!proxy.start()) {
+        std::cerr << "Failed to start proxy." << std::endl;
+        return;
+    }
+
+    proxy.run();
+}
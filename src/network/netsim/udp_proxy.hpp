@@ -0,0 +1,83 @@
+#ifndef UDP_PROXY_HPP
+#define UDP_PROXY_HPP
+
+#include <enet/enet.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network/netsim/link_conditions.hpp"
+#include "network/network_config.hpp"
+
+// Proxy options on top of LinkConditions and NetworkConfig's server/port (where traffic goes):
+//   listen=PORT   port clients connect to instead of the server's (default: port + 1)
+//   seed=N        random seed for loss, duplication and jitter
+//   report=SECS   print link statistics this often, 0 = never
+struct ProxyConfig {
+    NetworkConfig network;
+    uint16_t listenPort = 0;
+    LinkConditions conditions;
+    uint32_t seed = 1;
+    uint32_t reportSeconds = 10;
+
+    bool set(const std::string& key, const std::string& value, std::string& error);
+};
+
+// Relays UDP datagrams between clients and one server through a LinkConditioner per direction.
+// Each client gets its own upstream socket, so the server still sees one address per client and
+// ENet on both ends works unchanged. Everything runs on the thread calling run().
+class UdpProxy {
+   public:
+    explicit UdpProxy(const ProxyConfig& config);
+    ~UdpProxy();
+
+    bool start();
+    void run();  // Returns after stop()
+    void stop();
+
+    // Only meaningful once run() has returned
+    const LinkConditioner::Stats& getUpstreamStats() const;
+    const LinkConditioner::Stats& getDownstreamStats() const;
+
+   private:
+    static constexpr uint64_t SESSION_TIMEOUT_US = 30000000;  // ENet's own peer timeout is shorter
+
+    struct Session {
+        ENetAddress client;
+        ENetSocket upstream;  // ENET_SOCKET_NULL once expired
+        uint64_t lastActiveUs;
+        uint32_t generation;  // Bumped each time the slot is reused
+    };
+
+    static uint64_t key(const ENetAddress& address);
+    uint64_t routeOf(size_t session) const;
+    const Session* sessionOf(uint64_t route) const;  // nullptr once the route's client is gone
+    bool receiveFromClients(uint64_t nowUs);
+    bool receiveFromServer(uint64_t nowUs);
+    void deliver(uint64_t nowUs);
+    void expireSessions(uint64_t nowUs);
+    size_t sessionFor(const ENetAddress& client, uint64_t nowUs);
+    void report() const;
+
+    ProxyConfig config;
+    ENetAddress serverAddress;
+    ENetSocket listenSocket;
+    std::atomic<bool> running;
+
+    LinkConditioner upstream;    // Clients -> server
+    LinkConditioner downstream;  // Server -> clients
+
+    // Expired sessions leave their slot for the next client. Queued datagrams route by slot and
+    // generation, so whatever was still in flight for the old client is dropped, not misdelivered.
+    std::vector<Session> sessions;
+    std::vector<size_t> freeSessions;
+    std::unordered_map<uint64_t, size_t> sessionByClient;
+    std::vector<uint8_t> buffer;
+};
+
+void runProxy(const ProxyConfig& config);
+
+#endif
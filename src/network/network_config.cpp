@@ -0,0 +1,165 @@
+#include "network/network_config.hpp"
+
+#include <fstream>
+#include <limits>
+
+namespace {
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+uint32_t spread(uint32_t perPeer, size_t peers) {
+    uint64_t total = static_cast<uint64_t>(perPeer) * peers;
+    return total > std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : static_cast<uint32_t>(total);
+}
+}  // namespace
+
+bool NetworkConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "bind") {
+        bindAddress = value;
+    } else if (key == "server") {
+        serverAddress = value;
+    } else if (key == "port") {
+        return ConfigOptions::parseField(key, value, 65535, port, error);
+    } else if (key == "peers") {
+        return ConfigOptions::parseField(key, value, ENET_PROTOCOL_MAXIMUM_PEER_ID, peerCapacity, error);
+    } else if (key == "channels") {
+        return ConfigOptions::parseField(key, value, ENET_PROTOCOL_MAXIMUM_CHANNEL_COUNT, channelCount, error);
+    } else if (key == "bandwidth-in") {
+        return ConfigOptions::parseField(key, value, std::numeric_limits<uint32_t>::max(), peerIncomingBandwidth, error);
+    } else if (key == "bandwidth-out") {
+        return ConfigOptions::parseField(key, value, std::numeric_limits<uint32_t>::max(), peerOutgoingBandwidth, error);
+    } else if (key == "compression") {
+        if (value == "none") {
+            compression = CompressionMode::NONE;
+        } else if (value == "range") {
+            compression = CompressionMode::RANGE;
+        } else if (value == "huffman") {
+            compression = CompressionMode::HUFFMAN;
+        } else {
+            error = "compression must be none, range or huffman";
+            return false;
+        }
+    } else if (key == "compression-model") {
+        compressionModel = value;
+    } else if (key == "compression-record") {
+        compressionRecord = value;
+    } else if (key == "compress-channels") {
+        if (value == "all") {
+            compressedChannels = ALL_CHANNELS;
+            return true;
+        }
+        compressedChannels = 0;
+        uint64_t number = 0;
+        size_t begin = 0;
+        while (begin <= value.size()) {
+            size_t comma = value.find(',', begin);
+            if (comma == std::string::npos) comma = value.size();
+            if (!ConfigOptions::parseUnsigned(trim(value.substr(begin, comma - begin)), 31, number)) {
+                error = "Invalid channel list: " + value;
+                return false;
+            }
+            compressedChannels |= 1u << number;
+            begin = comma + 1;
+        }
+    } else {
+        error.clear();
+        return false;
+    }
+    return true;
+}
+
+bool NetworkConfig::validate(std::string& error) const {
+    if (peerCapacity == 0) {
+        error = "peers must be at least 1";
+        return false;
+    }
+    if (channelCount < Protocol::CHANNEL_COUNT) {
+        error = "channels must be at least " + std::to_string(Protocol::CHANNEL_COUNT);
+        return false;
+    }
+    if (compression == CompressionMode::HUFFMAN && compressionModel.empty()) {
+        error = "compression=huffman needs compression-model=FILE (see the train role)";
+        return false;
+    }
+    return true;
+}
+
+bool NetworkConfig::resolveBindAddress(ENetAddress& address) const {
+    address.host = ENET_HOST_ANY;
+    address.port = port;
+    return bindAddress.empty() || enet_address_set_host(&address, bindAddress.c_str()) == 0;
+}
+
+bool NetworkConfig::resolveServerAddress(ENetAddress& address) const {
+    address.port = port;
+    return enet_address_set_host(&address, serverAddress.c_str()) == 0;
+}
+
+uint32_t NetworkConfig::hostIncomingBandwidth() const {
+    return spread(peerIncomingBandwidth, peerCapacity);
+}
+
+uint32_t NetworkConfig::hostOutgoingBandwidth() const {
+    return spread(peerOutgoingBandwidth, peerCapacity);
+}
+
+bool ConfigOptions::parseUnsigned(const std::string& value, uint64_t max, uint64_t& out) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos || value.size() > 19) {
+        return false;
+    }
+    out = std::stoull(value);
+    return out <= max;
+}
+
+bool ConfigOptions::parseFile(const std::string& path, Options& options, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "Cannot open config file " + path;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected key = value";
+            return false;
+        }
+        options.emplace_back(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+    }
+    return true;
+}
+
+bool ConfigOptions::load(int argc, char** argv, int first, Options& options, std::string& error) {
+    Options arguments;
+    for (int i = first; i < argc; ++i) {
+        std::string argument = argv[i];
+        size_t equals = argument.find('=');
+        if (argument.rfind("--", 0) != 0 || equals == std::string::npos) {
+            error = "Expected --key=value, got " + argument;
+            return false;
+        }
+
+        std::string key = argument.substr(2, equals - 2);
+        std::string value = argument.substr(equals + 1);
+        if (key == "config") {
+            if (!parseFile(value, options, error)) return false;
+        } else {
+            arguments.emplace_back(key, value);
+        }
+    }
+
+    options.insert(options.end(), arguments.begin(), arguments.end());
+    return true;
+}
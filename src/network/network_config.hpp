@@ -0,0 +1,93 @@
+#ifndef NETWORK_CONFIG_HPP
+#define NETWORK_CONFIG_HPP
+
+#include <enet/enet.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "network/protocol.hpp"
+
+// Endpoint settings for NetworkManager and the match server.
+// Options come from "--key=value" arguments and/or a config file of "key = value" lines.
+//
+//   bind=ADDR            address to listen on when hosting (default: all interfaces)
+//   server=ADDR          host or server to connect to as a client (default: localhost)
+//   port=N               UDP port (default: 1234)
+//   peers=N              peer capacity when hosting (max 4095)
+//   channels=N           ENet channels per peer (at least Protocol::CHANNEL_COUNT)
+//   bandwidth-in=BYTES   per-peer incoming cap in bytes/second, 0 = unlimited
+//   bandwidth-out=BYTES  per-peer outgoing cap in bytes/second, 0 = unlimited
+//   compression=MODE     none, range (ENet's adaptive range coder) or huffman (static trained model)
+//   compression-model=FILE   model written by the train role, required for huffman
+//   compression-record=FILE  record outgoing traffic into FILE to train a model from
+//   compress-channels=LIST   comma-separated channels worth compressing, or "all" (default)
+//
+// Compression settings must match on both ends of a connection.
+enum class CompressionMode { NONE, RANGE, HUFFMAN };
+
+struct NetworkConfig {
+    static constexpr uint32_t ALL_CHANNELS = 0xFFFFFFFF;
+
+    std::string bindAddress;
+    std::string serverAddress = "localhost";
+    uint16_t port = Protocol::DEFAULT_PORT;
+    size_t peerCapacity = 8;
+    size_t channelCount = Protocol::CHANNEL_COUNT;
+    uint32_t peerIncomingBandwidth = 0;
+    uint32_t peerOutgoingBandwidth = 0;
+    CompressionMode compression = CompressionMode::NONE;
+    std::string compressionModel;
+    std::string compressionRecord;
+    uint32_t compressedChannels = ALL_CHANNELS;  // Bit per channel
+
+    // Returns false with an empty error for keys that belong to someone else
+    bool set(const std::string& key, const std::string& value, std::string& error);
+    bool validate(std::string& error) const;
+
+    bool resolveBindAddress(ENetAddress& address) const;
+    bool resolveServerAddress(ENetAddress& address) const;
+
+    // ENet throttles whole hosts; spread the per-peer caps over every slot
+    uint32_t hostIncomingBandwidth() const;
+    uint32_t hostOutgoingBandwidth() const;
+};
+
+namespace ConfigOptions {
+using Options = std::vector<std::pair<std::string, std::string>>;
+
+// Reads "--key=value" arguments starting at argv[first]. A "--config=FILE" argument loads that
+// file first, so values given on the command line win over the file.
+bool load(int argc, char** argv, int first, Options& options, std::string& error);
+bool parseFile(const std::string& path, Options& options, std::string& error);
+
+bool parseUnsigned(const std::string& value, uint64_t max, uint64_t& out);
+
+// A whole number no larger than max into field; otherwise an error naming the key
+template <typename T>
+bool parseField(const std::string& key, const std::string& value, uint64_t max, T& field, std::string& error) {
+    uint64_t number = 0;
+    if (!parseUnsigned(value, max, number)) {
+        error = "Invalid value for " + key + ": " + value;
+        return false;
+    }
+    field = static_cast<T>(number);
+    return true;
+}
+
+// Hands every option to config.set(), stopping at the first it rejects or doesn't know
+template <typename Config>
+bool applyOptions(Config& config, const Options& options, std::string& error) {
+    for (const auto& option : options) {
+        if (!config.set(option.first, option.second, error)) {
+            if (error.empty()) error = "Unknown option: " + option.first;
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace ConfigOptions
+
+#endif
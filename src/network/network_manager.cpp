@@ -1,206 +1,504 @@
 #include "network/network_manager.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
-
-NetworkManager::NetworkManager(bool hostFlag) : isHost(hostFlag), host(nullptr), peer(nullptr) {}
+#include <string>
+
+#include "core/constants.hpp"
+#include "network/compression.hpp"
+#include "network/packet_pool.hpp"
+
+NetworkManager::NetworkManager(bool hostFlag, const NetworkConfig& cfg)
+    : isHost(hostFlag),
+      config(cfg),
+      host(nullptr),
+      peer(nullptr),
+      connectedPeers(0),
+      ownSlot(hostFlag ? Protocol::OWNER_HOST : Protocol::OWNER_SELF),
+      tickRate(Constants::TICK_RATE),
+      peerEventCursor(0),
+      serverAddress(),
+      session(0),
+      resumeAttempts(0) {}
 
 NetworkManager::~NetworkManager() {
+    dropInbox();
     if (host) enet_host_destroy(host);
     enet_deinitialize();
 }
 
 bool NetworkManager::init() {
-    if (enet_initialize() != 0) {
+    std::string error;
+    if (!config.validate(error)) {
+        std::cerr << "Invalid network config: " << error << std::endl;
+        return false;
+    }
+
+    if (PacketPool::initialize() != 0) {
         std::cerr << "ENet failed to initialize." << std::endl;
         return false;
     }
 
     if (isHost) {
         ENetAddress address;
-        address.host = ENET_HOST_ANY;
-        address.port = 1234;
+        if (!config.resolveBindAddress(address)) {
+            std::cerr << "Cannot resolve bind address " << config.bindAddress << std::endl;
+            return false;
+        }
 
-        host = enet_host_create(&address, 2, 2, 0, 0);
-        std::cout << "Hosting on port 1234..." << std::endl;
+        host = enet_host_create(&address, config.peerCapacity, config.channelCount, config.hostIncomingBandwidth(),
+                                config.hostOutgoingBandwidth());
+        clients.reserve(config.peerCapacity);
+        std::cout << "Hosting on port " << config.port << " for up to " << config.peerCapacity << " peers..." << std::endl;
     } else {
-        host = enet_host_create(nullptr, 1, 2, 0, 0);
         ENetAddress address;
-        enet_address_set_host(&address, "localhost");  // replace with IP later
-        address.port = 1234;
+        if (!config.resolveServerAddress(address)) {
+            std::cerr << "Cannot resolve server address " << config.serverAddress << std::endl;
+            return false;
+        }
+
+        host = enet_host_create(nullptr, 1, config.channelCount, config.peerIncomingBandwidth, config.peerOutgoingBandwidth);
+        if (host) {
+            peer = enet_host_connect(host, &address, config.channelCount, Protocol::connectData(0, 0));
+        }
+        serverAddress = address;
+        connectStarted = std::chrono::steady_clock::now();
+        std::cout << "Connecting to " << config.serverAddress << ":" << config.port << "..." << std::endl;
+    }
 
-        peer = enet_host_connect(host, &address, 2, 0);
-        std::cout << "Connecting to server..." << std::endl;
+    if (host && !Compression::install(host, config)) {
+        enet_host_destroy(host);
+        host = nullptr;
+        peer = nullptr;
     }
 
     return host != nullptr;
 }
 
-void NetworkManager::sendPosition(float x, float y) {
-    float pos[2] = {x, y};
-    ENetPacket* packet = enet_packet_create(pos, sizeof(pos), ENET_PACKET_FLAG_RELIABLE);
-
-    if (isHost && peer) {
-        enet_peer_send(peer, 0, packet);
-    } else if (!isHost) {
-        enet_peer_send(peer, 0, packet);
+void NetworkManager::dropInbox() {
+    for (Incoming& incoming : inbox) {
+        if (incoming.packet) enet_packet_destroy(incoming.packet);
     }
-
-    enet_host_flush(host);
+    inbox.clear();
+    for (size_t& cursor : inboxCursor) cursor = 0;
 }
 
-bool NetworkManager::receivePosition(float& x, float& y) {
+void NetworkManager::service() {
+    // Anything not read last frame is stale now
+    dropInbox();
+    peerEvents.clear();
+    peerEventCursor = 0;
+
+    if (!host) return;
+
     ENetEvent event;
     while (enet_host_service(host, &event, 0) > 0) {
-        if (event.type == ENET_EVENT_TYPE_RECEIVE) {
-            if (event.packet->dataLength == sizeof(float) * 2) {
-                float* data = reinterpret_cast<float*>(event.packet->data);
-                x = data[0];
-                y = data[1];
-                enet_packet_destroy(event.packet);
-                return true;
-            }
-            enet_packet_destroy(event.packet);
-        } else if (event.type == ENET_EVENT_TYPE_CONNECT) {
-            peer = event.peer;
-            std::cout << "Peer connected!" << std::endl;
+        switch (event.type) {
+            case ENET_EVENT_TYPE_CONNECT:
+                if (isHost && Protocol::negotiateVersion(Protocol::versionOf(event.data)) == 0) {
+                    std::cout << "Rejecting a client that speaks protocol version " << int(Protocol::versionOf(event.data))
+                              << std::endl;
+                    enet_peer_disconnect(event.peer, Protocol::DISCONNECT_VERSION | Protocol::PROTOCOL_VERSION);
+                    break;
+                }
+                connectedPeers++;
+                if (isHost) {
+                    addClient(event.peer);
+                    uint16_t joined = Protocol::ownerForPeer(event.peer->incomingPeerID);
+                    peerEvents.push_back({PeerEvent::Type::JOINED, joined});
+                    sendWelcome(event.peer, joined, Protocol::negotiateVersion(Protocol::versionOf(event.data)));
+                } else {
+                    peer = event.peer;
+                    snapshotAssembler.clear();
+                    liveHealthOwners.clear();
+                }
+                std::cout << "Peer connected!" << std::endl;
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT:
+                if (isHost && !event.peer->data) {
+                    break;  // Refused for its version, never joined
+                }
+                if (connectedPeers > 0) connectedPeers--;
+                if (isHost) {
+                    removeClient(event.peer);
+                    uint16_t left = Protocol::ownerForPeer(event.peer->incomingPeerID);
+                    peerEvents.push_back({PeerEvent::Type::LEFT, left});
+
+                    // Let the remaining clients drop that player too
+                    uint8_t notice[Protocol::PlayerLeftMessage::SIZE];
+                    Protocol::PlayerLeftMessage::write(notice, left);
+                    send(Protocol::MessageType::PLAYER_LEFT,
+                         enet_packet_create(notice, sizeof(notice), Protocol::packetFlags(Protocol::MessageType::PLAYER_LEFT)));
+                } else {
+                    // Lost the host: everyone we knew through it is gone
+                    for (uint16_t known : knownOwners) {
+                        peerEvents.push_back({PeerEvent::Type::LEFT, known});
+                    }
+                    knownOwners.clear();
+                    peer = nullptr;
+                    ownSlot = Protocol::OWNER_SELF;
+                }
+                std::cout << "Peer disconnected." << std::endl;
+                if (!isHost && (event.data & ~Protocol::VERSION_MASK) == Protocol::DISCONNECT_VERSION) {
+                    // Reconnecting would only be refused again
+                    std::cerr << "The server speaks protocol version " << (event.data & Protocol::VERSION_MASK) << ", this build "
+                              << int(Protocol::MIN_PROTOCOL_VERSION) << " to " << int(Protocol::PROTOCOL_VERSION) << std::endl;
+                    session = 0;
+                } else if (!isHost) {
+                    resume();
+                }
+                break;
+            case ENET_EVENT_TYPE_RECEIVE:
+                handleReceive(event);
+                break;
+            default:
+                break;
         }
     }
-    return false;
 }
 
-void NetworkManager::sendBullets(const std::vector<Bullet>& bullets) {
-    std::vector<uint8_t> buffer;
+void NetworkManager::handleReceive(const ENetEvent& event) {
+    ENetPacket* packet = event.packet;
+
+    Protocol::MessageType type;
+    if (!Protocol::identify(event.channelID, packet->data, packet->dataLength, type)) {
+        enet_packet_destroy(packet);
+        return;
+    }
 
-    for (const Bullet& bullet : bullets) {
-        std::vector<uint8_t> serializedBullet = bullet.serialize();
-        buffer.insert(buffer.end(), serializedBullet.begin(), serializedBullet.end());
+    // The host is the authority: it only takes input and resets from clients, and only it
+    // sends state, welcomes and departures
+    bool fromAuthority = !isHost;
+    bool accepted;
+    switch (type) {
+        case Protocol::MessageType::INPUT:
+            accepted = isHost;
+            break;
+        case Protocol::MessageType::RESET:
+        case Protocol::MessageType::DAMAGE:
+            accepted = true;
+            break;
+        default:
+            accepted = fromAuthority;
+            break;
+    }
+    if (!accepted) {
+        enet_packet_destroy(packet);
+        return;
     }
 
-    ENetPacket* packet = enet_packet_create(buffer.data(), buffer.size(), ENET_PACKET_FLAG_RELIABLE);
+    if (type == Protocol::MessageType::WELCOME) {
+        // The server picks a version this build offered, so anything else is a malformed welcome
+        uint16_t slot = 0;
+        uint32_t rate = 0;
+        uint32_t newSession = 0;
+        uint8_t version = 0;
+        if (!Protocol::WelcomeMessage::read(packet->data, packet->dataLength, slot, rate, newSession, version) ||
+            version < Protocol::MIN_PROTOCOL_VERSION || version > Protocol::PROTOCOL_VERSION) {
+            enet_packet_destroy(packet);
+            return;
+        }
+        ownSlot = slot;
+        tickRate = rate != 0 ? rate : Constants::TICK_RATE;
+        session = newSession;
+        resumeAttempts = 0;
+        enet_packet_destroy(packet);
+        return;
+    }
 
-    if (isHost && peer) {
-        enet_peer_send(peer, 0, packet);
-    } else if (!isHost) {
-        enet_peer_send(peer, 0, packet);
+    if (type == Protocol::MessageType::SNAPSHOT) {
+        // Collected here; the inbox only ever holds whole messages
+        snapshotAssembler.add(packet->data, packet->dataLength);
+        enet_packet_destroy(packet);
+        return;
     }
 
-    enet_host_flush(host);
-}
+    if (type == Protocol::MessageType::PLAYER_LEFT) {
+        uint16_t left = Protocol::PlayerLeftMessage::get<0>(packet->data);
+        peerEvents.push_back({PeerEvent::Type::LEFT, left});
+        knownOwners.erase(std::remove(knownOwners.begin(), knownOwners.end(), left), knownOwners.end());
+        enet_packet_destroy(packet);
+        return;
+    }
 
-bool NetworkManager::receiveBullets(std::vector<Bullet>& bullets) {
-    ENetEvent event;
-    while (enet_host_service(host, &event, 0) > 0) {
-        if (event.type == ENET_EVENT_TYPE_RECEIVE) {
-            const uint8_t* data = event.packet->data;
-            size_t offset = 0;
-
-            while (offset < event.packet->dataLength) {
-                bullets.push_back(Bullet::deserialize(data, offset));
-            }
-
-            enet_packet_destroy(event.packet);
-            return true;
-        } else if (event.type == ENET_EVENT_TYPE_CONNECT) {
-            peer = event.peer;
-            std::cout << "Peer connected!" << std::endl;
+    uint16_t sender = Protocol::OWNER_HOST;
+    if (isHost) {
+        sender = Protocol::ownerForPeer(event.peer->incomingPeerID);
+    } else if (Protocol::isPlayerState(type)) {
+        sender = Protocol::readOwner(packet->data);
+        noteOwner(sender);
+        if (type == Protocol::MessageType::HEALTH && !hasLiveHealth(sender)) {
+            liveHealthOwners.push_back(sender);
         }
     }
-    return false;
+
+    if (isHost && type == Protocol::MessageType::RESET) {
+        relayToOthers(event.peer, type, packet);
+    }
+
+    inbox.push_back({type, sender, packet});
 }
 
-void NetworkManager::sendDamage(int damage) {
-    ENetPacket* packet = enet_packet_create(&damage, sizeof(int), ENET_PACKET_FLAG_RELIABLE);
+void NetworkManager::addClient(ENetPeer* client) {
+    clients.push_back(client);
+    client->data = reinterpret_cast<void*>(static_cast<uintptr_t>(clients.size()));
+}
 
-    if (isHost && peer) {
-        enet_peer_send(peer, 1, packet);
-    } else if (!isHost) {
-        enet_peer_send(peer, 1, packet);
+void NetworkManager::removeClient(ENetPeer* client) {
+    size_t slot = static_cast<size_t>(reinterpret_cast<uintptr_t>(client->data));
+    if (slot == 0 || slot > clients.size()) {
+        return;
     }
 
-    enet_host_flush(host);
+    // Swap the last client into the hole
+    ENetPeer* last = clients.back();
+    clients[slot - 1] = last;
+    last->data = reinterpret_cast<void*>(static_cast<uintptr_t>(slot));
+    clients.pop_back();
+    client->data = nullptr;
 }
 
-bool NetworkManager::receiveDamage(int& damage) {
-    ENetEvent event;
-    while (enet_host_service(host, &event, 0) > 0) {
-        if (event.type == ENET_EVENT_TYPE_RECEIVE && event.channelID == 1) {
-            if (event.packet->dataLength == sizeof(int)) {
-                int* data = reinterpret_cast<int*>(event.packet->data);
-                damage = *data;
-                enet_packet_destroy(event.packet);
-                return true;
-            }
-            enet_packet_destroy(event.packet);
-        } else if (event.type == ENET_EVENT_TYPE_CONNECT) {
-            peer = event.peer;
-            std::cout << "Peer connected!" << std::endl;
+void NetworkManager::relayToOthers(const ENetPeer* sender, Protocol::MessageType type, const ENetPacket* packet) {
+    // Forwarded with the message's own delivery class; the received packet's flags don't carry it
+    Protocol::Route route = Protocol::routeOf(type);
+    uint32_t flags = Protocol::packetFlags(route.delivery);
+    for (ENetPeer* other : clients) {
+        if (other == sender) continue;
+
+        // Our copy stays in the inbox, so the relay gets its own packet
+        ENetPacket* copy = enet_packet_create(packet->data, packet->dataLength, flags);
+        if (enet_peer_send(other, route.channel, copy) != 0) {
+            enet_packet_destroy(copy);
         }
     }
-    return false;
 }
 
-bool NetworkManager::isConnected() const {
-    return peer != nullptr;
+void NetworkManager::noteOwner(uint16_t remote) {
+    if (remote != ownSlot && std::find(knownOwners.begin(), knownOwners.end(), remote) == knownOwners.end()) {
+        knownOwners.push_back(remote);
+    }
 }
 
-void NetworkManager::sendHealth(int health) {
-    ENetPacket* packet = enet_packet_create(&health, sizeof(int), ENET_PACKET_FLAG_RELIABLE);
+void NetworkManager::sendWelcome(ENetPeer* client, uint16_t slot, uint8_t version) {
+    // A hosting player keeps no sessions: a client that drops out joins again as a new player
+    uint32_t noSession = 0;
+    uint8_t welcome[Protocol::WelcomeMessage::SIZE];
+    Protocol::WelcomeMessage::write(welcome, slot, tickRate, noSession, version);
+
+    Protocol::Route route = Protocol::routeOf(Protocol::MessageType::WELCOME);
+    ENetPacket* packet = enet_packet_create(welcome, sizeof(welcome), Protocol::packetFlags(route.delivery));
+    if (enet_peer_send(client, route.channel, packet) != 0) {
+        enet_packet_destroy(packet);
+    }
+}
 
-    if (isHost && peer) {
-        enet_peer_send(peer, 2, packet);  // Use channel 2 for health
-    } else if (!isHost) {
-        enet_peer_send(peer, 2, packet);
+void NetworkManager::resume() {
+    if (session == 0 || resumeAttempts >= MAX_RESUME_ATTEMPTS) {
+        return;
     }
 
-    enet_host_flush(host);
+    // A failed attempt ends in another disconnect event, which tries again
+    resumeAttempts++;
+    peer = enet_host_connect(host, &serverAddress, config.channelCount, Protocol::connectData(Protocol::CONNECT_RESUME, session));
+    connectStarted = std::chrono::steady_clock::now();
+    std::cout << "Connection lost, resuming (attempt " << resumeAttempts << " of " << MAX_RESUME_ATTEMPTS << ")..." << std::endl;
 }
 
-bool NetworkManager::receiveHealth(int& health) {
-    ENetEvent event;
-    while (enet_host_service(host, &event, 0) > 0) {
-        if (event.type == ENET_EVENT_TYPE_RECEIVE && event.channelID == 2) {
-            if (event.packet->dataLength == sizeof(int)) {
-                int* data = reinterpret_cast<int*>(event.packet->data);
-                health = *data;
-                enet_packet_destroy(event.packet);
-                return true;
-            }
-            enet_packet_destroy(event.packet);
-        } else if (event.type == ENET_EVENT_TYPE_CONNECT) {
-            peer = event.peer;
-            std::cout << "Peer connected!" << std::endl;
+bool NetworkManager::receiveSnapshot(Snapshot& snapshot) {
+    if (!snapshotAssembler.isComplete()) {
+        return false;
+    }
+
+    const std::vector<uint8_t>& data = snapshotAssembler.getData();
+    bool decoded = decodeSnapshot(data.data(), data.size(), snapshot);
+    snapshotAssembler.clear();
+    if (!decoded) {
+        std::cerr << "Dropped a malformed snapshot." << std::endl;
+    }
+    return decoded;
+}
+
+bool NetworkManager::hasLiveHealth(uint16_t owner) const {
+    return std::find(liveHealthOwners.begin(), liveHealthOwners.end(), owner) != liveHealthOwners.end();
+}
+
+double NetworkManager::getSecondsSinceConnecting() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - connectStarted).count();
+}
+
+uint16_t NetworkManager::getOwner() const {
+    return ownSlot;
+}
+
+uint32_t NetworkManager::getTickRate() const {
+    return tickRate;
+}
+
+bool NetworkManager::pollPeerEvent(PeerEvent& event) {
+    if (peerEventCursor >= peerEvents.size()) {
+        return false;
+    }
+    event = peerEvents[peerEventCursor++];
+    return true;
+}
+
+ENetPacket* NetworkManager::take(Protocol::MessageType type, uint16_t& owner) {
+    size_t& cursor = inboxCursor[static_cast<size_t>(type)];
+    for (; cursor < inbox.size(); ++cursor) {
+        Incoming& incoming = inbox[cursor];
+        if (incoming.type == type && incoming.packet) {
+            ENetPacket* packet = incoming.packet;
+            incoming.packet = nullptr;
+            owner = incoming.owner;
+            ++cursor;
+            return packet;
         }
     }
-    return false;
+    return nullptr;
 }
 
-void NetworkManager::sendReset() {
-    int resetSignal = 1;
-    ENetPacket* packet = enet_packet_create(&resetSignal, sizeof(int), ENET_PACKET_FLAG_RELIABLE);
+void NetworkManager::send(Protocol::MessageType type, ENetPacket* packet) {
+    uint8_t channel = Protocol::routeOf(type).channel;
+    if (isHost) {
+        // Goes to every connected client; ENet frees the packet if nobody is connected
+        enet_host_broadcast(host, channel, packet);
+    } else if (!peer || enet_peer_send(peer, channel, packet) != 0) {
+        enet_packet_destroy(packet);
+    }
+}
+
+void NetworkManager::flush() {
+    if (host) enet_host_flush(host);
+}
+
+void NetworkManager::sendInput(uint32_t newestTick, const uint8_t* buttons, size_t count) {
+    if (count == 0 || count > Protocol::INPUT_REDUNDANCY) {
+        return;
+    }
+
+    using Input = Protocol::InputMessage;
+    ENetPacket* packet = PacketPool::createPacket(Input::sizeFor(count), Protocol::packetFlags(Protocol::MessageType::INPUT));
+    Input::write(packet->data, newestTick);
+    std::memcpy(Input::element(packet->data, 0), buttons, count);
+    send(Protocol::MessageType::INPUT, packet);
+}
+
+bool NetworkManager::receiveInput(uint16_t& owner, uint32_t& newestTick, uint8_t* buttons, size_t& count) {
+    ENetPacket* packet = take(Protocol::MessageType::INPUT, owner);
+    if (!packet) {
+        return false;
+    }
+
+    using Input = Protocol::InputMessage;
+    Input::read(packet->data, packet->dataLength, newestTick, count);
+    std::memcpy(buttons, Input::element(packet->data, 0), count);
+    enet_packet_destroy(packet);
+    return true;
+}
 
-    if (isHost && peer) {
-        enet_peer_send(peer, 3, packet);  // Use channel 3 for reset
-    } else if (!isHost) {
-        enet_peer_send(peer, 3, packet);
+void NetworkManager::sendPosition(uint16_t owner, float x, float y, uint32_t ackTick) {
+    using Position = Protocol::PositionMessage;
+    ENetPacket* packet = PacketPool::createPacket(Position::SIZE, Protocol::packetFlags(Protocol::MessageType::POSITION));
+    Position::write(packet->data, owner, x, y, ackTick);
+    send(Protocol::MessageType::POSITION, packet);
+}
+
+bool NetworkManager::receivePosition(uint16_t& owner, float& x, float& y, uint32_t& ackTick) {
+    ENetPacket* packet = take(Protocol::MessageType::POSITION, owner);
+    if (!packet) {
+        return false;
+    }
+
+    Protocol::PositionMessage::read(packet->data, packet->dataLength, owner, x, y, ackTick);
+    enet_packet_destroy(packet);
+    return true;
+}
+
+void NetworkManager::sendBullets(uint16_t owner, uint8_t shots, const std::vector<Bullet>& bullets) {
+    // Serialized straight into the packet's pooled buffer
+    using Bullets = Protocol::BulletsMessage;
+    size_t count = std::min(bullets.size(), Bullets::MAX_COUNT);
+    ENetPacket* packet = PacketPool::createPacket(Bullets::sizeFor(count), Protocol::packetFlags(Protocol::MessageType::BULLETS));
+    Bullets::write(packet->data, owner, shots);
+    for (size_t i = 0; i < count; ++i) {
+        bullets[i].serialize(Bullets::element(packet->data, i));
     }
 
-    enet_host_flush(host);
+    send(Protocol::MessageType::BULLETS, packet);
+}
+
+bool NetworkManager::receiveBullets(uint16_t& owner, uint8_t& shots, std::pmr::vector<Bullet>& bullets) {
+    ENetPacket* packet = take(Protocol::MessageType::BULLETS, owner);
+    if (!packet) {
+        return false;
+    }
+
+    shots = Protocol::BulletsMessage::get<1>(packet->data);
+
+    size_t count = Protocol::BulletsMessage::countOf(packet->dataLength);
+    size_t offset = Protocol::BulletsMessage::SIZE;
+    for (size_t i = 0; i < count; ++i) {
+        bullets.push_back(Bullet::deserialize(packet->data, offset));
+    }
+
+    enet_packet_destroy(packet);
+    return true;
+}
+
+void NetworkManager::sendDamage(int damage) {
+    uint8_t message[Protocol::DamageMessage::SIZE];
+    Protocol::DamageMessage::write(message, damage);
+    send(Protocol::MessageType::DAMAGE, enet_packet_create(message, sizeof(message), Protocol::packetFlags(Protocol::MessageType::DAMAGE)));
+}
+
+bool NetworkManager::receiveDamage(uint16_t& owner, int& damage) {
+    ENetPacket* packet = take(Protocol::MessageType::DAMAGE, owner);
+    if (!packet) {
+        return false;
+    }
+
+    Protocol::DamageMessage::read(packet->data, packet->dataLength, damage);
+    enet_packet_destroy(packet);
+    return true;
+}
+
+bool NetworkManager::isConnected() const {
+    return connectedPeers > 0;
+}
+
+void NetworkManager::sendHealth(uint16_t owner, int health) {
+    using Health = Protocol::HealthMessage;
+    ENetPacket* packet = PacketPool::createPacket(Health::SIZE, Protocol::packetFlags(Protocol::MessageType::HEALTH));
+    Health::write(packet->data, owner, health);
+    send(Protocol::MessageType::HEALTH, packet);
+}
+
+bool NetworkManager::receiveHealth(uint16_t& owner, int& health) {
+    ENetPacket* packet = take(Protocol::MessageType::HEALTH, owner);
+    if (!packet) {
+        return false;
+    }
+
+    Protocol::HealthMessage::read(packet->data, packet->dataLength, owner, health);
+    enet_packet_destroy(packet);
+    return true;
+}
+
+void NetworkManager::sendReset() {
+    uint8_t message[Protocol::ResetMessage::SIZE];
+    Protocol::ResetMessage::write(message);
+    send(Protocol::MessageType::RESET, enet_packet_create(message, sizeof(message), Protocol::packetFlags(Protocol::MessageType::RESET)));
 }
 
 bool NetworkManager::receiveReset() {
-    ENetEvent event;
-    while (enet_host_service(host, &event, 0) > 0) {
-        if (event.type == ENET_EVENT_TYPE_RECEIVE && event.channelID == 3) {
-            if (event.packet->dataLength == sizeof(int)) {
-                enet_packet_destroy(event.packet);
-                return true;
-            }
-            enet_packet_destroy(event.packet);
-        } else if (event.type == ENET_EVENT_TYPE_CONNECT) {
-            peer = event.peer;
-            std::cout << "Peer connected!" << std::endl;
-        }
+    uint16_t owner;
+    ENetPacket* packet = take(Protocol::MessageType::RESET, owner);
+    if (!packet) {
+        return false;
     }
-    return false;
+
+    enet_packet_destroy(packet);
+    return true;
 }
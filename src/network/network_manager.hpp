@@ -3,29 +3,71 @@
 
 #include <enet/enet.h>
 
+#include <chrono>
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 #include "entities/bullet.hpp"
+#include "network/network_config.hpp"
+#include "network/protocol.hpp"
+#include "network/snapshot.hpp"
+
+// A remote player joining or leaving, identified by its owner slot (see Protocol)
+struct PeerEvent {
+    enum class Type { JOINED, LEFT };
+
+    Type type;
+    uint16_t owner;
+};
 
 class NetworkManager {
    public:
-    NetworkManager(bool isHost);
+    NetworkManager(bool isHost, const NetworkConfig& config);
     ~NetworkManager();
     bool init();
-    void sendPosition(float x, float y);
-    bool receivePosition(float& x, float& y);
 
-    // New methods for sending and receiving bullets
-    void sendBullets(const std::vector<Bullet>& bullets);
-    bool receiveBullets(std::vector<Bullet>& bullets);
+    // Pumps ENet once per frame and queues everything that arrived.
+    // The receive methods below only read from that queue and report the owner slot of the player
+    // the data belongs to. The host is the authority: clients send it input, it sends everyone's state.
+    void service();
+    bool pollPeerEvent(PeerEvent& event);
+    // The send methods below only queue; this puts everything queued on the wire, packed into as few
+    // datagrams as ENet can. Once per frame, after the ticks.
+    void flush();
+
+    // Our own owner slot: OWNER_HOST on the host, assigned by the host's welcome on a client (OWNER_SELF until then)
+    uint16_t getOwner() const;
+    uint32_t getTickRate() const;  // The authority's simulation rate, which our input ticks must follow
+
+    // Client side. A match server follows its welcome with a snapshot of the whole match; this
+    // returns it once, after the last chunk arrived. Should the connection drop, the client
+    // connects again with the welcome's session and gets its player back with a fresh snapshot.
+    bool receiveSnapshot(Snapshot& snapshot);
+    bool hasLiveHealth(uint16_t owner) const;  // Health for owner arrived since we connected: newer than the snapshot's
+    double getSecondsSinceConnecting() const;   // Since the current connection (or resume) was started
+
+    // Client -> authority: the newest commands' buttons, newest first (see Protocol)
+    void sendInput(uint32_t newestTick, const uint8_t* buttons, size_t count);
+    // buttons must hold Protocol::INPUT_REDUNDANCY entries
+    bool receiveInput(uint16_t& owner, uint32_t& newestTick, uint8_t* buttons, size_t& count);
+
+    // Authority -> clients: state of the player in the given owner slot.
+    // ackTick is that player's newest input tick already applied, 0 for players without commands.
+    void sendPosition(uint16_t owner, float x, float y, uint32_t ackTick);
+    bool receivePosition(uint16_t& owner, float& x, float& y, uint32_t& ackTick);
+
+    // shots is the player's wrapping shot count, so a shot is seen even when no bullet was added in the end
+    void sendBullets(uint16_t owner, uint8_t shots, const std::vector<Bullet>& bullets);
+    bool receiveBullets(uint16_t& owner, uint8_t& shots, std::pmr::vector<Bullet>& bullets);
 
     // Damage message system
     void sendDamage(int damage);
-    bool receiveDamage(int& damage);
+    bool receiveDamage(uint16_t& owner, int& damage);
 
-    // Health synchronization for display
-    void sendHealth(int health);
-    bool receiveHealth(int& health);
+    // Health of the player in the given owner slot, decided by the authority
+    void sendHealth(uint16_t owner, int health);
+    bool receiveHealth(uint16_t& owner, int& health);
 
     // Reset synchronization
     void sendReset();
@@ -35,9 +77,51 @@ class NetworkManager {
     bool isConnected() const;
 
    private:
+    static constexpr int MAX_RESUME_ATTEMPTS = 5;
+
+    // Packets are classified once on arrival instead of by every receive call
+    struct Incoming {
+        Protocol::MessageType type;
+        uint16_t owner;
+        ENetPacket* packet;  // nullptr once consumed
+    };
+
+    void handleReceive(const ENetEvent& event);
+    void relayToOthers(const ENetPeer* sender, Protocol::MessageType type, const ENetPacket* packet);
+    void addClient(ENetPeer* client);
+    void removeClient(ENetPeer* client);
+    void noteOwner(uint16_t remote);
+    void sendWelcome(ENetPeer* client, uint16_t slot, uint8_t version);
+    void resume();
+    void send(Protocol::MessageType type, ENetPacket* packet);
+    ENetPacket* take(Protocol::MessageType type, uint16_t& owner);
+    void dropInbox();
+
     bool isHost;
+    NetworkConfig config;
     ENetHost* host;
-    ENetPeer* peer;
+    ENetPeer* peer;  // Connection to the host (client side only)
+    size_t connectedPeers;
+    uint16_t ownSlot;
+    uint32_t tickRate;
+
+    // Connected clients (host side). Each peer's data field holds its index here + 1,
+    // so joining and leaving are O(1) and relays never scan empty peer slots.
+    std::vector<ENetPeer*> clients;
+
+    std::vector<Incoming> inbox;
+    size_t inboxCursor[Protocol::MESSAGE_TYPE_COUNT] = {};  // First unread inbox entry per Protocol::MessageType
+    std::vector<PeerEvent> peerEvents;
+    size_t peerEventCursor;
+    std::vector<uint16_t> knownOwners;  // Remote players heard about through the host (client side)
+
+    // Client side: joining and resuming
+    ENetAddress serverAddress;
+    uint32_t session;  // From the welcome, 0 when the host can't resume us
+    int resumeAttempts;
+    std::chrono::steady_clock::time_point connectStarted;
+    SnapshotAssembler snapshotAssembler;
+    std::vector<uint16_t> liveHealthOwners;
 };
 
 #endif
@@ -0,0 +1,281 @@
+#include "network/packet_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace {
+constexpr size_t HEADER_SIZE = 16;  // Holds the class index and keeps blocks aligned like malloc's
+constexpr size_t BLOCKS_PER_SLAB = 64;
+constexpr size_t BATCH = 32;  // Blocks moved between a thread's cache and the shared list at once
+constexpr uint32_t OVERSIZE = 0xFFFFFFFF;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Blocks no thread is caching. Constant-initialized, so the pools work before main() too.
+struct SharedClass {
+    std::mutex mutex;
+    FreeBlock* freeList = nullptr;
+    size_t freeCount = 0;
+};
+
+SharedClass sharedClasses[PacketPool::CLASS_COUNT];
+std::atomic<uint64_t> oversizeCount{0};
+
+// Counters are only written by the thread that owns them, so a relaxed load and store is enough
+void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+struct Counters {
+    std::atomic<uint64_t> hits[PacketPool::CLASS_COUNT] = {};
+    std::atomic<uint64_t> misses[PacketPool::CLASS_COUNT] = {};
+    std::atomic<uint64_t> releases[PacketPool::CLASS_COUNT] = {};
+};
+
+// Counters of every live thread cache, plus the totals of caches whose threads have exited
+std::mutex countersMutex;
+std::vector<Counters*> liveCounters;
+uint64_t retiredHits[PacketPool::CLASS_COUNT] = {};
+uint64_t retiredMisses[PacketPool::CLASS_COUNT] = {};
+uint64_t retiredReleases[PacketPool::CLASS_COUNT] = {};
+
+size_t blockSizeOf(size_t index) {
+    return PacketPool::MIN_BLOCK_SIZE << index;
+}
+
+size_t classFor(size_t size) {
+    size_t index = 0;
+    while (index < PacketPool::CLASS_COUNT && blockSizeOf(index) < size) {
+        ++index;
+    }
+    return index;
+}
+
+uint8_t* payloadOf(uint8_t* raw, uint32_t index) {
+    *reinterpret_cast<uint32_t*>(raw) = index;
+    return raw + HEADER_SIZE;
+}
+
+// Per-thread free lists in front of the shared ones: the common allocate/release takes no lock
+class ThreadCache {
+   public:
+    ThreadCache() {
+        std::lock_guard<std::mutex> lock(countersMutex);
+        liveCounters.push_back(&counters);
+    }
+
+    ~ThreadCache() {
+        for (size_t index = 0; index < PacketPool::CLASS_COUNT; ++index) {
+            if (counts[index] > 0) giveBack(index, counts[index]);
+        }
+
+        std::lock_guard<std::mutex> lock(countersMutex);
+        for (size_t index = 0; index < PacketPool::CLASS_COUNT; ++index) {
+            retiredHits[index] += counters.hits[index];
+            retiredMisses[index] += counters.misses[index];
+            retiredReleases[index] += counters.releases[index];
+        }
+        liveCounters.erase(std::find(liveCounters.begin(), liveCounters.end(), &counters));
+    }
+
+    void* allocate(size_t index) {
+        if (!lists[index]) {
+            if (takeShared(index)) {
+                bump(counters.hits[index]);
+            } else if (carveSlab(index)) {
+                bump(counters.misses[index]);
+            } else {
+                return nullptr;
+            }
+        } else {
+            bump(counters.hits[index]);
+        }
+
+        FreeBlock* block = lists[index];
+        lists[index] = block->next;
+        counts[index]--;
+        return block;
+    }
+
+    void release(size_t index, void* block) {
+        FreeBlock* freed = static_cast<FreeBlock*>(block);
+        freed->next = lists[index];
+        lists[index] = freed;
+        bump(counters.releases[index]);
+
+        // A thread that mostly frees (packets received elsewhere) hands its surplus back
+        if (++counts[index] > 2 * BATCH) giveBack(index, BATCH);
+    }
+
+   private:
+    bool takeShared(size_t index) {
+        SharedClass& shared = sharedClasses[index];
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        while (shared.freeList && counts[index] < BATCH) {
+            FreeBlock* block = shared.freeList;
+            shared.freeList = block->next;
+            shared.freeCount--;
+            block->next = lists[index];
+            lists[index] = block;
+            counts[index]++;
+        }
+        return lists[index] != nullptr;
+    }
+
+    bool carveSlab(size_t index) {
+        size_t stride = HEADER_SIZE + blockSizeOf(index);
+        uint8_t* slab = static_cast<uint8_t*>(std::malloc(stride * BLOCKS_PER_SLAB));
+        if (!slab) return false;
+
+        for (size_t i = 0; i < BLOCKS_PER_SLAB; ++i) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(payloadOf(slab + i * stride, static_cast<uint32_t>(index)));
+            block->next = lists[index];
+            lists[index] = block;
+        }
+        counts[index] += BLOCKS_PER_SLAB;
+        return true;
+    }
+
+    void giveBack(size_t index, size_t count) {
+        SharedClass& shared = sharedClasses[index];
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        for (size_t i = 0; i < count && lists[index]; ++i) {
+            FreeBlock* block = lists[index];
+            lists[index] = block->next;
+            counts[index]--;
+            block->next = shared.freeList;
+            shared.freeList = block;
+            shared.freeCount++;
+        }
+    }
+
+    FreeBlock* lists[PacketPool::CLASS_COUNT] = {};
+    size_t counts[PacketPool::CLASS_COUNT] = {};
+    Counters counters;
+};
+
+// Plain pointers, so the hot path skips the guard of a thread_local with a destructor.
+// cacheGone is set once a thread's cache is destroyed; later frees on that thread
+// (static destructors) use the shared lists.
+thread_local ThreadCache* currentCache = nullptr;
+thread_local bool cacheGone = false;
+
+ThreadCache* threadCache() {
+    if (currentCache || cacheGone) return currentCache;
+
+    struct Holder {
+        ~Holder() {
+            currentCache = nullptr;
+            cacheGone = true;
+        }
+        ThreadCache cache;
+    };
+    thread_local Holder holder;
+    currentCache = &holder.cache;
+    return currentCache;
+}
+
+void releasePacketData(ENetPacket* packet) {
+    PacketPool::release(packet->data);
+}
+}  // namespace
+
+int PacketPool::initialize() {
+    ENetCallbacks callbacks = {allocate, release, nullptr};
+    return enet_initialize_with_callbacks(ENET_VERSION, &callbacks);
+}
+
+void* PacketPool::allocate(size_t size) {
+    size_t index = classFor(size);
+    if (index == CLASS_COUNT) {
+        oversizeCount++;
+        uint8_t* raw = static_cast<uint8_t*>(std::malloc(HEADER_SIZE + size));
+        return raw ? payloadOf(raw, OVERSIZE) : nullptr;
+    }
+
+    if (ThreadCache* cache = threadCache()) {
+        return cache->allocate(index);
+    }
+
+    // Thread shutting down: skip the cache and its statistics
+    size_t stride = HEADER_SIZE + blockSizeOf(index);
+    uint8_t* raw = static_cast<uint8_t*>(std::malloc(stride));
+    return raw ? payloadOf(raw, static_cast<uint32_t>(index)) : nullptr;
+}
+
+void PacketPool::release(void* block) {
+    if (!block) return;
+
+    uint8_t* raw = static_cast<uint8_t*>(block) - HEADER_SIZE;
+    uint32_t index = *reinterpret_cast<uint32_t*>(raw);
+    if (index == OVERSIZE) {
+        std::free(raw);
+        return;
+    }
+
+    if (ThreadCache* cache = threadCache()) {
+        cache->release(index, block);
+        return;
+    }
+
+    SharedClass& shared = sharedClasses[index];
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = shared.freeList;
+    shared.freeList = freed;
+    shared.freeCount++;
+}
+
+ENetPacket* PacketPool::createPacket(size_t length, uint32_t flags) {
+    void* data = allocate(length);
+    ENetPacket* packet = enet_packet_create(data, length, flags | ENET_PACKET_FLAG_NO_ALLOCATE);
+    if (!packet) {
+        release(data);
+        return nullptr;
+    }
+    packet->freeCallback = releasePacketData;
+    return packet;
+}
+
+PacketPool::Stats PacketPool::getStats() {
+    Stats stats;
+    std::lock_guard<std::mutex> lock(countersMutex);
+    for (size_t index = 0; index < CLASS_COUNT; ++index) {
+        uint64_t hits = retiredHits[index];
+        uint64_t misses = retiredMisses[index];
+        uint64_t releases = retiredReleases[index];
+        for (const Counters* counters : liveCounters) {
+            hits += counters->hits[index].load(std::memory_order_relaxed);
+            misses += counters->misses[index].load(std::memory_order_relaxed);
+            releases += counters->releases[index].load(std::memory_order_relaxed);
+        }
+        // Other threads keep counting while we read, so a snapshot can be off by a few
+        uint64_t allocations = hits + misses;
+        stats.classes[index] = {blockSizeOf(index), hits, misses, allocations > releases ? static_cast<size_t>(allocations - releases) : 0};
+    }
+    stats.oversize = oversizeCount;
+    return stats;
+}
+
+void PacketPool::printStats() {
+    Stats stats = getStats();
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    std::printf("  %6s %12s %8s %8s\n", "block", "hits", "misses", "live");
+    for (const ClassStats& sizeClass : stats.classes) {
+        if (sizeClass.hits + sizeClass.misses == 0) continue;
+        std::printf("  %6zu %12llu %8llu %8zu\n", sizeClass.blockSize, static_cast<unsigned long long>(sizeClass.hits),
+                    static_cast<unsigned long long>(sizeClass.misses), sizeClass.live);
+        hits += sizeClass.hits;
+        misses += sizeClass.misses;
+    }
+    uint64_t total = hits + misses + stats.oversize;
+    std::printf("  pool hit rate %.2f%% (%llu oversize allocations went to malloc)\n", total ? 100.0 * hits / total : 0.0,
+                static_cast<unsigned long long>(stats.oversize));
+}
@@ -0,0 +1,46 @@
+#ifndef PACKET_POOL_HPP
+#define PACKET_POOL_HPP
+
+#include <enet/enet.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Size-class pools behind ENet's allocator callbacks. Packets, packet data and ENet's per-send
+// command records all come and go every tick; with the pools they recycle blocks instead of
+// going through malloc. Requests above the largest class (peer tables, the range coder) go
+// straight to malloc. Freed blocks stay pooled for the life of the process.
+// Thread-safe: the match server, proxy and clients may run ENet hosts on different threads.
+namespace PacketPool {
+constexpr size_t CLASS_COUNT = 8;  // 32, 64, ... 4096 bytes
+constexpr size_t MIN_BLOCK_SIZE = 32;
+
+// Use instead of enet_initialize() so every ENet allocation goes through the pools.
+// Must come before the first host is created; calling it again is harmless.
+int initialize();
+
+void* allocate(size_t size);
+void release(void* block);
+
+// A packet whose data is a pooled block owned by us (ENET_PACKET_FLAG_NO_ALLOCATE) rather than a
+// copy ENet makes; the caller writes packet->data in place. The block returns to the pool when
+// ENet destroys the packet.
+ENetPacket* createPacket(size_t length, uint32_t flags);
+
+struct ClassStats {
+    size_t blockSize;
+    uint64_t hits;    // Served from a recycled block
+    uint64_t misses;  // Had to carve a new slab
+    size_t live;
+};
+
+struct Stats {
+    ClassStats classes[CLASS_COUNT];
+    uint64_t oversize;  // Passed through to malloc
+};
+
+Stats getStats();
+void printStats();
+}  // namespace PacketPool
+
+#endif
@@ -0,0 +1,56 @@
+#include "network/prediction.hpp"
+
+#include "core/map.hpp"
+#include "entities/player.hpp"
+#include "network/protocol.hpp"
+
+uint32_t ClientPrediction::record(const PlayerInput& input, uint8_t* buttons, size_t& count) {
+    // Every packet repeats the last few commands, so a lost one is covered by the next
+    inputTick++;
+    commandHistory.push(inputTick, input);
+    count = commandHistory.encodeRecent(buttons, Protocol::INPUT_REDUNDANCY);
+    return inputTick;
+}
+
+bool ClientPrediction::reconcile(Registry& registry, Entity local, const Map* map, Position authoritative, uint32_t ackTick,
+                                 float tickSeconds) {
+    // Nothing applied yet, or an older answer than one we already used
+    if (ackTick == 0 || ackTick <= lastAckedTick) {
+        return false;
+    }
+    lastAckedTick = ackTick;
+
+    Player player(registry, local);
+    Position predicted = player.getPosition();
+    Weapon& weapon = registry.getWeapon(local);
+    float timeSinceLastShot = weapon.timeSinceLastShot;
+
+    // Rewind to the authority's answer and replay what it hasn't seen yet, without firing again
+    player.setPosition(authoritative);
+    for (uint32_t tick = ackTick + 1; tick <= inputTick; ++tick) {
+        const InputCommand* command = commandHistory.find(tick);
+        if (!command) continue;
+        PlayerInput replay = command->input;
+        replay.fire = false;
+        player.move(map, replay, tickSeconds);
+    }
+    weapon.timeSinceLastShot = timeSinceLastShot;
+
+    Position replayed = player.getPosition();
+    if (replayed.x != predicted.x || replayed.y != predicted.y) {
+        corrections++;
+    }
+    return true;
+}
+
+uint32_t ClientPrediction::getTick() const {
+    return inputTick;
+}
+
+uint32_t ClientPrediction::getLastAckedTick() const {
+    return lastAckedTick;
+}
+
+unsigned long ClientPrediction::getCorrectionCount() const {
+    return corrections;
+}
@@ -0,0 +1,37 @@
+#ifndef PREDICTION_HPP
+#define PREDICTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/registry.hpp"
+#include "entities/components.hpp"
+#include "entities/position.hpp"
+#include "network/input_commands.hpp"
+
+class Map;
+
+// Client-side prediction of the local player. Each tick's input is recorded under its tick number
+// before it goes upstream; when the authority acknowledges a tick, the player is rewound to the
+// authority's position and the commands it hasn't seen yet are replayed.
+class ClientPrediction {
+   public:
+    // Records the input for the next tick and writes the newest commands' buttons for
+    // NetworkManager::sendInput (buttons must hold Protocol::INPUT_REDUNDANCY entries)
+    uint32_t record(const PlayerInput& input, uint8_t* buttons, size_t& count);
+
+    // Returns false for stale acks. A replay that disagrees with our prediction counts as a correction.
+    bool reconcile(Registry& registry, Entity local, const Map* map, Position authoritative, uint32_t ackTick, float tickSeconds);
+
+    uint32_t getTick() const;           // Newest recorded tick
+    uint32_t getLastAckedTick() const;  // Newest tick the authority has applied
+    unsigned long getCorrectionCount() const;
+
+   private:
+    uint32_t inputTick = 0;
+    uint32_t lastAckedTick = 0;
+    CommandHistory commandHistory;
+    unsigned long corrections = 0;
+};
+
+#endif
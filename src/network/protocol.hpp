@@ -0,0 +1,285 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <enet/enet.h>
+
+#include "entities/bullet.hpp"
+#include "entities/components.hpp"
+#include "network/schema.hpp"
+
+// Wire layout shared by the game's NetworkManager and the dedicated match server.
+//
+// The host or match server is the authority: clients only send input commands upstream, the
+// authority simulates every player and sends their state back down. Every message starts with
+// its MessageType as one byte, and its layout is declared once below (see network/schema.hpp).
+// Player state messages carry the owner slot of the player they describe first; a client learns
+// its own slot from WELCOME.
+namespace Protocol {
+constexpr uint16_t DEFAULT_PORT = 1234;
+
+// Bumped whenever a layout below changes. A client asks for the newest version it speaks in its
+// connect data; the server answers with the newest both speak in the welcome, or, when there is
+// none, disconnects it with DISCONNECT_VERSION and the version it speaks. Version 1 was the
+// headerless format told apart by sizes, version 2 sent every bullet's speed and color, version 3
+// sent bullets without the shooter's shot count; nothing speaks any of them any more.
+constexpr uint8_t PROTOCOL_VERSION = 4;
+constexpr uint8_t MIN_PROTOCOL_VERSION = 4;  // Oldest version this build still speaks
+
+// How a message travels:
+//  LATEST_STATE    unreliable sequenced: a lost packet is never resent and anything older than
+//                  what already arrived is dropped, so state updates can't stall behind retransmits
+//  RELIABLE_EVENT  reliable ordered: events that must arrive exactly once, in order
+//  FIRE_AND_FORGET unreliable unsequenced: cosmetic one-offs, any order, may be lost
+enum class DeliveryClass : uint8_t {
+    LATEST_STATE,
+    RELIABLE_EVENT,
+    FIRE_AND_FORGET,
+};
+
+enum class MessageType : uint8_t {
+    POSITION,
+    BULLETS,
+    HEALTH,
+    DAMAGE,
+    RESET,
+    PLAYER_LEFT,
+    EFFECT,
+    INPUT,
+    WELCOME,
+    SPECTATE,
+    SNAPSHOT,
+};
+constexpr size_t MESSAGE_TYPE_COUNT = static_cast<size_t>(MessageType::SNAPSHOT) + 1;
+
+// Every message type gets its own channel so sequencing and retransmits never block another type
+enum Channel : uint8_t {
+    CHANNEL_POSITION = 0,
+    CHANNEL_BULLETS = 1,
+    CHANNEL_HEALTH = 2,
+    CHANNEL_CONTROL = 3,  // Reset, player-left and welcome notices
+    CHANNEL_DAMAGE = 4,   // Unused, damage is resolved by the authority
+    CHANNEL_EFFECTS = 5,
+    CHANNEL_INPUT = 6,
+    CHANNEL_SPECTATE = 7,
+    CHANNEL_SNAPSHOT = 8,  // Full state for a joining or resuming client, paced behind live traffic
+    CHANNEL_COUNT = 9,
+};
+
+struct Route {
+    uint8_t channel;
+    DeliveryClass delivery;
+};
+
+constexpr Route routeOf(MessageType type) {
+    switch (type) {
+        case MessageType::POSITION:
+            return {CHANNEL_POSITION, DeliveryClass::LATEST_STATE};
+        case MessageType::BULLETS:
+            return {CHANNEL_BULLETS, DeliveryClass::LATEST_STATE};
+        case MessageType::HEALTH:
+            return {CHANNEL_HEALTH, DeliveryClass::RELIABLE_EVENT};
+        case MessageType::DAMAGE:
+            return {CHANNEL_DAMAGE, DeliveryClass::RELIABLE_EVENT};
+        case MessageType::RESET:
+        case MessageType::PLAYER_LEFT:
+        case MessageType::WELCOME:
+            return {CHANNEL_CONTROL, DeliveryClass::RELIABLE_EVENT};
+        case MessageType::EFFECT:
+            return {CHANNEL_EFFECTS, DeliveryClass::FIRE_AND_FORGET};
+        case MessageType::INPUT:
+            // Every packet repeats the last few commands, so a lost one is covered by the next
+            return {CHANNEL_INPUT, DeliveryClass::LATEST_STATE};
+        case MessageType::SPECTATE:
+            return {CHANNEL_SPECTATE, DeliveryClass::LATEST_STATE};
+        case MessageType::SNAPSHOT:
+            return {CHANNEL_SNAPSHOT, DeliveryClass::RELIABLE_EVENT};
+    }
+    return {CHANNEL_CONTROL, DeliveryClass::RELIABLE_EVENT};
+}
+
+constexpr uint32_t packetFlags(DeliveryClass delivery) {
+    switch (delivery) {
+        case DeliveryClass::LATEST_STATE:
+            // Large state (long bullet lists) is fragmented unreliably too, instead of ENet's reliable default
+            return ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT;
+        case DeliveryClass::RELIABLE_EVENT:
+            return ENET_PACKET_FLAG_RELIABLE;
+        case DeliveryClass::FIRE_AND_FORGET:
+            return ENET_PACKET_FLAG_UNSEQUENCED | ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT;
+    }
+    return ENET_PACKET_FLAG_RELIABLE;
+}
+
+constexpr uint32_t packetFlags(MessageType type) {
+    return packetFlags(routeOf(type).delivery);
+}
+
+// Owner slots: the hosting player is 0, every connected client is its ENet peer index + 1.
+// Bots the match server adds take slots past the highest peer index.
+constexpr uint16_t OWNER_HOST = 0;
+constexpr uint16_t OWNER_BOT_FIRST = ENET_PROTOCOL_MAXIMUM_PEER_ID + 2;
+constexpr uint16_t OWNER_SELF = 0xFFFF;
+
+// Layouts, fields in wire order after the type byte
+using PositionMessage = Schema::Message<MessageType::POSITION, uint16_t /* owner */, float /* x */, float /* y */,
+                                        uint32_t /* newest input tick applied */>;
+constexpr size_t MAX_BULLETS = 1024;  // Per message, far more than one player can have in flight
+using BulletsMessage = Schema::ListMessage<MessageType::BULLETS, Bullet::SERIALIZED_SIZE, MAX_BULLETS, uint16_t /* owner */,
+                                          uint8_t /* shots fired, wrapping */>;
+using HealthMessage = Schema::Message<MessageType::HEALTH, uint16_t /* owner */, int32_t /* health */>;
+using DamageMessage = Schema::Message<MessageType::DAMAGE, int32_t /* damage */>;
+using ResetMessage = Schema::Message<MessageType::RESET>;
+using PlayerLeftMessage = Schema::Message<MessageType::PLAYER_LEFT, uint16_t /* owner */>;
+using WelcomeMessage = Schema::Message<MessageType::WELCOME, uint16_t /* owner slot */, uint32_t /* tick rate */,
+                                       uint32_t /* session, 0 = can't resume */, uint8_t /* protocol version agreed on */>;
+
+// Input: newest command tick, then one button byte per command, newest first. Command i is for
+// tick (newest - i); each packet repeats the last few so a lost one is covered by the next.
+constexpr size_t INPUT_REDUNDANCY = 4;
+using InputMessage = Schema::ListMessage<MessageType::INPUT, sizeof(uint8_t), INPUT_REDUNDANCY, uint32_t /* newest tick */>;
+
+// Spectator frame: the whole match as it was a few seconds ago, one message per tick.
+// Header (tick, player count), then per player a SpectatePlayer record and its bullets.
+constexpr size_t SPECTATE_MAX_SIZE = 1 << 20;
+using SpectateMessage = Schema::ListMessage<MessageType::SPECTATE, sizeof(uint8_t), SPECTATE_MAX_SIZE, uint32_t /* tick */,
+                                            uint16_t /* player count */>;
+using SpectatePlayer = Schema::Record<uint16_t /* owner */, float /* x */, float /* y */, int32_t /* health */,
+                                      uint16_t /* bullet count */>;
+
+// Full-state snapshot sent once to a joining or resuming client (see network/snapshot.hpp). A
+// SnapshotHeader, then per player a SnapshotPlayer record and its bullets. It goes out in chunks
+// that fit one datagram, a few per tick, each a SnapshotMessage with the snapshot's tick and the
+// chunk's index and count in front of its share of the bytes.
+using SnapshotHeader = Schema::Record<uint32_t /* tick */, int32_t /* world width */, int32_t /* world height */,
+                                      uint16_t /* player count */>;
+using SnapshotPlayer = Schema::Record<uint16_t /* owner */, int32_t /* x */, int32_t /* y */, int8_t /* facing x */,
+                                      int8_t /* facing y */, int16_t /* health */, float /* time since the last shot */,
+                                      uint8_t /* weapon type */, uint8_t /* shots fired */, uint32_t /* newest input tick applied */,
+                                      uint16_t /* bullet count */>;
+constexpr size_t SNAPSHOT_CHUNK_PAYLOAD = 1024;  // With ENet's headers still under the default 1400-byte MTU
+constexpr size_t SNAPSHOT_CHUNKS_PER_TICK = 4;
+using SnapshotMessage = Schema::ListMessage<MessageType::SNAPSHOT, sizeof(uint8_t), SNAPSHOT_CHUNK_PAYLOAD, uint32_t /* tick */,
+                                            uint16_t /* chunk index */, uint16_t /* chunk count */>;
+
+// Connect data, low to high: 24 bits of request, PROTOCOL_VERSION, then two flags. The request is
+// the match id + 1 (0 lets the server choose); with CONNECT_SPECTATOR set the client watches that
+// match instead of playing in it. With CONNECT_RESUME set the request is instead the session from
+// an earlier welcome, to take that player back after a dropped connection.
+constexpr uint32_t CONNECT_SPECTATOR = 0x80000000;
+constexpr uint32_t CONNECT_RESUME = 0x40000000;
+constexpr uint32_t REQUEST_MASK = 0x00FFFFFF;
+constexpr uint32_t SESSION_MASK = REQUEST_MASK;
+constexpr uint32_t MAX_MATCH_REQUEST = REQUEST_MASK - 1;  // Highest match id a client can ask for
+constexpr int VERSION_SHIFT = 24;
+constexpr uint32_t VERSION_MASK = 0x3F;
+
+// Disconnect data a server gives a client it refuses for its version, | the version the server speaks
+constexpr uint32_t DISCONNECT_VERSION = 0x56455200;
+
+constexpr uint32_t connectData(uint32_t flags, uint32_t request) {
+    return flags | (static_cast<uint32_t>(PROTOCOL_VERSION) << VERSION_SHIFT) | (request & REQUEST_MASK);
+}
+
+constexpr uint8_t versionOf(uint32_t connectData) {
+    return static_cast<uint8_t>((connectData >> VERSION_SHIFT) & VERSION_MASK);
+}
+
+// Newest version both ends speak, 0 if there is none
+constexpr uint8_t negotiateVersion(uint8_t requested) {
+    uint8_t agreed = requested < PROTOCOL_VERSION ? requested : PROTOCOL_VERSION;
+    return agreed >= MIN_PROTOCOL_VERSION ? agreed : 0;
+}
+
+enum InputButton : uint8_t {
+    BUTTON_UP = 1 << 0,
+    BUTTON_DOWN = 1 << 1,
+    BUTTON_LEFT = 1 << 2,
+    BUTTON_RIGHT = 1 << 3,
+    BUTTON_FIRE = 1 << 4,
+};
+// The top bits carry PlayerInput::select
+constexpr int BUTTON_SELECT_SHIFT = 5;
+constexpr uint8_t BUTTON_SELECT_MASK = 0x3 << BUTTON_SELECT_SHIFT;
+static_assert(PROJECTILE_TYPE_COUNT < 4, "Weapon selection fits two bits");
+
+inline uint8_t encodeButtons(const PlayerInput& input) {
+    uint8_t buttons = 0;
+    if (input.direction.y < 0) buttons |= BUTTON_UP;
+    if (input.direction.y > 0) buttons |= BUTTON_DOWN;
+    if (input.direction.x < 0) buttons |= BUTTON_LEFT;
+    if (input.direction.x > 0) buttons |= BUTTON_RIGHT;
+    if (input.fire) buttons |= BUTTON_FIRE;
+    buttons |= (input.select << BUTTON_SELECT_SHIFT) & BUTTON_SELECT_MASK;
+    return buttons;
+}
+
+inline PlayerInput decodeButtons(uint8_t buttons) {
+    PlayerInput input = {{0, 0}, (buttons & BUTTON_FIRE) != 0, static_cast<uint8_t>((buttons & BUTTON_SELECT_MASK) >> BUTTON_SELECT_SHIFT)};
+    if (buttons & BUTTON_UP) input.direction.y = -1;
+    if (buttons & BUTTON_DOWN) input.direction.y = 1;
+    if (buttons & BUTTON_LEFT) input.direction.x = -1;
+    if (buttons & BUTTON_RIGHT) input.direction.x = 1;
+    return input;
+}
+
+inline uint16_t ownerForPeer(uint16_t peerIndex) {
+    return static_cast<uint16_t>(peerIndex + 1);
+}
+
+inline bool isBotOwner(uint16_t owner) {
+    return owner >= OWNER_BOT_FIRST && owner != OWNER_SELF;
+}
+
+// Owner slot of a position, bullets or health message; all three carry it first
+static_assert(PositionMessage::offsetOf<0>() == BulletsMessage::offsetOf<0>() &&
+                  PositionMessage::offsetOf<0>() == HealthMessage::offsetOf<0>(),
+              "Player state starts with the owner");
+inline uint16_t readOwner(const uint8_t* data) {
+    return PositionMessage::get<0>(data);
+}
+
+// Works out what arrived from its type byte, and checks it came on its own channel with its
+// layout's size; false for anything malformed
+inline bool identify(uint8_t channel, const uint8_t* data, size_t length, MessageType& type) {
+    if (length < Schema::HEADER_SIZE || data[0] >= MESSAGE_TYPE_COUNT) return false;
+    type = static_cast<MessageType>(data[0]);
+    if (routeOf(type).channel != channel) return false;
+
+    switch (type) {
+        case MessageType::POSITION:
+            return PositionMessage::fits(length);
+        case MessageType::BULLETS:
+            return BulletsMessage::fits(length);
+        case MessageType::HEALTH:
+            return HealthMessage::fits(length);
+        case MessageType::DAMAGE:
+            return DamageMessage::fits(length);
+        case MessageType::RESET:
+            return ResetMessage::fits(length);
+        case MessageType::PLAYER_LEFT:
+            return PlayerLeftMessage::fits(length);
+        case MessageType::EFFECT:
+            return false;  // Nothing sends effects: each machine makes its own
+        case MessageType::INPUT:
+            return InputMessage::fits(length) && InputMessage::countOf(length) > 0;
+        case MessageType::WELCOME:
+            return WelcomeMessage::fits(length);
+        case MessageType::SPECTATE:
+            return SpectateMessage::fits(length);
+        case MessageType::SNAPSHOT:
+            return SnapshotMessage::fits(length) && SnapshotMessage::countOf(length) > 0;
+    }
+    return false;
+}
+
+// Per-player state the authority sends down; clients never send these
+inline bool isPlayerState(MessageType type) {
+    return type == MessageType::POSITION || type == MessageType::BULLETS || type == MessageType::HEALTH;
+}
+}  // namespace Protocol
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef SCHEMA_HPP
+#define SCHEMA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+// Declarative wire layouts. A layout is a list of field types in wire order; everything about it,
+// sizes and every field's offset, is a constant, so writing and reading come down to the same
+// fixed-offset memcpys a hand-written encoder would do. Fields are plain trivially copyable values
+// in host byte order, like the rest of the protocol.
+//
+//   Record<Fields...>                        a fixed run of fields with no header, for records inside a message
+//   Message<TYPE, Fields...>                 one byte of message type, then the fields
+//   ListMessage<TYPE, ELEMENT_SIZE, MAX, Fields...>
+//                                            a Message followed by up to MAX elements of ELEMENT_SIZE bytes,
+//                                            counted by the length
+namespace Schema {
+// Bytes in front of every message
+constexpr size_t HEADER_SIZE = sizeof(uint8_t);
+
+template <typename... Fields>
+struct Record {
+    static_assert((std::is_trivially_copyable<Fields>::value && ...), "Fields are copied byte for byte");
+
+    static constexpr size_t SIZE = (size_t{0} + ... + sizeof(Fields));
+
+    template <size_t I>
+    using FieldType = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+    template <size_t I>
+    static constexpr size_t offsetOf() {
+        constexpr size_t sizes[] = {sizeof(Fields)...};
+        size_t offset = 0;
+        for (size_t i = 0; i < I; ++i) offset += sizes[i];
+        return offset;
+    }
+
+    static void write(uint8_t* out, const Fields&... values) {
+        size_t offset = 0;
+        ((std::memcpy(out + offset, &values, sizeof(Fields)), offset += sizeof(Fields)), ...);
+    }
+
+    // The caller has checked that SIZE bytes are there
+    static void read(const uint8_t* data, Fields&... values) {
+        size_t offset = 0;
+        ((std::memcpy(&values, data + offset, sizeof(Fields)), offset += sizeof(Fields)), ...);
+    }
+
+    template <size_t I>
+    static FieldType<I> get(const uint8_t* data) {
+        FieldType<I> value;
+        std::memcpy(&value, data + offsetOf<I>(), sizeof(value));
+        return value;
+    }
+
+    template <size_t I>
+    static void set(uint8_t* data, const FieldType<I>& value) {
+        std::memcpy(data + offsetOf<I>(), &value, sizeof(value));
+    }
+};
+
+template <auto TYPE, typename... Fields>
+struct Message {
+    using Body = Record<Fields...>;
+
+    static constexpr uint8_t TYPE_ID = static_cast<uint8_t>(TYPE);
+    static constexpr size_t SIZE = HEADER_SIZE + Body::SIZE;  // Of the fixed part, which is all of it here
+    static constexpr size_t MIN_SIZE = SIZE;
+    static constexpr size_t MAX_SIZE = SIZE;
+
+    template <size_t I>
+    using FieldType = typename Body::template FieldType<I>;
+
+    template <size_t I>
+    static constexpr size_t offsetOf() {
+        return HEADER_SIZE + Body::template offsetOf<I>();
+    }
+
+    static bool fits(size_t length) { return length == SIZE; }
+
+    static void write(uint8_t* out, const Fields&... values) {
+        out[0] = TYPE_ID;
+        Body::write(out + HEADER_SIZE, values...);
+    }
+
+    // False unless data holds this message, whole
+    static bool read(const uint8_t* data, size_t length, Fields&... values) {
+        if (length < HEADER_SIZE || data[0] != TYPE_ID || !fits(length)) return false;
+        Body::read(data + HEADER_SIZE, values...);
+        return true;
+    }
+
+    template <size_t I>
+    static FieldType<I> get(const uint8_t* data) {
+        return Body::template get<I>(data + HEADER_SIZE);
+    }
+
+    template <size_t I>
+    static void set(uint8_t* data, const FieldType<I>& value) {
+        Body::template set<I>(data + HEADER_SIZE, value);
+    }
+};
+
+template <auto TYPE, size_t ELEMENT_SIZE, size_t MAX_ELEMENTS, typename... Fields>
+struct ListMessage : Message<TYPE, Fields...> {
+    static_assert(ELEMENT_SIZE > 0, "Elements need a size");
+
+    using Fixed = Message<TYPE, Fields...>;
+    static constexpr size_t MIN_SIZE = Fixed::SIZE;
+    static constexpr size_t MAX_SIZE = Fixed::SIZE + ELEMENT_SIZE * MAX_ELEMENTS;
+    static constexpr size_t MAX_COUNT = MAX_ELEMENTS;
+
+    static constexpr size_t sizeFor(size_t count) { return Fixed::SIZE + ELEMENT_SIZE * count; }
+    static constexpr size_t countOf(size_t length) { return (length - Fixed::SIZE) / ELEMENT_SIZE; }
+    static bool fits(size_t length) {
+        return length >= MIN_SIZE && length <= MAX_SIZE && (length - Fixed::SIZE) % ELEMENT_SIZE == 0;
+    }
+
+    static uint8_t* element(uint8_t* data, size_t index) { return data + Fixed::SIZE + index * ELEMENT_SIZE; }
+    static const uint8_t* element(const uint8_t* data, size_t index) { return data + Fixed::SIZE + index * ELEMENT_SIZE; }
+
+    // The fixed part of a list message; count is how many elements follow, read from the length
+    static bool read(const uint8_t* data, size_t length, Fields&... values, size_t& count) {
+        if (length < HEADER_SIZE || data[0] != Fixed::TYPE_ID || !fits(length)) return false;
+        Fixed::Body::read(data + HEADER_SIZE, values...);
+        count = countOf(length);
+        return true;
+    }
+};
+
+// Checks a received message's type byte and length against a layout, without reading it
+template <typename Layout>
+bool matches(const uint8_t* data, size_t length) {
+    return length >= HEADER_SIZE && data[0] == Layout::TYPE_ID && Layout::fits(length);
+}
+}  // namespace Schema
+
+#endif
@@ -0,0 +1,455 @@
+#include "network/server/match_server.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "core/job_system.hpp"
+#include "core/tick_watchdog.hpp"
+#include "network/compression.hpp"
+#include "network/packet_pool.hpp"
+
+MatchServerConfig::MatchServerConfig() {
+    network.peerCapacity = 512;
+}
+
+bool MatchServerConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "matches") {
+        return ConfigOptions::parseField(key, value, 1000000, matchCount, error);
+    } else if (key == "players-per-match") {
+        return ConfigOptions::parseField(key, value, ENET_PROTOCOL_MAXIMUM_PEER_ID, playersPerMatch, error);
+    } else if (key == "shards") {
+        return ConfigOptions::parseField(key, value, 1024, shardCount, error);
+    } else if (key == "workers") {
+        return ConfigOptions::parseField(key, value, 256, workersPerShard, error);
+    } else if (key == "tick-rate") {
+        return ConfigOptions::parseField(key, value, 1000, tickRate, error);
+    } else if (key == "bots") {
+        return ConfigOptions::parseField(key, value, ENET_PROTOCOL_MAXIMUM_PEER_ID, botFill, error);
+    } else if (key == "spectators") {
+        return ConfigOptions::parseField(key, value, ENET_PROTOCOL_MAXIMUM_PEER_ID, spectatorsPerMatch, error);
+    } else if (key == "spectator-delay") {
+        return ConfigOptions::parseField(key, value, 60000, spectatorDelayMs, error);
+    } else if (key == "resume-window") {
+        return ConfigOptions::parseField(key, value, 600000, resumeWindowMs, error);
+    } else if (key == "client-budget") {
+        return ConfigOptions::parseField(key, value, 1u << 20, clientBudget, error);
+    } else {
+        return network.set(key, value, error);
+    }
+    return true;
+}
+
+MatchServer::MatchServer(const MatchServerConfig& cfg)
+    : config(cfg),
+      host(nullptr),
+      running(false),
+      navigation(map, Match::PLAYER_RADIUS),
+      fillCursor(0),
+      sessionRandom(std::random_device{}()) {
+    if (config.shardCount == 0) {
+        config.shardCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    if (config.tickRate <= 0) {
+        config.tickRate = 60;
+    }
+}
+
+MatchServer::~MatchServer() {
+    stop();
+    for (auto& shard : shards) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+    if (host) {
+        enet_host_destroy(host);
+        enet_deinitialize();
+    }
+}
+
+bool MatchServer::start() {
+    std::string error;
+    if (!config.network.validate(error)) {
+        std::cerr << "Invalid network config: " << error << std::endl;
+        return false;
+    }
+
+    if (PacketPool::initialize() != 0) {
+        std::cerr << "Failed to initialize ENet." << std::endl;
+        return false;
+    }
+
+    ENetAddress address;
+    if (!config.network.resolveBindAddress(address)) {
+        std::cerr << "Cannot resolve bind address " << config.network.bindAddress << std::endl;
+        enet_deinitialize();
+        return false;
+    }
+
+    const NetworkConfig& network = config.network;
+    host = enet_host_create(&address, network.peerCapacity, network.channelCount, network.hostIncomingBandwidth(),
+                            network.hostOutgoingBandwidth());
+    if (!host) {
+        std::cerr << "Failed to create ENet server." << std::endl;
+        enet_deinitialize();
+        return false;
+    }
+    if (!Compression::install(host, network)) {
+        enet_host_destroy(host);
+        host = nullptr;
+        enet_deinitialize();
+        return false;
+    }
+
+    peerMatch.assign(host->peerCount, NO_MATCH);
+    peerSpectating.assign(host->peerCount, 0);
+    matchPlayers.assign(config.matchCount, 0);
+    matchSpectators.assign(config.matchCount, 0);
+    peerSession.assign(host->peerCount, 0);
+    uint32_t spectatorDelayTicks = static_cast<uint32_t>(static_cast<uint64_t>(config.spectatorDelayMs) * config.tickRate / 1000);
+    uint32_t resumeWindowTicks = static_cast<uint32_t>(static_cast<uint64_t>(config.resumeWindowMs) * config.tickRate / 1000);
+    // Without a budget of its own, a match keeps within the outgoing cap ENet throttles each peer to
+    size_t clientBudget = config.clientBudget;
+    if (clientBudget == 0 && config.network.peerOutgoingBandwidth > 0) {
+        clientBudget = std::max<size_t>(1, config.network.peerOutgoingBandwidth / static_cast<uint32_t>(config.tickRate));
+    }
+    for (uint32_t id = 0; id < config.matchCount; ++id) {
+        matches.push_back(std::make_unique<Match>(id, map, navigation, static_cast<uint32_t>(config.tickRate)));
+        matches.back()->setBotFill(config.botFill);
+        matches.back()->setSpectatorDelay(spectatorDelayTicks);
+        matches.back()->setResumeWindow(resumeWindowTicks);
+        matches.back()->setClientBudget(clientBudget);
+    }
+
+    running = true;
+    for (size_t i = 0; i < config.shardCount; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+        shards.back()->index = i;
+    }
+    for (auto& match : matches) {
+        shards[match->getId() % shards.size()]->matches.push_back(match.get());
+    }
+    for (auto& shard : shards) {
+        shard->thread = std::thread(&MatchServer::shardLoop, this, std::ref(*shard));
+        pinToCore(shard->thread, shard->index);
+    }
+
+    std::cout << "Server started on port " << config.network.port << " with " << config.matchCount << " matches on " << shards.size()
+              << " shards." << std::endl;
+    return true;
+}
+
+void MatchServer::stop() {
+    running = false;
+}
+
+void MatchServer::pinToCore(std::thread& thread, size_t core) {
+#ifdef __linux__
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores == 0) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    // Left to the OS scheduler on other platforms
+    (void)thread;
+    (void)core;
+#endif
+}
+
+void MatchServer::run() {
+    while (running) {
+        ENetEvent event;
+        // Short timeout keeps outbound latency low without spinning
+        int result = enet_host_service(host, &event, 1);
+        while (result > 0) {
+            switch (event.type) {
+                case ENET_EVENT_TYPE_CONNECT: {
+                    // Connect data carries the protocol version and the requested match id + 1, 0 lets the server choose
+                    uint8_t version = Protocol::negotiateVersion(Protocol::versionOf(event.data));
+                    uint32_t requested = event.data & Protocol::REQUEST_MASK;
+                    uint32_t match = requested == 0 ? NO_MATCH : requested - 1;
+                    if (version == 0) {
+                        std::cout << "Client speaks protocol version " << int(Protocol::versionOf(event.data)) << ", rejecting it."
+                                  << std::endl;
+                        enet_peer_disconnect(event.peer, Protocol::DISCONNECT_VERSION | Protocol::PROTOCOL_VERSION);
+                    } else if (event.data & Protocol::CONNECT_SPECTATOR) {
+                        onSpectatorConnect(event.peer, match);
+                    } else if (event.data & Protocol::CONNECT_RESUME) {
+                        onResume(event.peer, event.data & Protocol::SESSION_MASK, version);
+                    } else {
+                        onConnect(event.peer, match, version);
+                    }
+                    break;
+                }
+                case ENET_EVENT_TYPE_DISCONNECT:
+                    onDisconnect(event.peer);
+                    break;
+                case ENET_EVENT_TYPE_RECEIVE:
+                    onReceive(event.peer, event.channelID, event.packet);
+                    break;
+                default:
+                    break;
+            }
+            result = enet_host_check_events(host, &event);
+        }
+
+        sendOutbound();
+    }
+}
+
+uint32_t MatchServer::findOpenMatch() {
+    // Fill matches in order; the cursor only moves back when a player leaves an earlier match
+    while (fillCursor < matches.size() && matchPlayers[fillCursor] >= config.playersPerMatch) {
+        fillCursor++;
+    }
+    return fillCursor < matches.size() ? fillCursor : NO_MATCH;
+}
+
+void MatchServer::onConnect(ENetPeer* peer, uint32_t requestedMatch, uint8_t version) {
+    uint32_t match = requestedMatch;
+    if (match >= matches.size() || matchPlayers[match] >= config.playersPerMatch) {
+        match = findOpenMatch();
+    }
+    if (match == NO_MATCH) {
+        std::cout << "Server full, rejecting client." << std::endl;
+        enet_peer_disconnect(peer, 0);
+        return;
+    }
+
+    peerMatch[peer->incomingPeerID] = match;
+    peerSession[peer->incomingPeerID] = openSession(match, peer->incomingPeerID);
+    matchPlayers[match]++;
+
+    Inbound inbound{Inbound::Kind::JOIN, match, peer->incomingPeerID, 0, {}, peerSession[peer->incomingPeerID], version};
+    post(match, std::move(inbound));
+}
+
+void MatchServer::onResume(ENetPeer* peer, uint32_t session, uint8_t version) {
+    auto found = sessions.find(session);
+    if (found == sessions.end() || found->second.peer != NO_PEER || found->second.expires < Clock::now()) {
+        onConnect(peer, NO_MATCH, version);
+        return;
+    }
+
+    // Back into the match it left, even if that match has filled up since: the player never left it
+    uint32_t match = found->second.match;
+    found->second.peer = peer->incomingPeerID;
+    peerMatch[peer->incomingPeerID] = match;
+    peerSession[peer->incomingPeerID] = session;
+    matchPlayers[match]++;
+
+    Inbound inbound{Inbound::Kind::JOIN, match, peer->incomingPeerID, 0, {}, session, version};
+    post(match, std::move(inbound));
+}
+
+uint32_t MatchServer::openSession(uint32_t match, uint16_t peer) {
+    if (config.resumeWindowMs == 0) {
+        return 0;
+    }
+
+    // Random rather than counted, so one client can't guess another's
+    uint32_t session;
+    do {
+        session = sessionRandom() & Protocol::SESSION_MASK;
+    } while (session == 0 || sessions.count(session) > 0);
+    sessions[session] = Session{match, peer, Clock::time_point()};
+    return session;
+}
+
+void MatchServer::pruneSessions(Clock::time_point now) {
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (it->second.peer == NO_PEER && it->second.expires < now) {
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MatchServer::onSpectatorConnect(ENetPeer* peer, uint32_t requestedMatch) {
+    // Without a request, watch the busiest match
+    uint32_t match = requestedMatch;
+    if (match >= matches.size()) {
+        match = 0;
+        for (uint32_t id = 1; id < matches.size(); ++id) {
+            if (matchPlayers[id] > matchPlayers[match]) match = id;
+        }
+    }
+    if (match >= matches.size() || matchSpectators[match] >= config.spectatorsPerMatch) {
+        std::cout << "No room for spectators, rejecting client." << std::endl;
+        enet_peer_disconnect(peer, 0);
+        return;
+    }
+
+    peerMatch[peer->incomingPeerID] = match;
+    peerSpectating[peer->incomingPeerID] = 1;
+    matchSpectators[match]++;
+
+    Inbound inbound{Inbound::Kind::WATCH, match, peer->incomingPeerID, 0, {}};
+    post(match, std::move(inbound));
+}
+
+void MatchServer::onDisconnect(ENetPeer* peer) {
+    uint32_t match = peerMatch[peer->incomingPeerID];
+    if (match == NO_MATCH) {
+        return;
+    }
+
+    peerMatch[peer->incomingPeerID] = NO_MATCH;
+    if (peerSpectating[peer->incomingPeerID]) {
+        peerSpectating[peer->incomingPeerID] = 0;
+        matchSpectators[match]--;
+        Inbound inbound{Inbound::Kind::UNWATCH, match, peer->incomingPeerID, 0, {}};
+        post(match, std::move(inbound));
+        return;
+    }
+
+    matchPlayers[match]--;
+    if (match < fillCursor) {
+        fillCursor = match;
+    }
+
+    // The session outlives the connection for the resume window
+    Clock::time_point now = Clock::now();
+    auto session = sessions.find(peerSession[peer->incomingPeerID]);
+    if (session != sessions.end()) {
+        session->second.peer = NO_PEER;
+        session->second.expires = now + std::chrono::milliseconds(config.resumeWindowMs);
+    }
+    peerSession[peer->incomingPeerID] = 0;
+    pruneSessions(now);
+
+    Inbound inbound{Inbound::Kind::LEAVE, match, peer->incomingPeerID, 0, {}};
+    post(match, std::move(inbound));
+}
+
+void MatchServer::onReceive(ENetPeer* peer, uint8_t channel, ENetPacket* packet) {
+    uint32_t match = peerMatch[peer->incomingPeerID];
+    if (match != NO_MATCH && !peerSpectating[peer->incomingPeerID]) {
+        Inbound inbound{Inbound::Kind::DATA, match, peer->incomingPeerID, channel,
+                        std::vector<uint8_t>(packet->data, packet->data + packet->dataLength)};
+        post(match, std::move(inbound));
+    }
+    enet_packet_destroy(packet);
+}
+
+void MatchServer::post(uint32_t match, Inbound inbound) {
+    Shard& shard = *shards[match % shards.size()];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.inbound.push_back(std::move(inbound));
+}
+
+void MatchServer::sendOutbound() {
+    for (auto& shard : shards) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            sending.swap(shard->outbound);
+        }
+
+        for (const OutboundMessage& message : sending) {
+            if (message.recipients.empty()) continue;
+
+            // One packet shared by every recipient; ENet frees it after the last send. A spectator
+            // frame goes to every spectator of its match this way, so each one costs a send, not an encode.
+            ENetPacket* packet = enet_packet_create(message.payload.data(), message.payload.size(), message.flags);
+            bool queued = false;
+            for (uint16_t recipient : message.recipients) {
+                if (recipient < host->peerCount && enet_peer_send(&host->peers[recipient], message.channel, packet) == 0) {
+                    queued = true;
+                }
+            }
+            if (!queued) {
+                enet_packet_destroy(packet);
+            }
+        }
+        sending.clear();
+    }
+
+    enet_host_flush(host);
+}
+
+void MatchServer::shardLoop(Shard& shard) {
+    const auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.tickRate));
+    const float dt = 1.0f / config.tickRate;
+
+    // Parallelism mostly comes from running many matches side by side, so by default each match
+    // ticks inline; with a few big matches the shard's workers split up each tick instead
+    JobSystem jobs(config.workersPerShard);
+    std::vector<Inbound> inbound;
+    std::vector<OutboundMessage> outbound;
+    TickWatchdog watchdog("Shard " + std::to_string(shard.index), tickLength);
+    auto nextTick = Clock::now();
+
+    while (running) {
+        auto tickStart = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            inbound.swap(shard.inbound);
+        }
+
+        for (Inbound& message : inbound) {
+            Match& match = *matches[message.match];
+            switch (message.kind) {
+                case Inbound::Kind::JOIN:
+                    match.join(message.peer, message.session, message.version);
+                    break;
+                case Inbound::Kind::LEAVE:
+                    match.leave(message.peer);
+                    break;
+                case Inbound::Kind::WATCH:
+                    match.watch(message.peer);
+                    break;
+                case Inbound::Kind::UNWATCH:
+                    match.unwatch(message.peer);
+                    break;
+                case Inbound::Kind::DATA:
+                    match.receive(message.peer, message.channel, message.payload.data(), message.payload.size());
+                    break;
+            }
+        }
+        inbound.clear();
+
+        for (Match* match : shard.matches) {
+            // Idle matches cost nothing but this check. One holding a suspended player keeps ticking,
+            // so the player still expires on time when nobody else is there.
+            if (match->getPlayerCount() == 0 && match->getSuspendedCount() == 0 && match->getOutbox().empty()) continue;
+
+            match->tick(jobs, dt);
+            std::vector<OutboundMessage>& outbox = match->getOutbox();
+            for (OutboundMessage& message : outbox) {
+                outbound.push_back(std::move(message));
+            }
+            outbox.clear();
+        }
+
+        if (!outbound.empty()) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (OutboundMessage& message : outbound) {
+                shard.outbound.push_back(std::move(message));
+            }
+        }
+        outbound.clear();
+
+        // Sustained overruns shed load in steps across the whole shard, and it comes back once they stop
+        auto now = Clock::now();
+        if (watchdog.record(now - tickStart)) {
+            for (Match* match : shard.matches) {
+                match->setLoadLevel(watchdog.getLevel());
+            }
+        }
+
+        nextTick += tickLength;
+        if (nextTick < now) {
+            nextTick = now;  // Overran: don't try to catch up with a burst of ticks
+        }
+        std::this_thread::sleep_until(nextTick);
+    }
+}
@@ -0,0 +1,146 @@
+#ifndef MATCH_SERVER_HPP
+#define MATCH_SERVER_HPP
+
+#include <enet/enet.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/map.hpp"
+#include "core/match.hpp"
+#include "core/navigation.hpp"
+#include "network/network_config.hpp"
+#include "network/protocol.hpp"
+
+// Server options on top of NetworkConfig:
+//   matches=N  players-per-match=N  shards=N (0 = one per hardware thread)  tick-rate=HZ
+//   workers=N (threads per shard helping each match's tick along, for a few big matches; 0 = ticks run inline)
+//   bots=N (fill every occupied match up to N players with bots, 0 = none)
+//   spectators=N (per match, 0 = none)  spectator-delay=MS (how far behind the live match spectators are)
+//   resume-window=MS (how long a dropped player waits in its match to be resumed, 0 = not at all)
+//   client-budget=BYTES (player state sent to each member per tick, 0 = bandwidth-out / tick-rate, or unlimited without it)
+struct MatchServerConfig {
+    MatchServerConfig();
+
+    NetworkConfig network;
+    size_t matchCount = 64;
+    size_t playersPerMatch = 8;
+    size_t shardCount = 0;
+    size_t workersPerShard = 0;
+    int tickRate = 60;
+    size_t botFill = 0;
+    size_t spectatorsPerMatch = 256;
+    uint32_t spectatorDelayMs = 3000;
+    uint32_t resumeWindowMs = 10000;
+    size_t clientBudget = 0;
+
+    bool set(const std::string& key, const std::string& value, std::string& error);
+};
+
+// Hosts many independent matches in one process.
+//
+// The thread calling run() owns the only ENet host (one listening socket). It assigns each new
+// connection to a match, forwards its traffic to that match's shard and sends whatever the
+// matches produce. Matches are split across shard threads by id, each shard pinned to one core
+// and ticking its matches at a fixed rate; shards never touch ENet. A watchdog per shard times
+// every tick against the tick length and sheds load from all the shard's matches in steps while
+// it keeps overrunning (see TickWatchdog), restoring them once it has recovered.
+//
+// A connection whose connect data names no protocol version this server speaks is disconnected
+// with Protocol::DISCONNECT_VERSION before it joins anything (see Protocol::negotiateVersion).
+//
+// A connection whose connect data has Protocol::CONNECT_SPECTATOR set watches a match instead of
+// joining it (see Match::watch); anything a spectator sends is dropped.
+//
+// Every player gets a session in its welcome. Connecting again with Protocol::CONNECT_RESUME and
+// that session within the resume window puts the new connection back in the same match, where
+// Match::join hands it its old player; a session that is unknown, still connected or too old
+// joins like a new player instead.
+class MatchServer {
+   public:
+    explicit MatchServer(const MatchServerConfig& config);
+    ~MatchServer();
+
+    bool start();
+    void run();  // Network loop, returns after stop()
+    void stop();
+
+   private:
+    static constexpr uint32_t NO_MATCH = 0xFFFFFFFF;
+    static constexpr uint16_t NO_PEER = 0xFFFF;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Inbound {
+        enum class Kind { JOIN, LEAVE, WATCH, UNWATCH, DATA };
+
+        Kind kind;
+        uint32_t match;
+        uint16_t peer;
+        uint8_t channel;
+        std::vector<uint8_t> payload;
+        uint32_t session = 0;  // JOIN only
+        uint8_t version = 0;   // JOIN only, the protocol version agreed on
+    };
+
+    struct Session {
+        uint32_t match;
+        uint16_t peer;              // NO_PEER while disconnected
+        Clock::time_point expires;  // Once disconnected
+    };
+
+    struct Shard {
+        size_t index;
+        std::thread thread;
+        std::vector<Match*> matches;
+
+        // Exchanged with the network thread under the mutex by swapping whole vectors
+        std::mutex mutex;
+        std::vector<Inbound> inbound;
+        std::vector<OutboundMessage> outbound;
+    };
+
+    void shardLoop(Shard& shard);
+    static void pinToCore(std::thread& thread, size_t core);
+
+    void onConnect(ENetPeer* peer, uint32_t requestedMatch, uint8_t version);
+    void onResume(ENetPeer* peer, uint32_t session, uint8_t version);
+    void onSpectatorConnect(ENetPeer* peer, uint32_t requestedMatch);
+    void onDisconnect(ENetPeer* peer);
+    void onReceive(ENetPeer* peer, uint8_t channel, ENetPacket* packet);
+    void post(uint32_t match, Inbound inbound);
+    void sendOutbound();
+    uint32_t findOpenMatch();
+    uint32_t openSession(uint32_t match, uint16_t peer);
+    void pruneSessions(Clock::time_point now);
+
+    MatchServerConfig config;
+    ENetHost* host;
+    std::atomic<bool> running;
+
+    Map map;                    // Immutable and shared by every match
+    NavigationGrid navigation;  // The map's, for every match's bots
+    std::vector<std::unique_ptr<Match>> matches;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // Network-thread bookkeeping for routing
+    std::vector<uint32_t> peerMatch;       // Peer index -> match id
+    std::vector<uint8_t> peerSpectating;   // Peer index -> watching rather than playing
+    std::vector<size_t> matchPlayers;      // Match id -> connected players
+    std::vector<size_t> matchSpectators;   // Match id -> connected spectators
+    uint32_t fillCursor;                   // Matches before this one are full
+    std::vector<uint32_t> peerSession;     // Peer index -> session, 0 for none
+    std::unordered_map<uint32_t, Session> sessions;
+    std::mt19937 sessionRandom;
+    std::vector<OutboundMessage> sending;  // Reused between sendOutbound() calls
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "network/server/relay.hpp"
+
+#include <iostream>
+
+#include "network/compression.hpp"
+#include "network/packet_pool.hpp"
+#include "network/protocol.hpp"
+
+bool RelayConfig::set(const std::string& key, const std::string& value, std::string& error) {
+    if (key == "listen") {
+        return ConfigOptions::parseField(key, value, 65535, listenPort, error);
+    } else if (key == "match") {
+        uint32_t request = 0;
+        if (!ConfigOptions::parseField(key, value, Protocol::MAX_MATCH_REQUEST, request, error)) return false;
+        match = request + 1;
+    } else {
+        return network.set(key, value, error);
+    }
+    return true;
+}
+
+SpectatorRelay::SpectatorRelay(const RelayConfig& cfg)
+    : config(cfg), serverAddress{}, upstream(nullptr), downstream(nullptr), source(nullptr), lastConnectAttempt(0), running(false) {
+    if (config.listenPort == 0) {
+        config.listenPort = static_cast<uint16_t>(config.network.port + 1);
+    }
+}
+
+SpectatorRelay::~SpectatorRelay() {
+    stop();
+    if (upstream) enet_host_destroy(upstream);
+    if (downstream) enet_host_destroy(downstream);
+    if (upstream || downstream) enet_deinitialize();
+}
+
+bool SpectatorRelay::start() {
+    std::string error;
+    if (!config.network.validate(error)) {
+        std::cerr << "Invalid network config: " << error << std::endl;
+        return false;
+    }
+
+    if (PacketPool::initialize() != 0) {
+        std::cerr << "Failed to initialize ENet." << std::endl;
+        return false;
+    }
+
+    const NetworkConfig& network = config.network;
+    ENetAddress listenAddress;
+    if (!network.resolveBindAddress(listenAddress) || !network.resolveServerAddress(serverAddress)) {
+        std::cerr << "Cannot resolve " << network.bindAddress << " or " << network.serverAddress << std::endl;
+        enet_deinitialize();
+        return false;
+    }
+    listenAddress.port = config.listenPort;
+
+    upstream = enet_host_create(nullptr, 1, network.channelCount, network.peerIncomingBandwidth, network.peerOutgoingBandwidth);
+    downstream = enet_host_create(&listenAddress, network.peerCapacity, network.channelCount, network.hostIncomingBandwidth(),
+                                  network.hostOutgoingBandwidth());
+    if (!upstream || !downstream || !Compression::install(upstream, network) || !Compression::install(downstream, network)) {
+        std::cerr << "Failed to create ENet relay." << std::endl;
+        if (upstream) enet_host_destroy(upstream);
+        if (downstream) enet_host_destroy(downstream);
+        upstream = nullptr;
+        downstream = nullptr;
+        enet_deinitialize();
+        return false;
+    }
+    spectators.reserve(network.peerCapacity);
+
+    std::cout << "Relaying " << network.serverAddress << ":" << network.port << " to spectators on port " << config.listenPort << std::endl;
+    running = true;
+    connectUpstream();
+    return true;
+}
+
+void SpectatorRelay::stop() {
+    running = false;
+}
+
+void SpectatorRelay::connectUpstream() {
+    lastConnectAttempt = enet_time_get();
+    uint32_t data = Protocol::connectData(Protocol::CONNECT_SPECTATOR, config.match);
+    source = enet_host_connect(upstream, &serverAddress, config.network.channelCount, data);
+}
+
+void SpectatorRelay::run() {
+    while (running) {
+        serviceUpstream();
+        serviceDownstream();
+        enet_host_flush(downstream);
+
+        if (!source && enet_time_get() - lastConnectAttempt >= RECONNECT_MS) {
+            connectUpstream();
+        }
+    }
+}
+
+void SpectatorRelay::serviceUpstream() {
+    // Frames arrive at the match's tick rate, so waiting here paces the loop without spinning
+    ENetEvent event;
+    int result = enet_host_service(upstream, &event, 1);
+    while (result > 0) {
+        switch (event.type) {
+            case ENET_EVENT_TYPE_CONNECT:
+                std::cout << "Watching " << config.network.serverAddress << ":" << config.network.port << std::endl;
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT:
+                if ((event.data & ~Protocol::VERSION_MASK) == Protocol::DISCONNECT_VERSION) {
+                    std::cerr << "The server speaks protocol version " << (event.data & Protocol::VERSION_MASK) << ", this build "
+                              << int(Protocol::PROTOCOL_VERSION) << std::endl;
+                }
+                // Spectators stay connected and the stream resumes once the server is back
+                std::cout << "Lost the server, reconnecting..." << std::endl;
+                source = nullptr;
+                break;
+            case ENET_EVENT_TYPE_RECEIVE:
+                if (event.channelID == Protocol::CHANNEL_SPECTATE) {
+                    forward(event.packet);
+                } else {
+                    enet_packet_destroy(event.packet);
+                }
+                break;
+            default:
+                break;
+        }
+        result = enet_host_check_events(upstream, &event);
+    }
+}
+
+void SpectatorRelay::serviceDownstream() {
+    ENetEvent event;
+    while (enet_host_service(downstream, &event, 0) > 0) {
+        switch (event.type) {
+            case ENET_EVENT_TYPE_CONNECT:
+                // Frames are forwarded as they are, so a spectator has to speak the server's version exactly
+                if (Protocol::versionOf(event.data) != Protocol::PROTOCOL_VERSION) {
+                    enet_peer_disconnect(event.peer, Protocol::DISCONNECT_VERSION | Protocol::PROTOCOL_VERSION);
+                    break;
+                }
+                spectators.push_back(event.peer);
+                event.peer->data = reinterpret_cast<void*>(static_cast<uintptr_t>(spectators.size()));
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT: {
+                size_t slot = static_cast<size_t>(reinterpret_cast<uintptr_t>(event.peer->data));
+                if (slot == 0 || slot > spectators.size()) break;
+
+                // Swap the last spectator into the hole
+                ENetPeer* last = spectators.back();
+                spectators[slot - 1] = last;
+                last->data = reinterpret_cast<void*>(static_cast<uintptr_t>(slot));
+                spectators.pop_back();
+                event.peer->data = nullptr;
+                break;
+            }
+            case ENET_EVENT_TYPE_RECEIVE:
+                // Spectators have nothing to say
+                enet_packet_destroy(event.packet);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void SpectatorRelay::forward(ENetPacket* packet) {
+    // The received packet itself goes out again: ENet counts its references and frees it after
+    // the last spectator's send. Its flags describe how it arrived, so restore the frame's delivery class.
+    packet->flags = Protocol::packetFlags(Protocol::MessageType::SPECTATE);
+    bool queued = false;
+    for (ENetPeer* spectator : spectators) {
+        if (enet_peer_send(spectator, Protocol::CHANNEL_SPECTATE, packet) == 0) {
+            queued = true;
+        }
+    }
+    if (!queued) {
+        enet_packet_destroy(packet);
+    }
+}
+
+void runRelay(const RelayConfig& config) {
+    SpectatorRelay relay(config);
+    if (!relay.start()) {
+        std::cerr << "Failed to start relay." << std::endl;
+        return;
+    }
+
+    relay.run();
+}
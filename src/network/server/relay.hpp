@@ -0,0 +1,60 @@
+#ifndef RELAY_HPP
+#define RELAY_HPP
+
+#include <enet/enet.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "network/network_config.hpp"
+
+// Relay options on top of NetworkConfig's server/port (the match server or relay to watch) and peers:
+//   listen=PORT   port spectators connect to (default: port + 1)
+//   match=ID      match to watch (default: the server picks its busiest)
+struct RelayConfig {
+    NetworkConfig network;
+    uint16_t listenPort = 0;
+    uint32_t match = 0;  // Requested match id + 1, 0 lets the server choose
+
+    bool set(const std::string& key, const std::string& value, std::string& error);
+};
+
+// Fans one match's spectator stream out to more spectators than the match server should carry.
+//
+// The relay watches a match like any spectator and hands every frame it receives to all of its
+// own spectators as the same ENet packet, without copying or re-encoding it. It accepts the same
+// connections the server does, so relays can feed relays. Everything runs on the thread calling run().
+class SpectatorRelay {
+   public:
+    explicit SpectatorRelay(const RelayConfig& config);
+    ~SpectatorRelay();
+
+    bool start();
+    void run();  // Returns after stop()
+    void stop();
+
+   private:
+    static constexpr uint32_t RECONNECT_MS = 1000;
+
+    void connectUpstream();
+    void serviceUpstream();
+    void serviceDownstream();
+    void forward(ENetPacket* packet);
+
+    RelayConfig config;
+    ENetAddress serverAddress;
+    ENetHost* upstream;    // One connection to the server being watched
+    ENetHost* downstream;  // Our spectators
+    ENetPeer* source;      // nullptr while not connected upstream
+    uint32_t lastConnectAttempt;
+    std::atomic<bool> running;
+
+    // Connected spectators; each peer's data field holds its index here + 1
+    std::vector<ENetPeer*> spectators;
+};
+
+void runRelay(const RelayConfig& config);
+
+#endif
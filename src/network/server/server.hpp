@@ -1,6 +1,8 @@
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
-void runServer();
+#include "network/server/match_server.hpp"
+
+void runServer(const MatchServerConfig& config);
 
 #endif
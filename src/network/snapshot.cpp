@@ -0,0 +1,171 @@
+#include "network/snapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "entities/player.hpp"
+#include "network/protocol.hpp"
+
+namespace {
+int8_t axis(int value) {
+    return static_cast<int8_t>(std::max(-1, std::min(value, 1)));
+}
+}  // namespace
+
+void captureSnapshot(Registry& registry, const std::vector<uint32_t>& ackTicks, Snapshot& snapshot) {
+    const std::vector<Entity>& entities = registry.getEntities();
+    const std::vector<NetworkId>& networkIds = registry.getNetworkIds();
+    const std::vector<Transform>& transforms = registry.getTransforms();
+    const std::vector<Health>& healths = registry.getHealths();
+    const std::vector<Weapon>& weapons = registry.getWeapons();
+
+    snapshot.players.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); ++i) {
+        SnapshotPlayer& player = snapshot.players[i];
+        player.owner = networkIds[i].peer;
+        player.position = transforms[i].position;
+        player.facing = transforms[i].facing;
+        player.health = healths[i].current;
+        player.timeSinceLastShot = weapons[i].timeSinceLastShot;
+        player.weaponType = weapons[i].type;
+        player.shots = weapons[i].shots;
+        player.ackTick = i < ackTicks.size() ? ackTicks[i] : 0;
+        player.bullets = weapons[i].bullets;
+    }
+}
+
+void encodeSnapshot(const Snapshot& snapshot, std::vector<uint8_t>& out) {
+    using Header = Protocol::SnapshotHeader;
+    using Record = Protocol::SnapshotPlayer;
+    size_t size = Header::SIZE + snapshot.players.size() * Record::SIZE;
+    for (const SnapshotPlayer& player : snapshot.players) {
+        size += player.bullets.size() * Bullet::SERIALIZED_SIZE;
+    }
+    out.resize(size);
+
+    uint8_t* at = out.data();
+    Header::write(at, snapshot.tick, snapshot.worldWidth, snapshot.worldHeight, static_cast<uint16_t>(snapshot.players.size()));
+    at += Header::SIZE;
+
+    // Health fits 16 bits and facing is one of -1, 0, 1 per axis; positions stay full width for large worlds
+    const int healthLimit = std::numeric_limits<int16_t>::max();
+    for (const SnapshotPlayer& player : snapshot.players) {
+        Record::write(at, player.owner, player.position.x, player.position.y, axis(player.facing.x), axis(player.facing.y),
+                      static_cast<int16_t>(std::max(-healthLimit, std::min(player.health, healthLimit))), player.timeSinceLastShot,
+                      player.weaponType, player.shots, player.ackTick, static_cast<uint16_t>(player.bullets.size()));
+        at += Record::SIZE;
+        for (const Bullet& bullet : player.bullets) {
+            bullet.serialize(at);
+            at += Bullet::SERIALIZED_SIZE;
+        }
+    }
+}
+
+bool decodeSnapshot(const uint8_t* data, size_t length, Snapshot& snapshot) {
+    using Header = Protocol::SnapshotHeader;
+    using Record = Protocol::SnapshotPlayer;
+    if (length < Header::SIZE) return false;
+
+    int32_t worldWidth, worldHeight;
+    uint16_t playerCount;
+    Header::read(data, snapshot.tick, worldWidth, worldHeight, playerCount);
+    snapshot.worldWidth = worldWidth;
+    snapshot.worldHeight = worldHeight;
+    size_t offset = Header::SIZE;
+
+    snapshot.players.resize(playerCount);
+    for (SnapshotPlayer& player : snapshot.players) {
+        if (length - offset < Record::SIZE) return false;
+
+        int32_t x, y;
+        int8_t facingX, facingY;
+        int16_t health;
+        uint16_t bulletCount;
+        Record::read(data + offset, player.owner, x, y, facingX, facingY, health, player.timeSinceLastShot, player.weaponType,
+                     player.shots, player.ackTick, bulletCount);
+        offset += Record::SIZE;
+        if (player.weaponType >= PROJECTILE_TYPE_COUNT) return false;
+        player.position = {x, y};
+        player.facing = {facingX, facingY};
+        player.health = health;
+        if ((length - offset) / Bullet::SERIALIZED_SIZE < bulletCount) return false;
+
+        player.bullets.clear();
+        player.bullets.reserve(bulletCount);
+        for (uint16_t b = 0; b < bulletCount; ++b) {
+            player.bullets.push_back(Bullet::deserialize(data, offset));
+        }
+    }
+    return offset == length;
+}
+
+void restorePlayer(Registry& registry, Entity entity, const SnapshotPlayer& player, bool withHealth) {
+    Transform& transform = registry.getTransform(entity);
+    transform.position = player.position;
+    transform.facing = player.facing;
+
+    Weapon& weapon = registry.getWeapon(entity);
+    weapon.timeSinceLastShot = player.timeSinceLastShot;
+    weapon.type = player.weaponType;
+    weapon.shots = player.shots;
+    weapon.bullets = player.bullets;
+
+    if (withHealth) {
+        Player restored(registry, entity);
+        restored.setHealth(player.health);
+        restored.clearHealthChangeFlag();
+    }
+}
+
+size_t snapshotChunkCount(size_t encodedLength) {
+    return std::max<size_t>(1, (encodedLength + Protocol::SNAPSHOT_CHUNK_PAYLOAD - 1) / Protocol::SNAPSHOT_CHUNK_PAYLOAD);
+}
+
+void writeSnapshotChunk(const std::vector<uint8_t>& encoded, uint32_t tick, uint16_t index, std::vector<uint8_t>& message) {
+    using Chunk = Protocol::SnapshotMessage;
+    size_t begin = index * Protocol::SNAPSHOT_CHUNK_PAYLOAD;
+    size_t end = std::min(encoded.size(), begin + Protocol::SNAPSHOT_CHUNK_PAYLOAD);
+    uint16_t count = static_cast<uint16_t>(snapshotChunkCount(encoded.size()));
+
+    message.resize(Chunk::sizeFor(end - begin));
+    Chunk::write(message.data(), tick, index, count);
+    std::memcpy(Chunk::element(message.data(), 0), encoded.data() + begin, end - begin);
+}
+
+bool SnapshotAssembler::add(const uint8_t* chunk, size_t length) {
+    uint32_t chunkTick;
+    uint16_t index, chunkCount;
+    size_t payload;
+    if (!Protocol::SnapshotMessage::read(chunk, length, chunkTick, index, chunkCount, payload) || payload == 0) return false;
+
+    if (index == 0) {
+        tick = chunkTick;
+        count = chunkCount;
+        received = 0;
+        data.clear();
+    }
+    if (chunkTick != tick || chunkCount != count || index != received || received >= count) {
+        return false;
+    }
+
+    const uint8_t* bytes = Protocol::SnapshotMessage::element(chunk, 0);
+    data.insert(data.end(), bytes, bytes + payload);
+    received++;
+    return true;
+}
+
+bool SnapshotAssembler::isComplete() const {
+    return count > 0 && received == count;
+}
+
+const std::vector<uint8_t>& SnapshotAssembler::getData() const {
+    return data;
+}
+
+void SnapshotAssembler::clear() {
+    tick = 0;
+    received = 0;
+    count = 0;
+    data.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/registry.hpp"
+#include "entities/bullet.hpp"
+#include "entities/position.hpp"
+
+// Everything about one player that the per-tick messages don't repeat, or that a client which
+// just arrived can't have seen yet
+struct SnapshotPlayer {
+    uint16_t owner;
+    Position position;
+    Position facing;
+    int health;
+    float timeSinceLastShot;  // So a player who just fired can't fire again the moment a client resumes
+    uint8_t weaponType;       // ProjectileType the weapon fires
+    uint8_t shots;            // The weapon's shot count, so the first bullets message after it isn't taken for a shot
+    uint32_t ackTick;         // Newest input tick applied, 0 for players without commands
+    std::vector<Bullet> bullets;
+};
+
+// Full state of a match at one tick, sent once to a client that joins or resumes mid-match.
+// After it the client lives on the regular messages: position and bullets every tick, health only
+// when it changes. Those already are the deltas: each is a player's whole latest state, unreliable
+// and replaced by the next, so a lost one costs nothing and needs no baseline. Encoding them against
+// what a client last had would need clients to acknowledge state, which they don't.
+struct Snapshot {
+    uint32_t tick = 0;
+    int worldWidth = 0;  // Stands for the map: its layout follows from the size
+    int worldHeight = 0;
+    std::vector<SnapshotPlayer> players;
+};
+
+// Fills in the players; ackTicks is indexed like the registry's dense arrays. The caller sets the tick and world.
+void captureSnapshot(Registry& registry, const std::vector<uint32_t>& ackTicks, Snapshot& snapshot);
+void encodeSnapshot(const Snapshot& snapshot, std::vector<uint8_t>& out);
+bool decodeSnapshot(const uint8_t* data, size_t length, Snapshot& snapshot);  // False for anything malformed
+
+// Puts a player's state from a snapshot onto an entity. Health is left alone when the client has
+// heard a newer value since: live health changes travel on their own channel and may overtake the snapshot.
+void restorePlayer(Registry& registry, Entity entity, const SnapshotPlayer& player, bool withHealth);
+
+// Chunking for Protocol::MessageType::SNAPSHOT
+size_t snapshotChunkCount(size_t encodedLength);
+void writeSnapshotChunk(const std::vector<uint8_t>& encoded, uint32_t tick, uint16_t index, std::vector<uint8_t>& message);
+
+// Collects one snapshot's chunks on the receiving side. Chunks travel reliable and ordered, so
+// they arrive in order; the first chunk of a newer snapshot starts over.
+class SnapshotAssembler {
+   public:
+    bool add(const uint8_t* data, size_t length);  // False for a chunk that doesn't fit the one being collected
+    bool isComplete() const;
+    const std::vector<uint8_t>& getData() const;
+    void clear();
+
+   private:
+    uint32_t tick = 0;
+    uint16_t received = 0;
+    uint16_t count = 0;
+    std::vector<uint8_t> data;
+};
+
+#endif